@@ -266,6 +266,8 @@ public:
 
     void process(ProcessingContext& context, odk::IfHost *host) override
     {
+        ODK_UNUSED(host);
+
         const auto channel_id = m_input_channel->getValue();
         auto channel_iterator = context.m_channel_iterators[channel_id];
         auto timebase = getInputChannelProxy(channel_id)->getTimeBase();
@@ -273,6 +275,7 @@ public:
         uint64_t start_sample = getTickAtOrAfter(context.m_window.first, m_timebase_frequency);
         uint64_t end_sample = getTickAtOrAfter(context.m_window.second, m_timebase_frequency);
 
+        // output channels are sync channels, the staged samples are sent as one message per channel after process
         uint64_t sample_index = 0;
         while ((start_sample + sample_index) < end_sample)
         {
@@ -280,21 +283,21 @@ public:
             auto result = std::minmax_element(data, data+m_dimension);
             if (m_min_channels.m_value_channel && (m_min_channels.m_value_channel->getUsedProperty()->getValue()))
             {
-                addSample(host, m_min_channels.m_value_channel->getLocalId(), start_sample + sample_index, result.first, sizeof(double));
+                m_min_channels.m_value_channel->addSamples(start_sample + sample_index, result.first, 1);
             }
             if (m_min_channels.m_bin_channel && (m_min_channels.m_bin_channel->getUsedProperty()->getValue()))
             {
                 float offset = static_cast<float>(result.first - data);
-                addSample(host, m_min_channels.m_bin_channel->getLocalId(), start_sample + sample_index, &offset, sizeof(float));
+                m_min_channels.m_bin_channel->addSamples(start_sample + sample_index, &offset, 1);
             }
             if (m_max_channels.m_value_channel && (m_max_channels.m_value_channel->getUsedProperty()->getValue()))
             {
-                addSample(host, m_max_channels.m_value_channel->getLocalId(), start_sample + sample_index, result.second, sizeof(double));
+                m_max_channels.m_value_channel->addSamples(start_sample + sample_index, result.second, 1);
             }
             if (m_max_channels.m_value_channel && (m_max_channels.m_bin_channel->getUsedProperty()->getValue()))
             {
                 float offset = static_cast<float>(result.second - data);
-                addSample(host, m_max_channels.m_bin_channel->getLocalId(), start_sample + sample_index, &offset, sizeof(float));
+                m_max_channels.m_bin_channel->addSamples(start_sample + sample_index, &offset, 1);
             }
 
             ++channel_iterator;
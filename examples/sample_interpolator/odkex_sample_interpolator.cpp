@@ -6,6 +6,7 @@
 
 #include <array>
 #include <cmath>
+#include <limits>
 #include <string.h>
 
 static const char* PLUGIN_MANIFEST =
@@ -234,18 +235,32 @@ public:
                 output_start_sample = m_last_timestamp * upsample_factor;
             }
 
-            for (auto sample_index = start_sample; sample_index < end_sample; ++sample_index)
+            auto sample_index = start_sample;
+            while (sample_index < end_sample)
             {
-                const double current_value = iterator.value<double>();
-                ++iterator;
+                // process the input block by block
+                auto span = iterator.nextSpan(end_sample - sample_index);
+                if (span.empty())
+                {
+                    // no more input: the remaining samples are reported as invalid
+                    span.m_count = end_sample - sample_index;
+                }
 
                 if (upsample_factor == 1)
                 {
-                    // no upsampling, just write the value to the output
-                    samples[output_sample_index++] = current_value;
+                    // no upsampling, just write the values to the output
+                    for (std::uint64_t i = 0; i < span.m_count; ++i)
+                    {
+                        samples[output_sample_index++] = span.m_data ? span.value<double>(i) : std::numeric_limits<double>::quiet_NaN();
+                    }
+                    sample_index += span.m_count;
+                    continue;
                 }
-                else
+
+                for (std::uint64_t i = 0; i < span.m_count; ++i, ++sample_index)
                 {
+                    const double current_value = span.m_data ? span.value<double>(i) : std::numeric_limits<double>::quiet_NaN();
+
                     // interpolate as soon as we have a previous sample
                     if (m_has_last)
                     {
@@ -279,7 +294,7 @@ public:
                 if (upsample_factor == 1)
                 {
                     // write a single async sample
-                    addSample(host, out_channel->getLocalId(), timestamp, &current_value, sizeof(double));
+                    out_channel->addSample(timestamp, current_value);
                 }
                 else
                 {
@@ -291,7 +306,7 @@ public:
                             double t = static_cast<double>(n) / upsample_factor;
                             double value = lerp(m_last_sample, current_value, t);
                             double time = lerp(m_last_timestamp * upsample_factor, timestamp * upsample_factor, t);
-                            addSample(host, out_channel->getLocalId(), time, &value, sizeof(double));
+                            out_channel->addSample(static_cast<uint64_t>(time), value);
                         }
                     }
                     m_last_timestamp = timestamp;
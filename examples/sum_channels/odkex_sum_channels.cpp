@@ -362,4 +362,5 @@ public:
     }
 };
 
-OXY_REGISTER_PLUGIN1("ODK_SUM_CHANNELS", PLUGIN_MANIFEST, MyExamplePlugin);
+// the plugin has no XML documents before it is created, so pugixml can use the memory cache
+OXY_REGISTER_PLUGIN1_WITH_XML_MEMORY_CACHE("ODK_SUM_CHANNELS", PLUGIN_MANIFEST, MyExamplePlugin);
@@ -18,11 +18,15 @@ Item {
     function applyDefaults()
     {
         base.customProperties.setString("Format", "PCM")
+        base.customProperties.setString("Dither", "None")
+        base.customProperties.setString("Resample", "Off")
     }
 
     onCustomPropertiesChanged:
     {
         formatCombobox.currentIndex = formatCombobox.getIndexByValue(base.customProperties.getString("Format"));
+        ditherCombobox.currentIndex = Math.max(0, ditherCombobox.getIndexByValue(base.customProperties.getString("Dither")));
+        resampleCombobox.currentIndex = Math.max(0, resampleCombobox.getIndexByValue(base.customProperties.getString("Resample")));
     }
 
     function translateModel(list, context)
@@ -52,11 +56,39 @@ Item {
         ComboBox
         {
             id: formatCombobox
-            model: translateModel(["Float", "PCM"], "ODK_WAV_EXPORT/")
+            model: translateModel(["Float", "Float64", "PCM", "PCM24", "PCM32"], "ODK_WAV_EXPORT/")
 
             onActivated: {
                 base.customProperties.setString("Format", model.get(currentIndex).value);
             }
         }
+
+        Label {
+            text: qsTranslate("ODK_WAV_EXPORT/", "Dither")
+        }
+
+        ComboBox
+        {
+            id: ditherCombobox
+            model: translateModel(["None", "TPDF"], "ODK_WAV_EXPORT/")
+
+            onActivated: {
+                base.customProperties.setString("Dither", model.get(currentIndex).value);
+            }
+        }
+
+        Label {
+            text: qsTranslate("ODK_WAV_EXPORT/", "Resample")
+        }
+
+        ComboBox
+        {
+            id: resampleCombobox
+            model: translateModel(["Off", "Highest", "44100", "48000", "96000"], "ODK_WAV_EXPORT/")
+
+            onActivated: {
+                base.customProperties.setString("Resample", model.get(currentIndex).value);
+            }
+        }
     }
 }
@@ -0,0 +1,124 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "wav_writer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const std::size_t CHANNEL_COUNT = 8;
+    const std::size_t FRAME_COUNT = 2 * 1000 * 1000;
+    const std::size_t FRAMES_PER_BLOCK = 4096;
+    /// size of the files written to compare the I/O backends, can be changed by the first argument
+    const std::size_t LARGE_FILE_MIB = 2048;
+
+    template <class Write>
+    void measure(const char* name, WavFormatTag format, std::size_t bits_per_sample, std::size_t frame_count, Write write,
+        WavIoMode mode = WavIoMode::BUFFERED)
+    {
+        FILE* file = std::tmpfile();
+        if (!file)
+        {
+            std::cerr << "Unable to create a temporary file" << std::endl;
+            return;
+        }
+        WavWriter writer(file);
+        writer.setIoMode(mode);
+        writer.writeHeader(format, bits_per_sample, 48000, CHANNEL_COUNT, frame_count);
+
+        const auto start = std::chrono::steady_clock::now();
+        write(writer);
+        writer.close();
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+        const double megabytes = static_cast<double>(frame_count * CHANNEL_COUNT * bits_per_sample / 8) / (1024 * 1024);
+        std::cout << name << ": " << elapsed.count() * 1000 << " ms, " << megabytes / elapsed.count() << " MiB/s" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::vector<float>> channels(CHANNEL_COUNT, std::vector<float>(FRAMES_PER_BLOCK));
+    std::vector<const float*> channel_pointers;
+    for (std::size_t channel = 0; channel < CHANNEL_COUNT; ++channel)
+    {
+        for (std::size_t frame = 0; frame < FRAMES_PER_BLOCK; ++frame)
+        {
+            channels[channel][frame] = static_cast<float>(std::sin(0.001 * static_cast<double>(frame * (channel + 1))));
+        }
+        channel_pointers.push_back(channels[channel].data());
+    }
+
+    // one call per sample and channel as done before appendFrames was added
+    measure("appendSamples PCM16", WavFormatTag::WAV_FORMAT_PCM, 16, FRAME_COUNT, [&channels](WavWriter& writer)
+    {
+        for (std::size_t frame = 0; frame < FRAME_COUNT; ++frame)
+        {
+            for (std::size_t channel = 0; channel < CHANNEL_COUNT; ++channel)
+            {
+                const auto value = static_cast<std::int16_t>(channels[channel][frame % FRAMES_PER_BLOCK] * 32767);
+                writer.appendSamples(&value, sizeof(value));
+            }
+        }
+    });
+
+    measure("appendFrames PCM16", WavFormatTag::WAV_FORMAT_PCM, 16, FRAME_COUNT, [&channel_pointers](WavWriter& writer)
+    {
+        for (std::size_t frame = 0; frame < FRAME_COUNT; frame += FRAMES_PER_BLOCK)
+        {
+            writer.appendFrames(channel_pointers.data(), std::min(FRAMES_PER_BLOCK, FRAME_COUNT - frame));
+        }
+    });
+
+    const auto append_all_frames = [&channel_pointers](WavWriter& writer)
+    {
+        for (std::size_t frame = 0; frame < FRAME_COUNT; frame += FRAMES_PER_BLOCK)
+        {
+            writer.appendFrames(channel_pointers.data(), std::min(FRAMES_PER_BLOCK, FRAME_COUNT - frame));
+        }
+    };
+    measure("appendFrames PCM24", WavFormatTag::WAV_FORMAT_PCM, 24, FRAME_COUNT, append_all_frames);
+    measure("appendFrames PCM32", WavFormatTag::WAV_FORMAT_PCM, 32, FRAME_COUNT, append_all_frames);
+    measure("appendFrames float", WavFormatTag::WAV_FORMAT_FLOAT, 32, FRAME_COUNT, append_all_frames);
+    measure("appendFrames float64", WavFormatTag::WAV_FORMAT_FLOAT, 64, FRAME_COUNT, append_all_frames);
+
+    // I/O backends on a large float file
+    const std::size_t file_mib = argc > 1 ? static_cast<std::size_t>(std::strtoul(argv[1], NULL, 10)) : LARGE_FILE_MIB;
+    const std::size_t large_frame_count = file_mib * 1024 * 1024 / (CHANNEL_COUNT * sizeof(float));
+    std::cout << file_mib << " MiB file" << std::endl;
+
+    std::vector<float> interleaved(FRAMES_PER_BLOCK * CHANNEL_COUNT);
+    for (std::size_t frame = 0; frame < FRAMES_PER_BLOCK; ++frame)
+    {
+        for (std::size_t channel = 0; channel < CHANNEL_COUNT; ++channel)
+        {
+            interleaved[frame * CHANNEL_COUNT + channel] = channels[channel][frame];
+        }
+    }
+    // interleaved by the caller and passed to fwrite block by block
+    measure("stdio float", WavFormatTag::WAV_FORMAT_FLOAT, 32, large_frame_count, [&interleaved, large_frame_count](WavWriter& writer)
+    {
+        for (std::size_t frame = 0; frame < large_frame_count; frame += FRAMES_PER_BLOCK)
+        {
+            writer.appendSamples(interleaved.data(), std::min(FRAMES_PER_BLOCK, large_frame_count - frame) * CHANNEL_COUNT * sizeof(float));
+        }
+    });
+
+    const auto append_frames = [&channel_pointers, large_frame_count](WavWriter& writer)
+    {
+        for (std::size_t frame = 0; frame < large_frame_count; frame += FRAMES_PER_BLOCK)
+        {
+            writer.appendFrames(channel_pointers.data(), std::min(FRAMES_PER_BLOCK, large_frame_count - frame));
+        }
+    };
+    measure("large buffer float", WavFormatTag::WAV_FORMAT_FLOAT, 32, large_frame_count, append_frames, WavIoMode::BUFFERED);
+    measure("memory mapped float", WavFormatTag::WAV_FORMAT_FLOAT, 32, large_frame_count, append_frames, WavIoMode::MEMORY_MAPPED);
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Copyright DEWETRON GmbH 2026
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Conversion of normalized float and double samples to the sample formats of WAV files
+ *
+ * Every conversion has a scalar reference implementation, the default one uses SIMD instructions
+ * where available and produces identical results.
+ * PCM conversions scale [-1, 1] to the full integer range, clip values outside of it and map NaN to 0.
+ * Samples are rounded to the nearest integer in the current floating point rounding mode, which has to be the
+ * default round to nearest even. The optional dither is added in units of the least significant bit before the
+ * samples are quantized, so that TPDF dither leaves the mean of the quantization error at zero.
+ */
+namespace wav_conversion
+{
+    /**
+     * Generates triangular (TPDF) dither noise in (-1, 1) LSB
+     * The noise is the difference of two uniform random numbers of a xorshift generator,
+     * so it is reproducible for a given seed.
+     */
+    class TpdfDither
+    {
+    public:
+        explicit TpdfDither(std::uint32_t seed = 1) noexcept;
+
+        void generate(float* noise, std::size_t count) noexcept;
+
+    private:
+        float nextUniform() noexcept;
+
+        std::uint32_t m_state;
+    };
+
+    void floatToPcm16(const float* source, std::int16_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    void floatToPcm16Scalar(const float* source, std::int16_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    /**
+     * Converts to packed little endian 24 bit PCM, target has to hold 3 * count bytes
+     */
+    void floatToPcm24(const float* source, std::uint8_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    void floatToPcm24Scalar(const float* source, std::uint8_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    /**
+     * Converts to 32 bit PCM, scaled in double precision so that full scale maps to the integer limits
+     */
+    void floatToPcm32(const float* source, std::int32_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    void floatToPcm32Scalar(const float* source, std::int32_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    /**
+     * Widens to 64 bit float, the values are not scaled or clipped
+     */
+    void floatToFloat64(const float* source, double* target, std::size_t count) noexcept;
+
+    void floatToFloat64Scalar(const float* source, double* target, std::size_t count) noexcept;
+
+    /**
+     * Double samples are scaled and quantized in double precision, they are not rounded to float first
+     */
+    void doubleToPcm16(const double* source, std::int16_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    void doubleToPcm16Scalar(const double* source, std::int16_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    void doubleToPcm24(const double* source, std::uint8_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    void doubleToPcm24Scalar(const double* source, std::uint8_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    /**
+     * Keeps all 32 bit of the integer range, unlike floatToPcm32 whose input carries at most 24 bit
+     */
+    void doubleToPcm32(const double* source, std::int32_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    void doubleToPcm32Scalar(const double* source, std::int32_t* target, std::size_t count, const float* dither = nullptr) noexcept;
+
+    /**
+     * Rounds to 32 bit float, the values are not scaled or clipped
+     */
+    void doubleToFloat32(const double* source, float* target, std::size_t count) noexcept;
+
+    void doubleToFloat32Scalar(const double* source, float* target, std::size_t count) noexcept;
+}
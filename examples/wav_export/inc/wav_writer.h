@@ -2,8 +2,11 @@
 
 #pragma once
 
+#include "wav_sample_conversion.h"
+
 #include <cstdio>
 #include <cstdint>
+#include <vector>
 
 enum class WavFormatTag
 {
@@ -11,6 +14,14 @@ enum class WavFormatTag
     WAV_FORMAT_FLOAT = 3,
 };
 
+enum class WavIoMode
+{
+    /// frames are collected in a buffer of WRITE_BUFFER_SIZE bytes and written with fwrite
+    BUFFERED,
+    /// the file is preallocated and frames are converted directly into mapped windows of MAP_WINDOW_SIZE bytes
+    MEMORY_MAPPED,
+};
+
 /**
  * The WavWriter writes RIFF WAV files from a header and samples
  * The resulting file can be read using any audio processing software given that the sample format is supported
@@ -18,6 +29,11 @@ enum class WavFormatTag
 class WavWriter
 {
 public:
+    /// frames added by appendFrames are written in blocks of this size
+    static const std::size_t WRITE_BUFFER_SIZE = 1024 * 1024;
+    /// size of the file regions mapped at once in WavIoMode::MEMORY_MAPPED
+    static const std::size_t MAP_WINDOW_SIZE = 64 * 1024 * 1024;
+
     /**
      * Create a new wav file
      */
@@ -29,11 +45,27 @@ public:
 
     ~WavWriter();
 
+    /**
+     * Selects how samples are written to the file, has to be called before writeHeader
+     * Platforms without memory mapped files keep WavIoMode::BUFFERED.
+     */
+    void setIoMode(WavIoMode mode);
+
+    WavIoMode getIoMode() const;
+
     /**
      * Write/updates the RIFF header
+     * Files that would exceed the 4 GiB limit of RIFF are written as RF64 with a ds64 chunk.
      * @param num_samples number of samples, a stereo sample still counts as one
      */
     void writeHeader(WavFormatTag format, std::size_t bits_per_sample, std::uint32_t sample_rate, std::size_t num_channels, std::size_t num_samples);
+
+    /**
+     * Writes a preliminary header for a file whose length is not known in advance
+     * The number of samples is filled in by close. Room for a ds64 chunk is reserved as JUNK chunk,
+     * so the file is finished as RF64 if it exceeds 4 GiB.
+     */
+    void writeHeader(WavFormatTag format, std::size_t bits_per_sample, std::uint32_t sample_rate, std::size_t num_channels);
     /**
      * Appends a samples to the file, channels must be written interleaved
      * @param value pointer to sample data
@@ -41,22 +73,94 @@ public:
      */
     void appendSamples(const void* value, std::size_t size);
 
+    /**
+     * Appends frames given as one array per channel
+     * The samples are converted to the sample format of the header and interleaved into an internal buffer
+     * that is written to the file when it is full, on flush and on close.
+     * Supported are 16, 24 and 32 bit PCM (scaled from [-1, 1] and clipped) and 32 and 64 bit float.
+     * @param channels num_channels pointers to num_frames samples each
+     */
+    void appendFrames(const float* const* channels, std::size_t num_frames);
+
+    /**
+     * Double precision variant of appendFrames, samples are converted without rounding them to float first
+     * 32 bit PCM keeps its full resolution and 64 bit float samples are copied as they are.
+     */
+    void appendFrames(const double* const* channels, std::size_t num_frames);
+
+    /**
+     * Enables TPDF dither of one LSB for PCM samples added by appendFrames
+     */
+    void setDither(bool enabled);
+
+    /**
+     * Writes the buffered frames to the file or releases the current mapped window
+     */
+    void flush();
+
     /**
      * Returns the number of samples currently added to the file (counts each sample for every channel)
      **/
     std::size_t samplesWritten() const;
 
     /**
-     * Close the file handle
+     * Writes the buffered frames, completes a preliminary header and closes the file handle
      */
     void close();
 
 private:
+    template <class Sample>
+    void appendConvertedFrames(const Sample* const* channels, std::size_t num_frames);
+
+    enum class HeaderLayout
+    {
+        /// RIFF, fmt and data chunk
+        COMPACT,
+        /// with a ds64 or JUNK chunk of the same size in front of the fmt chunk
+        RESERVED
+    };
+
     WavWriter(const WavWriter&);
 
+    void startFile(WavFormatTag format, std::size_t bits_per_sample, std::uint32_t sample_rate, std::size_t num_channels, std::size_t num_samples,
+        HeaderLayout layout, bool lazy_header);
+    void writeHeaderChunks(std::uint64_t num_samples);
+    /// makes room for at least size bytes at m_write_begin + m_buffer_used
+    void reserveWriteSpace(std::size_t size);
+    void mapWindow(std::size_t size);
+    void unmapWindow();
+    void allocateFile(std::uint64_t size);
+    /// removes the space allocated behind the written data
+    void truncateFile();
+
     FILE* m_file;
+    WavFormatTag m_format;
+    std::size_t m_bits_per_sample;
+    std::uint32_t m_sample_rate;
     std::size_t m_num_channels;
     std::size_t m_num_samples;
     std::size_t m_sample_size;
     std::size_t m_samples_written;
+    HeaderLayout m_header_layout;
+    /// the header is written again with the actual number of samples on close
+    bool m_lazy_header;
+    WavIoMode m_io_mode;
+    bool m_dither;
+    wav_conversion::TpdfDither m_dither_source;
+    /// file offset of the first sample
+    std::uint64_t m_data_offset;
+    /// bytes of the data chunk that have been written or released
+    std::uint64_t m_data_written;
+    std::uint64_t m_allocated;
+    std::uint8_t* m_window;
+    std::size_t m_window_length;
+    /// m_buffer or the part of m_window behind the written data
+    std::uint8_t* m_write_begin;
+    std::size_t m_write_capacity;
+    /// interleaved frames that have not been written yet
+    std::vector<std::uint8_t> m_buffer;
+    std::size_t m_buffer_used;
+    /// one channel of a block converted to the sample format
+    std::vector<std::uint8_t> m_converted;
+    std::vector<float> m_dither_noise;
 };
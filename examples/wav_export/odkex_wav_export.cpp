@@ -3,6 +3,7 @@
 #include "odkfw_export_plugin.h"
 #include "odkfw_properties.h"
 #include "odkfw_property_list_utils.h"
+#include "odkfw_sinc_resampler.h"
 #include "odkbase_message_return_value_holder.h"
 #include "odkapi_utils.h"
 
@@ -10,12 +11,16 @@
 
 #include "qml.rcc.h"
 
+#include <algorithm>
 #include <stdio.h>
 #include <stdint.h>
 #include <cstring>
 #include <chrono>
 #include <ios>
+#include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
 static const char* PLUGIN_MANIFEST =
 R"XML(<?xml version="1.0"?>
@@ -40,13 +45,41 @@ R"XML(<?xml version="1.0"?>
 
 using namespace odk::framework;
 
-class WavExport : public ExportInstance
+namespace
 {
-public:
+    /// frames read from the iterators before they are handed to the writer
+    const std::size_t FRAMES_PER_BLOCK = 4096;
+
+    /**
+     * Reads count samples scaled to [-1, 1], missing samples are read as silence to keep the channels aligned
+     */
+    void readSamples(StreamIterator& iterator, double scaling_factor, double* samples, std::size_t count)
+    {
+        for(std::size_t n = 0; n < count; ++n)
+        {
+            double value = 0;
+            if(iterator.valid())
+            {
+                value = iterator.value<double>() * scaling_factor;
+                ++iterator;
+            }
+            samples[n] = value;
+        }
+    }
 
-    WavExport()
+    /**
+     * True if the channels are resampled to a common rate, "Off" writes every channel with the rate of the first one
+     */
+    bool isResampling(const odk::ExportProperties& properties)
     {
+        const auto resample = properties.m_custom_properties.getString("Resample");
+        return !resample.empty() && resample != "Off";
     }
+}
+
+class WavExport : public ExportInstance
+{
+public:
 
     static odk::RegisterExport getExportInfo()
     {
@@ -84,67 +117,159 @@ public:
         response.m_success = !no_export_possible;
     }
 
+    void configureExport(const ValidationContext& context)
+    {
+        // the channels are read alongside each other, block by block. Without resampling every channel advances one
+        // sample per frame, so channels of different rates drift apart in time and a shared data set would keep
+        // every window between them loaded.
+        setGroupChannels(isResampling(context.m_properties) || haveEqualSampleRates(context));
+    }
+
     bool exportData(const ProcessingContext& context)
     {
         WavFormatTag type = WavFormatTag::WAV_FORMAT_FLOAT;
         std::size_t sample_size = sizeof(float)*8;
 
-        if(context.m_properties.m_custom_properties.getString("Format") == "PCM")
+        const auto format = context.m_properties.m_custom_properties.getString("Format");
+        if(format == "PCM")
         {
             type = WavFormatTag::WAV_FORMAT_PCM;
             sample_size = 16;
         }
+        else if(format == "PCM24")
+        {
+            type = WavFormatTag::WAV_FORMAT_PCM;
+            sample_size = 24;
+        }
+        else if(format == "PCM32")
+        {
+            type = WavFormatTag::WAV_FORMAT_PCM;
+            sample_size = 32;
+        }
+        else if(format == "Float64")
+        {
+            sample_size = sizeof(double)*8;
+        }
 
         if(!context.m_properties.m_channels.empty())
         {
             auto first_channel = context.m_channels.at(context.m_properties.m_channels.front());
 
-            const double sample_rate = first_channel->getSampleRate().m_val;
+            // without resampling every channel is written with the rate of the first one
+            double sample_rate = first_channel->getSampleRate().m_val;
+            const auto resample = context.m_properties.m_custom_properties.getString("Resample");
+            if(resample == "Highest")
+            {
+                for(const auto& channel : context.m_channels)
+                {
+                    sample_rate = std::max(sample_rate, channel.second->getSampleRate().m_val);
+                }
+            }
+            else if(!resample.empty() && resample != "Off")
+            {
+                try
+                {
+                    sample_rate = std::stod(resample);
+                }
+                catch (const std::logic_error&)
+                {
+                    return false;
+                }
+            }
+            if(!(sample_rate > 0))
+            {
+                return false;
+            }
+            const bool resampling = isResampling(context.m_properties);
             const std::size_t num_channels = context.m_properties.m_channels.size();
-            const auto first_interval = context.m_properties.m_export_intervals.at(0);
-            const double interval_length = first_interval.m_end - first_interval.m_begin;
 
-            const std::size_t num_samples = static_cast<std::size_t>(interval_length * sample_rate);
-            std::map<uint64_t, double> scaling_factors;
+            // all intervals are written one after another into the same file
+            std::vector<std::size_t> interval_samples;
+            for (const auto& interval : context.m_properties.m_export_intervals)
+            {
+                interval_samples.push_back(static_cast<std::size_t>((interval.m_end - interval.m_begin) * sample_rate));
+            }
+            if (interval_samples.empty())
+            {
+                return false;
+            }
+            // resolved once, the inner loop only walks the iterators
+            struct ExportChannel
+            {
+                StreamIterator* m_iterator;
+                double m_scaling_factor;
+                /// kept in double precision up to the writer, 32 bit PCM and 64 bit float would lose bits in float
+                std::vector<double> m_samples;
+                /// converts from the channel rate to sample_rate, input is read block by block as the kernel needs it
+                std::unique_ptr<SincResampler> m_resampler;
+                std::vector<double> m_input;
+            };
+            std::vector<ExportChannel> export_channels;
             for(const auto& channel : context.m_channels)
             {
                 auto range = channel.second->getRange();
-                scaling_factors[channel.first] = 1 / std::max(range.m_max, range.m_min);
+                export_channels.push_back({ context.m_channel_iterators.at(channel.first).get(), 1 / std::max(range.m_max, range.m_min), std::vector<double>(FRAMES_PER_BLOCK), nullptr, {} });
+                const double channel_rate = channel.second->getSampleRate().m_val;
+                if(resampling)
+                {
+                    if(!(channel_rate > 0))
+                    {
+                        return false;
+                    }
+                    export_channels.back().m_resampler = std::make_unique<SincResampler>(channel_rate, sample_rate);
+                }
+            }
+            std::vector<const double*> channel_samples;
+            for (const auto& export_channel : export_channels)
+            {
+                channel_samples.push_back(export_channel.m_samples.data());
             }
 
             try
             {
                 WavWriter writer(context.m_properties.m_filename.c_str());
-                writer.writeHeader(type, sample_size, static_cast<std::uint32_t>(sample_rate), num_channels, num_samples);
+                // the sample count is filled in on close, exports beyond 4 GiB become RF64 files
+                writer.writeHeader(type, sample_size, static_cast<std::uint32_t>(sample_rate), num_channels);
+                writer.setDither(context.m_properties.m_custom_properties.getString("Dither") == "TPDF");
 
-                for(std::size_t i = 0; i < num_samples; ++i)
+                do
                 {
-                    if(i % 1000 == 0)
+                    // intervals are not contiguous, every one starts a new stream
+                    for(auto& export_channel : export_channels)
                     {
-                        notifyProgress(100 * i / num_samples);
+                        if(export_channel.m_resampler)
+                        {
+                            export_channel.m_resampler->reset();
+                        }
                     }
 
-                    for(const auto& channel : context.m_channels)
+                    const std::size_t samples = interval_samples.at(context.m_interval_index);
+                    for(std::size_t first_frame = 0; first_frame < samples; first_frame += FRAMES_PER_BLOCK)
                     {
-                        auto& iterator = *context.m_channel_iterators.at(channel.first);
+                        notifyIntervalProgress(static_cast<double>(first_frame) / static_cast<double>(samples));
 
-                        if(iterator.valid())
+                        const std::size_t frames = std::min(FRAMES_PER_BLOCK, samples - first_frame);
+                        for(auto& export_channel : export_channels)
                         {
-                            float value = static_cast<float>(iterator.value<double>() * scaling_factors[channel.first]);
-                            if(type == WavFormatTag::WAV_FORMAT_FLOAT)
+                            if(!export_channel.m_resampler)
                             {
-                                writer.appendSamples(&value, sizeof(float));
+                                readSamples(*export_channel.m_iterator, export_channel.m_scaling_factor, export_channel.m_samples.data(), frames);
+                                continue;
                             }
-                            else if(type == WavFormatTag::WAV_FORMAT_PCM)
-                            {
-                                int16_t pcm_value = static_cast<int16_t>(value * 32768);
-                                writer.appendSamples(&pcm_value, sizeof(int16_t));
-                            }
-
-                            ++iterator;
+                            // the kernel looks ahead behind the end of the interval, that input is read as silence
+                            auto& resampler = *export_channel.m_resampler;
+                            export_channel.m_input.resize(resampler.requiredInput(frames));
+                            readSamples(*export_channel.m_iterator, export_channel.m_scaling_factor, export_channel.m_input.data(), export_channel.m_input.size());
+                            resampler.addInput(export_channel.m_input.data(), export_channel.m_input.size());
+                            const std::size_t resampled = resampler.process(export_channel.m_samples.data(), frames);
+                            ODK_ASSERT_EQUAL(resampled, frames);
+                            ODK_UNUSED(resampled);
                         }
+                        writer.appendFrames(channel_samples.data(), frames);
                     }
                 }
+                while (nextExportInterval());
+                writer.close();
                 return true;
             }
             catch (const std::ios_base::failure&)
@@ -0,0 +1,323 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "wav_sample_conversion.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WAV_CONVERSION_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace wav_conversion
+{
+    namespace
+    {
+        const float PCM16_SCALE = 32768.0f;
+        const float PCM16_MIN = -32768.0f;
+        const float PCM16_MAX = 32767.0f;
+
+        const float PCM24_SCALE = 8388608.0f;
+        const float PCM24_MIN = -8388608.0f;
+        const float PCM24_MAX = 8388607.0f;
+
+        // the limits of 32 bit integers are not representable as float
+        const double PCM32_SCALE = 2147483648.0;
+        const double PCM32_MIN = -2147483648.0;
+        const double PCM32_MAX = 2147483647.0;
+
+        inline float noiseAt(const float* dither, std::size_t index) noexcept
+        {
+            return dither ? dither[index] : 0.0f;
+        }
+
+        template <class Integer, class Real>
+        inline Integer quantize(Real scaled, Real min, Real max) noexcept
+        {
+            // NaN is mapped to 0 like the SIMD conversion does, rounding uses the current mode as cvtps/cvtpd do
+            scaled = std::min(std::max(scaled, min), max);
+            return scaled == scaled ? static_cast<Integer>(std::nearbyint(scaled)) : 0;
+        }
+
+        inline void storePcm24(std::int32_t value, std::uint8_t* target) noexcept
+        {
+            target[0] = static_cast<std::uint8_t>(value);
+            target[1] = static_cast<std::uint8_t>(value >> 8);
+            target[2] = static_cast<std::uint8_t>(value >> 16);
+        }
+
+#ifdef WAV_CONVERSION_SSE2
+        /// scales, clips and rounds four floats to the nearest integer, NaN results in 0
+        inline __m128i quantize(__m128 values, __m128 scale, __m128 min, __m128 max, const float* dither) noexcept
+        {
+            __m128 scaled = _mm_mul_ps(values, scale);
+            if (dither)
+            {
+                scaled = _mm_add_ps(scaled, _mm_loadu_ps(dither));
+            }
+            // max/min return the second operand for NaN, which keeps NaN out of the integer conversion
+            const __m128 nan = _mm_cmpunord_ps(scaled, scaled);
+            return _mm_cvtps_epi32(_mm_andnot_ps(nan, _mm_min_ps(_mm_max_ps(scaled, min), max)));
+        }
+
+        /// double precision variant for two values in the low half of the result
+        inline __m128i quantize(__m128d values, __m128d scale, __m128d min, __m128d max, __m128d noise) noexcept
+        {
+            const __m128d scaled = _mm_add_pd(_mm_mul_pd(values, scale), noise);
+            const __m128d nan = _mm_cmpunord_pd(scaled, scaled);
+            return _mm_cvtpd_epi32(_mm_andnot_pd(nan, _mm_min_pd(_mm_max_pd(scaled, min), max)));
+        }
+
+        /// four doubles in double precision, the float dither is widened
+        inline __m128i quantize(const double* source, __m128d scale, __m128d min, __m128d max, const float* dither) noexcept
+        {
+            __m128d low_noise = _mm_setzero_pd();
+            __m128d high_noise = _mm_setzero_pd();
+            if (dither)
+            {
+                const __m128 noise = _mm_loadu_ps(dither);
+                low_noise = _mm_cvtps_pd(noise);
+                high_noise = _mm_cvtps_pd(_mm_movehl_ps(noise, noise));
+            }
+            const __m128i low = quantize(_mm_loadu_pd(source), scale, min, max, low_noise);
+            const __m128i high = quantize(_mm_loadu_pd(source + 2), scale, min, max, high_noise);
+            return _mm_unpacklo_epi64(low, high);
+        }
+
+        /// stores four 24 bit values in 12 bytes
+        inline void storePcm24(__m128i values, std::uint8_t* target) noexcept
+        {
+            // SSE2 has no byte shuffle, the 24 bit values are packed into two 48 bit words instead
+            const __m128i pairs = _mm_or_si128(_mm_and_si128(values, _mm_set1_epi64x(0xFFFFFF)),
+                _mm_srli_epi64(_mm_and_si128(values, _mm_set1_epi64x(0xFFFFFF00000000)), 8));
+            std::uint64_t words[2];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(words), pairs);
+            for (int word = 0; word < 2; ++word)
+            {
+                for (int byte = 0; byte < 6; ++byte)
+                {
+                    target[word * 6 + byte] = static_cast<std::uint8_t>(words[word] >> (8 * byte));
+                }
+            }
+        }
+#endif
+    }
+
+    TpdfDither::TpdfDither(std::uint32_t seed) noexcept
+        : m_state(seed != 0 ? seed : 1)
+    {
+    }
+
+    void TpdfDither::generate(float* noise, std::size_t count) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float first = nextUniform();
+            noise[i] = first - nextUniform();
+        }
+    }
+
+    float TpdfDither::nextUniform() noexcept
+    {
+        // xorshift32, the upper 24 bit are exactly representable as float in [0, 1)
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return static_cast<float>(m_state >> 8) * (1.0f / 16777216.0f);
+    }
+
+    void floatToPcm16Scalar(const float* source, std::int16_t* target, std::size_t count, const float* dither) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            target[i] = quantize<std::int16_t>(source[i] * PCM16_SCALE + noiseAt(dither, i), PCM16_MIN, PCM16_MAX);
+        }
+    }
+
+    void floatToPcm16(const float* source, std::int16_t* target, std::size_t count, const float* dither) noexcept
+    {
+        std::size_t i = 0;
+#ifdef WAV_CONVERSION_SSE2
+        const __m128 scale = _mm_set1_ps(PCM16_SCALE);
+        const __m128 min = _mm_set1_ps(PCM16_MIN);
+        const __m128 max = _mm_set1_ps(PCM16_MAX);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i low = quantize(_mm_loadu_ps(source + i), scale, min, max, dither ? dither + i : nullptr);
+            const __m128i high = quantize(_mm_loadu_ps(source + i + 4), scale, min, max, dither ? dither + i + 4 : nullptr);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_packs_epi32(low, high));
+        }
+#endif
+        floatToPcm16Scalar(source + i, target + i, count - i, dither ? dither + i : nullptr);
+    }
+
+    void floatToPcm24Scalar(const float* source, std::uint8_t* target, std::size_t count, const float* dither) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            storePcm24(quantize<std::int32_t>(source[i] * PCM24_SCALE + noiseAt(dither, i), PCM24_MIN, PCM24_MAX), target + 3 * i);
+        }
+    }
+
+    void floatToPcm24(const float* source, std::uint8_t* target, std::size_t count, const float* dither) noexcept
+    {
+        std::size_t i = 0;
+#ifdef WAV_CONVERSION_SSE2
+        const __m128 scale = _mm_set1_ps(PCM24_SCALE);
+        const __m128 min = _mm_set1_ps(PCM24_MIN);
+        const __m128 max = _mm_set1_ps(PCM24_MAX);
+        for (; i + 4 <= count; i += 4)
+        {
+            storePcm24(quantize(_mm_loadu_ps(source + i), scale, min, max, dither ? dither + i : nullptr), target + 3 * i);
+        }
+#endif
+        floatToPcm24Scalar(source + i, target + 3 * i, count - i, dither ? dither + i : nullptr);
+    }
+
+    void floatToPcm32Scalar(const float* source, std::int32_t* target, std::size_t count, const float* dither) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const double scaled = static_cast<double>(source[i]) * PCM32_SCALE + static_cast<double>(noiseAt(dither, i));
+            target[i] = quantize<std::int32_t>(scaled, PCM32_MIN, PCM32_MAX);
+        }
+    }
+
+    void floatToPcm32(const float* source, std::int32_t* target, std::size_t count, const float* dither) noexcept
+    {
+        std::size_t i = 0;
+#ifdef WAV_CONVERSION_SSE2
+        const __m128d scale = _mm_set1_pd(PCM32_SCALE);
+        const __m128d min = _mm_set1_pd(PCM32_MIN);
+        const __m128d max = _mm_set1_pd(PCM32_MAX);
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 values = _mm_loadu_ps(source + i);
+            const __m128 noise = dither ? _mm_loadu_ps(dither + i) : _mm_setzero_ps();
+            const __m128i low = quantize(_mm_cvtps_pd(values), scale, min, max, _mm_cvtps_pd(noise));
+            const __m128i high = quantize(_mm_cvtps_pd(_mm_movehl_ps(values, values)), scale, min, max, _mm_cvtps_pd(_mm_movehl_ps(noise, noise)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_unpacklo_epi64(low, high));
+        }
+#endif
+        floatToPcm32Scalar(source + i, target + i, count - i, dither ? dither + i : nullptr);
+    }
+
+    void floatToFloat64Scalar(const float* source, double* target, std::size_t count) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            target[i] = static_cast<double>(source[i]);
+        }
+    }
+
+    void floatToFloat64(const float* source, double* target, std::size_t count) noexcept
+    {
+        std::size_t i = 0;
+#ifdef WAV_CONVERSION_SSE2
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 values = _mm_loadu_ps(source + i);
+            _mm_storeu_pd(target + i, _mm_cvtps_pd(values));
+            _mm_storeu_pd(target + i + 2, _mm_cvtps_pd(_mm_movehl_ps(values, values)));
+        }
+#endif
+        floatToFloat64Scalar(source + i, target + i, count - i);
+    }
+
+    void doubleToPcm16Scalar(const double* source, std::int16_t* target, std::size_t count, const float* dither) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const double scaled = source[i] * PCM16_SCALE + static_cast<double>(noiseAt(dither, i));
+            target[i] = quantize<std::int16_t, double>(scaled, PCM16_MIN, PCM16_MAX);
+        }
+    }
+
+    void doubleToPcm16(const double* source, std::int16_t* target, std::size_t count, const float* dither) noexcept
+    {
+        std::size_t i = 0;
+#ifdef WAV_CONVERSION_SSE2
+        const __m128d scale = _mm_set1_pd(PCM16_SCALE);
+        const __m128d min = _mm_set1_pd(PCM16_MIN);
+        const __m128d max = _mm_set1_pd(PCM16_MAX);
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m128i low = quantize(source + i, scale, min, max, dither ? dither + i : nullptr);
+            const __m128i high = quantize(source + i + 4, scale, min, max, dither ? dither + i + 4 : nullptr);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_packs_epi32(low, high));
+        }
+#endif
+        doubleToPcm16Scalar(source + i, target + i, count - i, dither ? dither + i : nullptr);
+    }
+
+    void doubleToPcm24Scalar(const double* source, std::uint8_t* target, std::size_t count, const float* dither) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const double scaled = source[i] * PCM24_SCALE + static_cast<double>(noiseAt(dither, i));
+            storePcm24(quantize<std::int32_t, double>(scaled, PCM24_MIN, PCM24_MAX), target + 3 * i);
+        }
+    }
+
+    void doubleToPcm24(const double* source, std::uint8_t* target, std::size_t count, const float* dither) noexcept
+    {
+        std::size_t i = 0;
+#ifdef WAV_CONVERSION_SSE2
+        const __m128d scale = _mm_set1_pd(PCM24_SCALE);
+        const __m128d min = _mm_set1_pd(PCM24_MIN);
+        const __m128d max = _mm_set1_pd(PCM24_MAX);
+        for (; i + 4 <= count; i += 4)
+        {
+            storePcm24(quantize(source + i, scale, min, max, dither ? dither + i : nullptr), target + 3 * i);
+        }
+#endif
+        doubleToPcm24Scalar(source + i, target + 3 * i, count - i, dither ? dither + i : nullptr);
+    }
+
+    void doubleToPcm32Scalar(const double* source, std::int32_t* target, std::size_t count, const float* dither) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const double scaled = source[i] * PCM32_SCALE + static_cast<double>(noiseAt(dither, i));
+            target[i] = quantize<std::int32_t>(scaled, PCM32_MIN, PCM32_MAX);
+        }
+    }
+
+    void doubleToPcm32(const double* source, std::int32_t* target, std::size_t count, const float* dither) noexcept
+    {
+        std::size_t i = 0;
+#ifdef WAV_CONVERSION_SSE2
+        const __m128d scale = _mm_set1_pd(PCM32_SCALE);
+        const __m128d min = _mm_set1_pd(PCM32_MIN);
+        const __m128d max = _mm_set1_pd(PCM32_MAX);
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), quantize(source + i, scale, min, max, dither ? dither + i : nullptr));
+        }
+#endif
+        doubleToPcm32Scalar(source + i, target + i, count - i, dither ? dither + i : nullptr);
+    }
+
+    void doubleToFloat32Scalar(const double* source, float* target, std::size_t count) noexcept
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            target[i] = static_cast<float>(source[i]);
+        }
+    }
+
+    void doubleToFloat32(const double* source, float* target, std::size_t count) noexcept
+    {
+        std::size_t i = 0;
+#ifdef WAV_CONVERSION_SSE2
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 low = _mm_cvtpd_ps(_mm_loadu_pd(source + i));
+            const __m128 high = _mm_cvtpd_ps(_mm_loadu_pd(source + i + 2));
+            _mm_storeu_ps(target + i, _mm_movelh_ps(low, high));
+        }
+#endif
+        doubleToFloat32Scalar(source + i, target + i, count - i);
+    }
+}
@@ -1,8 +1,11 @@
 // Copyright DEWETRON GmbH 2020
 
 #include "wav_writer.h"
+#include "wav_sample_conversion.h"
 #include "odkuni_assert.h"
+#include "odkuni_defines.h"
 #include <boost/static_assert.hpp>
+#include <algorithm>
 #include <cstring>
 #include <ios>
 #include <stdexcept>
@@ -15,13 +18,97 @@
 #endif
 #endif
 
+#if defined(__unix__) || defined(__APPLE__)
+#define WAV_WRITER_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace
 {
+    /// frames converted at once, small enough to stay in the cache
+    const std::size_t CONVERSION_FRAMES = 4096;
+    const std::size_t MAX_SAMPLE_SIZE = sizeof(double);
+
+    /// converts one channel to the sample format of the file, dither is NULL for float formats
+    template <class Sample>
+    using ConvertSamples = void (*)(const Sample* source, std::uint8_t* target, std::size_t count, const float* dither);
+
+    void convertPcm16(const float* source, std::uint8_t* target, std::size_t count, const float* dither)
+    {
+        wav_conversion::floatToPcm16(source, reinterpret_cast<std::int16_t*>(target), count, dither);
+    }
+
+    void convertPcm16(const double* source, std::uint8_t* target, std::size_t count, const float* dither)
+    {
+        wav_conversion::doubleToPcm16(source, reinterpret_cast<std::int16_t*>(target), count, dither);
+    }
+
+    void convertPcm24(const float* source, std::uint8_t* target, std::size_t count, const float* dither)
+    {
+        wav_conversion::floatToPcm24(source, target, count, dither);
+    }
+
+    void convertPcm24(const double* source, std::uint8_t* target, std::size_t count, const float* dither)
+    {
+        wav_conversion::doubleToPcm24(source, target, count, dither);
+    }
+
+    void convertPcm32(const float* source, std::uint8_t* target, std::size_t count, const float* dither)
+    {
+        wav_conversion::floatToPcm32(source, reinterpret_cast<std::int32_t*>(target), count, dither);
+    }
+
+    void convertPcm32(const double* source, std::uint8_t* target, std::size_t count, const float* dither)
+    {
+        wav_conversion::doubleToPcm32(source, reinterpret_cast<std::int32_t*>(target), count, dither);
+    }
+
+    /// converts between 32 and 64 bit float, samples of the same size are copied without conversion
+    void convertFloat(const float* source, std::uint8_t* target, std::size_t count, const float*)
+    {
+        wav_conversion::floatToFloat64(source, reinterpret_cast<double*>(target), count);
+    }
+
+    void convertFloat(const double* source, std::uint8_t* target, std::size_t count, const float*)
+    {
+        wav_conversion::doubleToFloat32(source, reinterpret_cast<float*>(target), count);
+    }
+
+    /// samples of one channel are stored every frame_size bytes
+    template <std::size_t SampleSize>
+    void interleaveChannel(const std::uint8_t* samples, std::uint8_t* target, std::size_t count, std::size_t frame_size)
+    {
+        for (std::size_t i = 0; i < count; ++i, target += frame_size)
+        {
+            std::memcpy(target, samples + i * SampleSize, SampleSize);
+        }
+    }
+
+    void interleaveChannel(const std::uint8_t* samples, std::uint8_t* target, std::size_t count, std::size_t sample_size, std::size_t frame_size)
+    {
+        switch (sample_size)
+        {
+        case 2: interleaveChannel<2>(samples, target, count, frame_size); break;
+        case 3: interleaveChannel<3>(samples, target, count, frame_size); break;
+        case 4: interleaveChannel<4>(samples, target, count, frame_size); break;
+        case 8: interleaveChannel<8>(samples, target, count, frame_size); break;
+        default:
+            ODK_ASSERT(false);
+        }
+    }
+
+    /// size fields of RF64 files that are replaced by the ds64 chunk
+    const std::uint64_t MAX_CHUNK_SIZE = 0xFFFFFFFF;
+
     struct Chunk
     {
-        Chunk(const char* id, std::size_t size)
+        Chunk(const char* id, std::uint64_t size)
             : size(static_cast<std::uint32_t>(size))
         {
+            ODK_ASSERT(size <= MAX_CHUNK_SIZE);
             BOOST_STATIC_ASSERT(sizeof(*this) == 8);
             ODK_ASSERT(std::strlen(id) == 4);
             std::memcpy(this->id, id, sizeof(this->id));
@@ -32,8 +119,8 @@ namespace
 
     struct RiffWaveHeader : public Chunk
     {
-        RiffWaveHeader(std::size_t size)
-            : Chunk("RIFF", size + sizeof(this->wave))
+        RiffWaveHeader(const char* id, std::uint64_t size)
+            : Chunk(id, size)
         {
             BOOST_STATIC_ASSERT(sizeof(*this) == 12);
             memcpy(this->wave, "WAVE", sizeof(this->wave));
@@ -57,6 +144,34 @@ namespace
         std::uint16_t bits_per_sample;
     };
 
+    /**
+     * 64 bit sizes of an RF64 file (EBU Tech 3306), written as JUNK chunk of the same size
+     * to RIFF files that might have to be converted to RF64
+     */
+    struct DataSize64Header : public Chunk
+    {
+        DataSize64Header(const char* id, std::uint64_t riff_size, std::uint64_t data_size, std::uint64_t sample_count)
+            : Chunk(id, sizeof(*this) - 8)
+            , riff_size_low(static_cast<std::uint32_t>(riff_size))
+            , riff_size_high(static_cast<std::uint32_t>(riff_size >> 32))
+            , data_size_low(static_cast<std::uint32_t>(data_size))
+            , data_size_high(static_cast<std::uint32_t>(data_size >> 32))
+            , sample_count_low(static_cast<std::uint32_t>(sample_count))
+            , sample_count_high(static_cast<std::uint32_t>(sample_count >> 32))
+            , table_length(0)
+        {
+            BOOST_STATIC_ASSERT(sizeof(*this) == (28 + 8));
+        }
+
+        std::uint32_t riff_size_low;
+        std::uint32_t riff_size_high;
+        std::uint32_t data_size_low;
+        std::uint32_t data_size_high;
+        std::uint32_t sample_count_low;
+        std::uint32_t sample_count_high;
+        std::uint32_t table_length;
+    };
+
 #ifdef _MSC_VER
     std::wstring utf8ToUtf32(const std::string& src)
     {
@@ -95,38 +210,279 @@ namespace
 
 WavWriter::WavWriter(const char* filename)
     : m_file(NULL)
+    , m_format(WavFormatTag::WAV_FORMAT_PCM)
+    , m_bits_per_sample(0)
+    , m_sample_rate(0)
     , m_num_channels(0)
     , m_num_samples(0)
     , m_sample_size(0)
     , m_samples_written(0)
+    , m_header_layout(HeaderLayout::COMPACT)
+    , m_lazy_header(false)
+    , m_io_mode(WavIoMode::BUFFERED)
+    , m_dither(false)
+    , m_data_offset(0)
+    , m_data_written(0)
+    , m_allocated(0)
+    , m_window(NULL)
+    , m_window_length(0)
+    , m_write_begin(NULL)
+    , m_write_capacity(0)
+    , m_buffer_used(0)
 {
     m_file = openFileUtf8(filename);
 }
 
 WavWriter::WavWriter(FILE* file)
     : m_file(file)
+    , m_format(WavFormatTag::WAV_FORMAT_PCM)
+    , m_bits_per_sample(0)
+    , m_sample_rate(0)
     , m_num_channels(0)
     , m_num_samples(0)
     , m_sample_size(0)
     , m_samples_written(0)
+    , m_header_layout(HeaderLayout::COMPACT)
+    , m_lazy_header(false)
+    , m_io_mode(WavIoMode::BUFFERED)
+    , m_dither(false)
+    , m_data_offset(0)
+    , m_data_written(0)
+    , m_allocated(0)
+    , m_window(NULL)
+    , m_window_length(0)
+    , m_write_begin(NULL)
+    , m_write_capacity(0)
+    , m_buffer_used(0)
 {
 }
 
+const std::size_t WavWriter::WRITE_BUFFER_SIZE;
+const std::size_t WavWriter::MAP_WINDOW_SIZE;
+
 WavWriter::~WavWriter()
 {
-    close();
+    try
+    {
+        close();
+    }
+    catch (const std::exception&)
+    {
+        // the destructor must not throw, call close to handle write errors
+    }
 }
 
 void WavWriter::close()
 {
     if (m_file)
     {
-        fclose(m_file);
+        FILE* file = m_file;
+        try
+        {
+            flush();
+            if (m_lazy_header)
+            {
+                writeHeaderChunks(m_num_channels != 0 ? m_samples_written / m_num_channels : 0);
+            }
+            if (m_io_mode == WavIoMode::MEMORY_MAPPED)
+            {
+                truncateFile();
+            }
+        }
+        catch (...)
+        {
+            m_file = NULL;
+            fclose(file);
+            throw;
+        }
         m_file = NULL;
+        fclose(file);
+    }
+}
+
+void WavWriter::setIoMode(WavIoMode mode)
+{
+    ODK_ASSERT(m_buffer_used == 0 && m_window == NULL);
+#ifdef WAV_WRITER_MMAP
+    m_io_mode = mode;
+#else
+    ODK_UNUSED(mode);
+#endif
+    m_write_begin = NULL;
+    m_write_capacity = 0;
+}
+
+WavIoMode WavWriter::getIoMode() const
+{
+    return m_io_mode;
+}
+
+void WavWriter::flush()
+{
+    if (m_io_mode == WavIoMode::MEMORY_MAPPED)
+    {
+        unmapWindow();
+        return;
+    }
+    if (m_buffer_used == 0)
+    {
+        return;
+    }
+    const std::size_t size = m_buffer_used;
+    m_buffer_used = 0;
+    if (NULL == m_file || 1 != fwrite(m_buffer.data(), size, 1, m_file))
+    {
+        throw std::ios_base::failure("Unable to write samples");
+    }
+    m_data_written += size;
+}
+
+void WavWriter::reserveWriteSpace(std::size_t size)
+{
+    if (m_write_begin && m_write_capacity - m_buffer_used >= size)
+    {
+        return;
+    }
+    flush();
+    if (m_io_mode == WavIoMode::MEMORY_MAPPED)
+    {
+        mapWindow(size);
+        return;
+    }
+    if (m_buffer.size() < std::max(WRITE_BUFFER_SIZE, size))
+    {
+        m_buffer.resize(std::max(WRITE_BUFFER_SIZE, size));
+    }
+    m_write_begin = m_buffer.data();
+    m_write_capacity = m_buffer.size();
+}
+
+void WavWriter::mapWindow(std::size_t size)
+{
+#ifdef WAV_WRITER_MMAP
+    ODK_ASSERT(m_window == NULL);
+    if (NULL == m_file)
+    {
+        throw std::runtime_error("Unable to write to file");
+    }
+
+    // mappings start at a page boundary, the data chunk does not
+    const std::uint64_t offset = m_data_offset + m_data_written;
+    const std::uint64_t page_size = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    const std::uint64_t map_offset = offset - offset % page_size;
+    const std::size_t capacity = std::max(MAP_WINDOW_SIZE, size);
+    const std::size_t length = static_cast<std::size_t>(offset - map_offset) + capacity;
+    allocateFile(map_offset + length);
+
+    void* window = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(m_file), static_cast<off_t>(map_offset));
+    if (window == MAP_FAILED)
+    {
+        throw std::ios_base::failure("Unable to map file");
+    }
+    madvise(window, length, MADV_SEQUENTIAL);
+
+    m_window = static_cast<std::uint8_t*>(window);
+    m_window_length = length;
+    m_write_begin = m_window + (offset - map_offset);
+    m_write_capacity = capacity;
+    m_buffer_used = 0;
+#else
+    ODK_UNUSED(size);
+    throw std::runtime_error("Memory mapped files are not supported");
+#endif
+}
+
+void WavWriter::unmapWindow()
+{
+    if (m_window == NULL)
+    {
+        return;
+    }
+    m_data_written += m_buffer_used;
+    m_buffer_used = 0;
+    std::uint8_t* const window = m_window;
+    const std::size_t length = m_window_length;
+    m_window = NULL;
+    m_window_length = 0;
+    m_write_begin = NULL;
+    m_write_capacity = 0;
+#ifdef WAV_WRITER_MMAP
+    // starts writing back the window while the next one is filled
+    const bool synced = 0 == msync(window, length, MS_ASYNC);
+    if (0 != munmap(window, length) || !synced)
+    {
+        throw std::ios_base::failure("Unable to write samples");
     }
+#else
+    ODK_UNUSED(window);
+    ODK_UNUSED(length);
+#endif
+}
+
+void WavWriter::allocateFile(std::uint64_t size)
+{
+#ifdef WAV_WRITER_MMAP
+    if (size <= m_allocated)
+    {
+        return;
+    }
+    const int fd = fileno(m_file);
+    struct stat file_stat;
+    if (0 != fstat(fd, &file_stat))
+    {
+        throw std::ios_base::failure("Unable to allocate file");
+    }
+    if (static_cast<std::uint64_t>(file_stat.st_size) < size)
+    {
+#ifdef __linux__
+        // reserves the blocks, so running out of disk space does not fault in a mapped write
+        const bool allocated = 0 == posix_fallocate(fd, 0, static_cast<off_t>(size));
+#else
+        const bool allocated = false;
+#endif
+        if (!allocated && 0 != ftruncate(fd, static_cast<off_t>(size)))
+        {
+            throw std::ios_base::failure("Unable to allocate file");
+        }
+    }
+    m_allocated = size;
+#else
+    ODK_UNUSED(size);
+#endif
+}
+
+void WavWriter::truncateFile()
+{
+#ifdef WAV_WRITER_MMAP
+    const std::uint64_t size = m_data_offset + m_data_written;
+    if (m_allocated <= size)
+    {
+        return;
+    }
+    if (0 != fflush(m_file) || 0 != ftruncate(fileno(m_file), static_cast<off_t>(size)))
+    {
+        throw std::ios_base::failure("Unable to truncate file");
+    }
+    m_allocated = size;
+#endif
 }
 
 void WavWriter::writeHeader(WavFormatTag format, std::size_t bits_per_sample, std::uint32_t sample_rate, std::size_t num_channels, std::size_t num_samples)
+{
+    // the size fields of the compact header are limited to 32 bit
+    const std::uint64_t data_size = static_cast<std::uint64_t>(num_channels * ((bits_per_sample + 7) / 8)) * num_samples;
+    const std::uint64_t riff_size = 4 + sizeof(FormatHeader) + sizeof(Chunk) + data_size;
+    startFile(format, bits_per_sample, sample_rate, num_channels, num_samples,
+        riff_size > MAX_CHUNK_SIZE ? HeaderLayout::RESERVED : HeaderLayout::COMPACT, false);
+}
+
+void WavWriter::writeHeader(WavFormatTag format, std::size_t bits_per_sample, std::uint32_t sample_rate, std::size_t num_channels)
+{
+    startFile(format, bits_per_sample, sample_rate, num_channels, 0, HeaderLayout::RESERVED, true);
+}
+
+void WavWriter::startFile(WavFormatTag format, std::size_t bits_per_sample, std::uint32_t sample_rate, std::size_t num_channels, std::size_t num_samples,
+    HeaderLayout layout, bool lazy_header)
 {
     if (bits_per_sample % 8 != 0)
     {
@@ -138,55 +494,216 @@ void WavWriter::writeHeader(WavFormatTag format, std::size_t bits_per_sample, st
         throw std::runtime_error("Unable to write to file");
     }
 
+    flush();
+
+    m_format = format;
+    m_bits_per_sample = bits_per_sample;
+    m_sample_rate = sample_rate;
+    m_num_channels = num_channels;
+    m_num_samples = num_samples;
+    m_sample_size = bits_per_sample / 8;
+    m_samples_written = 0;
+    m_header_layout = layout;
+    m_lazy_header = lazy_header;
+    m_data_written = 0;
+
+    writeHeaderChunks(num_samples);
+
+    if (m_io_mode == WavIoMode::MEMORY_MAPPED && !lazy_header)
+    {
+        allocateFile(m_data_offset + static_cast<std::uint64_t>(num_channels * m_sample_size) * num_samples);
+    }
+}
+
+void WavWriter::writeHeaderChunks(std::uint64_t num_samples)
+{
     if (0 != fseek(m_file, 0, SEEK_SET))
     {
         throw std::runtime_error("Unable to seek in file");
     }
 
     FormatHeader formatheader;
-    formatheader.format_tag = static_cast<std::uint16_t>(format);
-    formatheader.channels = static_cast<std::uint16_t>(num_channels);
-    formatheader.sample_rate = static_cast<std::uint32_t>(sample_rate);
-    formatheader.bits_per_sample = static_cast<std::uint16_t>(bits_per_sample);
-    formatheader.block_align = static_cast<std::uint16_t>(num_channels * ((bits_per_sample + 7) / 8));
-    formatheader.bytes_per_second = static_cast<std::uint32_t>(sample_rate * formatheader.block_align);
+    formatheader.format_tag = static_cast<std::uint16_t>(m_format);
+    formatheader.channels = static_cast<std::uint16_t>(m_num_channels);
+    formatheader.sample_rate = m_sample_rate;
+    formatheader.bits_per_sample = static_cast<std::uint16_t>(m_bits_per_sample);
+    formatheader.block_align = static_cast<std::uint16_t>(m_num_channels * ((m_bits_per_sample + 7) / 8));
+    formatheader.bytes_per_second = static_cast<std::uint32_t>(m_sample_rate * formatheader.block_align);
 
-    Chunk dataheader("data", formatheader.block_align * num_samples);
+    const std::uint64_t data_size = formatheader.block_align * num_samples;
+    const std::uint64_t reserved_size = m_header_layout == HeaderLayout::RESERVED ? sizeof(DataSize64Header) : 0;
+    const std::uint64_t riff_size = sizeof(RiffWaveHeader::wave) + reserved_size + sizeof(formatheader) + sizeof(Chunk) + data_size;
+    const bool rf64 = riff_size > MAX_CHUNK_SIZE;
+    ODK_ASSERT(!rf64 || m_header_layout == HeaderLayout::RESERVED);
 
-    const std::size_t filesize = sizeof(formatheader) + sizeof(dataheader) + dataheader.size;
-    RiffWaveHeader riff(filesize);
+    RiffWaveHeader riff(rf64 ? "RF64" : "RIFF", rf64 ? MAX_CHUNK_SIZE : riff_size);
     if (1 != fwrite(&riff, sizeof(riff), 1, m_file))
     {
         throw std::ios_base::failure("Unable to write RIFF header");
     }
 
+    if (m_header_layout == HeaderLayout::RESERVED)
+    {
+        const DataSize64Header ds64 = rf64 ? DataSize64Header("ds64", riff_size, data_size, num_samples) : DataSize64Header("JUNK", 0, 0, 0);
+        if (1 != fwrite(&ds64, sizeof(ds64), 1, m_file))
+        {
+            throw std::ios_base::failure("Unable to write ds64 header");
+        }
+    }
+
     if (1 != fwrite(&formatheader, sizeof(formatheader), 1, m_file))
     {
         throw std::ios_base::failure("Unable to write fmt header");
     }
 
+    Chunk dataheader("data", rf64 ? MAX_CHUNK_SIZE : data_size);
     if (1 != fwrite(&dataheader, sizeof(dataheader), 1, m_file))
     {
         throw std::ios_base::failure("Unable to write data header");
     }
-
-    m_num_channels = num_channels;
-    m_num_samples = num_samples;
-    m_sample_size = bits_per_sample / 8;
-    m_samples_written = 0;
+    m_data_offset = sizeof(riff) + reserved_size + sizeof(formatheader) + sizeof(dataheader);
 }
 
 void WavWriter::appendSamples(const void* value, std::size_t size)
 {
     ODK_ASSERT(size % m_sample_size == 0);
-    ODK_ASSERT(m_samples_written + size/m_sample_size <= m_num_channels * m_num_samples);
+    ODK_ASSERT(m_lazy_header || m_samples_written + size/m_sample_size <= m_num_channels * m_num_samples);
 
+    if (m_io_mode == WavIoMode::MEMORY_MAPPED)
+    {
+        const std::uint8_t* source = static_cast<const std::uint8_t*>(value);
+        for (std::size_t copied = 0; copied < size;)
+        {
+            reserveWriteSpace(1);
+            const std::size_t count = std::min(size - copied, m_write_capacity - m_buffer_used);
+            std::memcpy(m_write_begin + m_buffer_used, source + copied, count);
+            m_buffer_used += count;
+            copied += count;
+        }
+        m_samples_written += size / m_sample_size;
+        return;
+    }
+
+    // keeps the order with frames added before
+    flush();
     if (1 != fwrite(value, size, 1, m_file))
     {
         throw std::ios_base::failure("Unable to write samples");
     }
 
     m_samples_written += size / m_sample_size;
+    m_data_written += size;
+}
+
+template <class Sample>
+void WavWriter::appendConvertedFrames(const Sample* const* channels, std::size_t num_frames)
+{
+    // float samples of the size of the source are copied without conversion
+    ConvertSamples<Sample> convert = NULL;
+    bool supported = true;
+    if (m_format == WavFormatTag::WAV_FORMAT_PCM)
+    {
+        switch (m_sample_size)
+        {
+        case 2: convert = &convertPcm16; break;
+        case 3: convert = &convertPcm24; break;
+        case 4: convert = &convertPcm32; break;
+        default: supported = false;
+        }
+    }
+    else
+    {
+        switch (m_sample_size)
+        {
+        case 4:
+        case 8:
+            if (m_sample_size != sizeof(Sample))
+            {
+                convert = &convertFloat;
+            }
+            break;
+        default: supported = false;
+        }
+    }
+    if (!supported)
+    {
+        throw std::domain_error("WavWriter::appendFrames supports 16, 24 and 32 bit PCM and 32 and 64 bit float only");
+    }
+    ODK_ASSERT(m_lazy_header || m_samples_written + num_frames * m_num_channels <= m_num_channels * m_num_samples);
+
+    const std::size_t frame_size = m_num_channels * m_sample_size;
+    if (frame_size == 0)
+    {
+        return;
+    }
+    const bool dither = m_dither && m_format == WavFormatTag::WAV_FORMAT_PCM;
+    if (m_converted.size() < CONVERSION_FRAMES * MAX_SAMPLE_SIZE)
+    {
+        m_converted.resize(CONVERSION_FRAMES * MAX_SAMPLE_SIZE);
+    }
+    if (dither && m_dither_noise.size() < CONVERSION_FRAMES)
+    {
+        m_dither_noise.resize(CONVERSION_FRAMES);
+    }
+    // packed 24 bit samples are written bytewise
+    const std::size_t sample_alignment = m_sample_size == 3 ? 1 : m_sample_size;
+
+    std::size_t frame = 0;
+    while (frame < num_frames)
+    {
+        reserveWriteSpace(frame_size);
+        const std::size_t count = std::min(std::min(num_frames - frame, CONVERSION_FRAMES), (m_write_capacity - m_buffer_used) / frame_size);
+        std::uint8_t* const frames = m_write_begin + m_buffer_used;
+        for (std::size_t channel = 0; channel < m_num_channels; ++channel)
+        {
+            const Sample* const source = channels[channel] + frame;
+            std::uint8_t* const target = frames + channel * m_sample_size;
+            const float* noise = NULL;
+            if (dither)
+            {
+                m_dither_source.generate(m_dither_noise.data(), count);
+                noise = m_dither_noise.data();
+            }
+
+            const std::uint8_t* samples = reinterpret_cast<const std::uint8_t*>(source);
+            if (convert)
+            {
+                if (m_num_channels == 1 && reinterpret_cast<std::uintptr_t>(target) % sample_alignment == 0)
+                {
+                    convert(source, target, count, noise);
+                    continue;
+                }
+                convert(source, m_converted.data(), count, noise);
+                samples = m_converted.data();
+            }
+            if (m_num_channels == 1)
+            {
+                std::memcpy(target, samples, count * m_sample_size);
+            }
+            else
+            {
+                interleaveChannel(samples, target, count, m_sample_size, frame_size);
+            }
+        }
+        m_buffer_used += count * frame_size;
+        m_samples_written += count * m_num_channels;
+        frame += count;
+    }
+}
+
+void WavWriter::appendFrames(const float* const* channels, std::size_t num_frames)
+{
+    appendConvertedFrames(channels, num_frames);
+}
+
+void WavWriter::appendFrames(const double* const* channels, std::size_t num_frames)
+{
+    appendConvertedFrames(channels, num_frames);
+}
+
+void WavWriter::setDither(bool enabled)
+{
+    m_dither = enabled;
 }
 
 std::size_t WavWriter::samplesWritten() const
@@ -1,9 +1,15 @@
 // Copyright DEWETRON GmbH 2020
 
 #include "wav_writer.h"
+#include "wav_sample_conversion.h"
 
 //#include "uni_math_constants.h"
 #include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
 #include <boost/test/unit_test.hpp>
 
 #if _MSC_VER > 1920
@@ -17,6 +23,33 @@ namespace
     const int CHUNK_SIZE = 8;
     const int RIFFWAVE_SIZE = CHUNK_SIZE + 4;
     const int FORMAT_SIZE = CHUNK_SIZE + 16;
+    const int DS64_SIZE = CHUNK_SIZE + 28;
+
+    struct ReservedHeader
+    {
+        char riff[4];
+        uint32_t riff_length;
+        char wave[4];
+        char ds64[4];
+        uint32_t ds64_length;
+        uint32_t riff_size_low;
+        uint32_t riff_size_high;
+        uint32_t data_size_low;
+        uint32_t data_size_high;
+        uint32_t sample_count_low;
+        uint32_t sample_count_high;
+        uint32_t table_length;
+        char fmt[4];
+        uint32_t fmt_length;
+        uint16_t format_tag;
+        uint16_t channels;
+        uint32_t sample_rate;
+        uint32_t bytes_per_second;
+        uint16_t block_align;
+        uint16_t bits_per_sample;
+        char data[4];
+        uint32_t data_length;
+    };
 }
 
 BOOST_AUTO_TEST_CASE(WriteHeaderTest)
@@ -97,6 +130,569 @@ BOOST_AUTO_TEST_CASE(WriteSamplesTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(WriteRf64HeaderTest)
+{
+    // 8 channels with 16 bit exceed 4 GiB after 2^28 samples
+    const std::uint64_t num_samples = 300000000;
+    const std::uint64_t data_size = num_samples * 8 * 2;
+
+    FILE* tmp = std::tmpfile();
+    WavWriter writer(tmp);
+    writer.writeHeader(WavFormatTag::WAV_FORMAT_PCM, 16, 48000, 8, static_cast<std::size_t>(num_samples));
+
+    ReservedHeader header;
+    BOOST_CHECK_EQUAL(sizeof(header), RIFFWAVE_SIZE + DS64_SIZE + FORMAT_SIZE + CHUNK_SIZE);
+    BOOST_REQUIRE_EQUAL(0, fseek(tmp, 0, SEEK_SET));
+    BOOST_REQUIRE_EQUAL(1, fread(&header, sizeof(header), 1, tmp));
+    BOOST_CHECK(!std::strncmp(header.riff, "RF64", 4));
+    BOOST_CHECK_EQUAL(header.riff_length, 0xFFFFFFFF);
+    BOOST_CHECK(!std::strncmp(header.wave, "WAVE", 4));
+    BOOST_CHECK(!std::strncmp(header.ds64, "ds64", 4));
+    BOOST_CHECK_EQUAL(header.ds64_length, 28);
+    const std::uint64_t riff_size = (static_cast<std::uint64_t>(header.riff_size_high) << 32) | header.riff_size_low;
+    BOOST_CHECK_EQUAL(riff_size, 4 + DS64_SIZE + FORMAT_SIZE + CHUNK_SIZE + data_size);
+    BOOST_CHECK_EQUAL((static_cast<std::uint64_t>(header.data_size_high) << 32) | header.data_size_low, data_size);
+    BOOST_CHECK_EQUAL((static_cast<std::uint64_t>(header.sample_count_high) << 32) | header.sample_count_low, num_samples);
+    BOOST_CHECK_EQUAL(header.table_length, 0);
+    BOOST_CHECK(!std::strncmp(header.fmt, "fmt ", 4));
+    BOOST_CHECK_EQUAL(header.channels, 8);
+    BOOST_CHECK_EQUAL(header.block_align, 16);
+    BOOST_CHECK(!std::strncmp(header.data, "data", 4));
+    BOOST_CHECK_EQUAL(header.data_length, 0xFFFFFFFF);
+}
+
+BOOST_AUTO_TEST_CASE(WriteLazyHeaderTest)
+{
+    const char* filename = "wav_writer_lazy_header_test.wav";
+    {
+        WavWriter writer(filename);
+        writer.writeHeader(WavFormatTag::WAV_FORMAT_PCM, 16, 44100, 2);
+        for (int16_t n = 0; n < 14; ++n)
+        {
+            writer.appendSamples(&n, sizeof(int16_t));
+        }
+        writer.close();
+    }
+
+    FILE* file = std::fopen(filename, "rb");
+    BOOST_REQUIRE(file);
+    ReservedHeader header;
+    const bool header_read = 1 == fread(&header, sizeof(header), 1, file);
+    std::vector<int16_t> samples(15);
+    const std::size_t samples_read = fread(samples.data(), sizeof(int16_t), samples.size(), file);
+    std::fclose(file);
+    std::remove(filename);
+
+    BOOST_REQUIRE(header_read);
+    BOOST_CHECK(!std::strncmp(header.riff, "RIFF", 4));
+    BOOST_CHECK_EQUAL(header.riff_length, 4 + DS64_SIZE + FORMAT_SIZE + CHUNK_SIZE + 14 * 2);
+    // space for a ds64 chunk that is not needed
+    BOOST_CHECK(!std::strncmp(header.ds64, "JUNK", 4));
+    BOOST_CHECK_EQUAL(header.ds64_length, 28);
+    BOOST_CHECK(!std::strncmp(header.fmt, "fmt ", 4));
+    BOOST_CHECK_EQUAL(header.channels, 2);
+    BOOST_CHECK_EQUAL(header.sample_rate, 44100);
+    BOOST_CHECK(!std::strncmp(header.data, "data", 4));
+    BOOST_CHECK_EQUAL(header.data_length, 14 * 2);
+
+    BOOST_REQUIRE_EQUAL(samples_read, 14);
+    for (int16_t n = 0; n < 14; ++n)
+    {
+        BOOST_CHECK_EQUAL(samples[n], n);
+    }
+}
+
+namespace
+{
+    std::vector<float> conversionTestValues()
+    {
+        std::vector<float> values = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 1.5f, -2.0f, 0.99999f, -0.99999f, 1e30f, -1e30f,
+            std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() };
+        for (int i = 0; i < 100; ++i)
+        {
+            values.push_back(static_cast<float>(std::sin(0.37 * i) * 1.2));
+        }
+        return values;
+    }
+
+    std::vector<float> ditherNoise(std::size_t count)
+    {
+        std::vector<float> noise(count);
+        wav_conversion::TpdfDither dither(42);
+        dither.generate(noise.data(), noise.size());
+        return noise;
+    }
+
+    std::int32_t pcm24Sample(const std::vector<std::uint8_t>& data, std::size_t index)
+    {
+        const std::uint32_t value = data[3 * index] | (data[3 * index + 1] << 8) | (data[3 * index + 2] << 16);
+        // sign extension of the 24 bit value
+        return static_cast<std::int32_t>(value << 8) >> 8;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ConvertToPcm16Test)
+{
+    const auto values = conversionTestValues();
+
+    std::vector<std::int16_t> expected(values.size());
+    std::vector<std::int16_t> converted(values.size());
+    wav_conversion::floatToPcm16Scalar(values.data(), expected.data(), values.size());
+    wav_conversion::floatToPcm16(values.data(), converted.data(), values.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(converted.begin(), converted.end(), expected.begin(), expected.end());
+
+    BOOST_CHECK_EQUAL(expected[1], 16384);
+    BOOST_CHECK_EQUAL(expected[2], -16384);
+    BOOST_CHECK_EQUAL(expected[3], 32767);
+    BOOST_CHECK_EQUAL(expected[4], -32768);
+    BOOST_CHECK_EQUAL(expected[5], 32767);
+    BOOST_CHECK_EQUAL(expected[6], -32768);
+    BOOST_CHECK_EQUAL(expected[7], 32767);
+    // -32767.67 is rounded to the nearest step
+    BOOST_CHECK_EQUAL(expected[8], -32768);
+    BOOST_CHECK_EQUAL(expected[11], 0);
+    BOOST_CHECK_EQUAL(expected[12], 32767);
+    BOOST_CHECK_EQUAL(expected[13], -32768);
+
+    const auto noise = ditherNoise(values.size());
+    wav_conversion::floatToPcm16Scalar(values.data(), expected.data(), values.size(), noise.data());
+    wav_conversion::floatToPcm16(values.data(), converted.data(), values.size(), noise.data());
+    BOOST_CHECK_EQUAL_COLLECTIONS(converted.begin(), converted.end(), expected.begin(), expected.end());
+    // the dither does not wrap around clipped values
+    BOOST_CHECK_EQUAL(expected[5], 32767);
+    BOOST_CHECK_EQUAL(expected[6], -32768);
+    BOOST_CHECK_EQUAL(expected[11], 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConvertToPcm24Test)
+{
+    const auto values = conversionTestValues();
+
+    std::vector<std::uint8_t> expected(3 * values.size());
+    std::vector<std::uint8_t> converted(3 * values.size());
+    wav_conversion::floatToPcm24Scalar(values.data(), expected.data(), values.size());
+    wav_conversion::floatToPcm24(values.data(), converted.data(), values.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(converted.begin(), converted.end(), expected.begin(), expected.end());
+
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 0), 0);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 1), 4194304);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 2), -4194304);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 3), 8388607);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 4), -8388608);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 5), 8388607);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 6), -8388608);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 11), 0);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 12), 8388607);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 13), -8388608);
+
+    const auto noise = ditherNoise(values.size());
+    wav_conversion::floatToPcm24Scalar(values.data(), expected.data(), values.size(), noise.data());
+    wav_conversion::floatToPcm24(values.data(), converted.data(), values.size(), noise.data());
+    BOOST_CHECK_EQUAL_COLLECTIONS(converted.begin(), converted.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 5), 8388607);
+    BOOST_CHECK_EQUAL(pcm24Sample(expected, 6), -8388608);
+}
+
+BOOST_AUTO_TEST_CASE(ConvertToPcm32Test)
+{
+    const auto values = conversionTestValues();
+
+    std::vector<std::int32_t> expected(values.size());
+    std::vector<std::int32_t> converted(values.size());
+    wav_conversion::floatToPcm32Scalar(values.data(), expected.data(), values.size());
+    wav_conversion::floatToPcm32(values.data(), converted.data(), values.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(converted.begin(), converted.end(), expected.begin(), expected.end());
+
+    BOOST_CHECK_EQUAL(expected[0], 0);
+    BOOST_CHECK_EQUAL(expected[1], 1073741824);
+    BOOST_CHECK_EQUAL(expected[2], -1073741824);
+    BOOST_CHECK_EQUAL(expected[3], 2147483647);
+    BOOST_CHECK_EQUAL(expected[4], std::numeric_limits<std::int32_t>::min());
+    BOOST_CHECK_EQUAL(expected[5], 2147483647);
+    BOOST_CHECK_EQUAL(expected[6], std::numeric_limits<std::int32_t>::min());
+    BOOST_CHECK_EQUAL(expected[11], 0);
+    BOOST_CHECK_EQUAL(expected[12], 2147483647);
+    BOOST_CHECK_EQUAL(expected[13], std::numeric_limits<std::int32_t>::min());
+
+    const auto noise = ditherNoise(values.size());
+    wav_conversion::floatToPcm32Scalar(values.data(), expected.data(), values.size(), noise.data());
+    wav_conversion::floatToPcm32(values.data(), converted.data(), values.size(), noise.data());
+    BOOST_CHECK_EQUAL_COLLECTIONS(converted.begin(), converted.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(ConvertToFloat64Test)
+{
+    auto values = conversionTestValues();
+    // NaN does not compare equal
+    values.erase(values.begin() + 11);
+
+    std::vector<double> expected(values.size());
+    std::vector<double> converted(values.size());
+    wav_conversion::floatToFloat64Scalar(values.data(), expected.data(), values.size());
+    wav_conversion::floatToFloat64(values.data(), converted.data(), values.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(converted.begin(), converted.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(expected[5], 1.5);
+    BOOST_CHECK_EQUAL(expected[9], static_cast<double>(1e30f));
+}
+
+BOOST_AUTO_TEST_CASE(ConvertDoubleTest)
+{
+    const auto float_values = conversionTestValues();
+    std::vector<double> values(float_values.begin(), float_values.end());
+    // steps of one LSB of 32 bit PCM, float has only 24 bit to represent them
+    values.push_back((1073741824.0 + 1.0) / 2147483648.0);
+    values.push_back(-(1073741824.0 + 3.0) / 2147483648.0);
+    const std::size_t count = values.size();
+    const auto noise = ditherNoise(count);
+
+    std::vector<std::int16_t> pcm16_expected(count);
+    std::vector<std::int16_t> pcm16_converted(count);
+    wav_conversion::doubleToPcm16Scalar(values.data(), pcm16_expected.data(), count);
+    wav_conversion::doubleToPcm16(values.data(), pcm16_converted.data(), count);
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm16_converted.begin(), pcm16_converted.end(), pcm16_expected.begin(), pcm16_expected.end());
+    // widened float samples give the results of the float conversion
+    wav_conversion::floatToPcm16Scalar(float_values.data(), pcm16_converted.data(), float_values.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm16_converted.begin(), pcm16_converted.begin() + float_values.size(), pcm16_expected.begin(), pcm16_expected.begin() + float_values.size());
+    wav_conversion::doubleToPcm16Scalar(values.data(), pcm16_expected.data(), count, noise.data());
+    wav_conversion::doubleToPcm16(values.data(), pcm16_converted.data(), count, noise.data());
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm16_converted.begin(), pcm16_converted.end(), pcm16_expected.begin(), pcm16_expected.end());
+
+    std::vector<std::uint8_t> pcm24_expected(3 * count);
+    std::vector<std::uint8_t> pcm24_converted(3 * count);
+    wav_conversion::doubleToPcm24Scalar(values.data(), pcm24_expected.data(), count);
+    wav_conversion::doubleToPcm24(values.data(), pcm24_converted.data(), count);
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm24_converted.begin(), pcm24_converted.end(), pcm24_expected.begin(), pcm24_expected.end());
+    wav_conversion::floatToPcm24Scalar(float_values.data(), pcm24_converted.data(), float_values.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm24_converted.begin(), pcm24_converted.begin() + 3 * float_values.size(), pcm24_expected.begin(), pcm24_expected.begin() + 3 * float_values.size());
+    BOOST_CHECK_EQUAL(pcm24Sample(pcm24_expected, 1), 4194304);
+    wav_conversion::doubleToPcm24Scalar(values.data(), pcm24_expected.data(), count, noise.data());
+    wav_conversion::doubleToPcm24(values.data(), pcm24_converted.data(), count, noise.data());
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm24_converted.begin(), pcm24_converted.end(), pcm24_expected.begin(), pcm24_expected.end());
+
+    std::vector<std::int32_t> pcm32_expected(count);
+    std::vector<std::int32_t> pcm32_converted(count);
+    wav_conversion::doubleToPcm32Scalar(values.data(), pcm32_expected.data(), count);
+    wav_conversion::doubleToPcm32(values.data(), pcm32_converted.data(), count);
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm32_converted.begin(), pcm32_converted.end(), pcm32_expected.begin(), pcm32_expected.end());
+    wav_conversion::floatToPcm32Scalar(float_values.data(), pcm32_converted.data(), float_values.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm32_converted.begin(), pcm32_converted.begin() + float_values.size(), pcm32_expected.begin(), pcm32_expected.begin() + float_values.size());
+    BOOST_CHECK_EQUAL(pcm32_expected[count - 2], 1073741825);
+    BOOST_CHECK_EQUAL(pcm32_expected[count - 1], -1073741827);
+    wav_conversion::doubleToPcm32Scalar(values.data(), pcm32_expected.data(), count, noise.data());
+    wav_conversion::doubleToPcm32(values.data(), pcm32_converted.data(), count, noise.data());
+    BOOST_CHECK_EQUAL_COLLECTIONS(pcm32_converted.begin(), pcm32_converted.end(), pcm32_expected.begin(), pcm32_expected.end());
+
+    // NaN does not compare equal
+    values.erase(values.begin() + 11);
+    std::vector<float> float32_expected(values.size());
+    std::vector<float> float32_converted(values.size());
+    wav_conversion::doubleToFloat32Scalar(values.data(), float32_expected.data(), values.size());
+    wav_conversion::doubleToFloat32(values.data(), float32_converted.data(), values.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(float32_converted.begin(), float32_converted.end(), float32_expected.begin(), float32_expected.end());
+    BOOST_CHECK_EQUAL(float32_expected[5], 1.5f);
+}
+
+
+BOOST_AUTO_TEST_CASE(TpdfDitherTest)
+{
+    const std::size_t count = 100000;
+    const auto noise = ditherNoise(count);
+    BOOST_CHECK(noise == ditherNoise(count));
+
+    double sum = 0;
+    std::size_t center = 0;
+    for (const float value : noise)
+    {
+        BOOST_REQUIRE(value > -1.0f && value < 1.0f);
+        sum += value;
+        // a triangular distribution has 3/4 of its values in (-0.5, 0.5)
+        if (std::abs(value) < 0.5f)
+        {
+            ++center;
+        }
+    }
+    BOOST_CHECK_SMALL(sum / count, 0.01);
+    BOOST_CHECK_CLOSE(static_cast<double>(center) / count, 0.75, 2.0);
+}
+
+BOOST_AUTO_TEST_CASE(AppendFramesTest)
+{
+    // more than fits into the write buffer
+    const std::size_t num_channels = 3;
+    const std::size_t num_frames = 200000;
+    std::vector<std::vector<float>> channels(num_channels, std::vector<float>(num_frames));
+    for (std::size_t channel = 0; channel < num_channels; ++channel)
+    {
+        for (std::size_t frame = 0; frame < num_frames; ++frame)
+        {
+            channels[channel][frame] = static_cast<float>(std::sin(0.01 * static_cast<double>(frame)) * (0.5 + static_cast<double>(channel) * 0.4));
+        }
+    }
+
+    const std::pair<WavFormatTag, std::size_t> formats[] = {
+        { WavFormatTag::WAV_FORMAT_PCM, 2 }, { WavFormatTag::WAV_FORMAT_PCM, 3 }, { WavFormatTag::WAV_FORMAT_PCM, 4 },
+        { WavFormatTag::WAV_FORMAT_FLOAT, 4 }, { WavFormatTag::WAV_FORMAT_FLOAT, 8 } };
+    for (const auto& sample_format : formats)
+    {
+        const WavFormatTag format = sample_format.first;
+        const std::size_t sample_size = sample_format.second;
+        FILE* tmp = std::tmpfile();
+        WavWriter writer(tmp);
+        writer.writeHeader(format, sample_size * 8, 44100, num_channels, num_frames + 1);
+
+        // blocks of different sizes
+        std::size_t frame = 0;
+        for (std::size_t block = 1; frame < num_frames; block = block * 3 + 1)
+        {
+            const std::size_t count = std::min(block, num_frames - frame);
+            const float* block_channels[num_channels] = { channels[0].data() + frame, channels[1].data() + frame, channels[2].data() + frame };
+            writer.appendFrames(block_channels, count);
+            frame += count;
+        }
+        // written behind the buffered frames
+        std::vector<std::uint8_t> marker(num_channels * sample_size);
+        for (std::size_t i = 0; i < marker.size(); ++i)
+        {
+            marker[i] = static_cast<std::uint8_t>(i + 1);
+        }
+        writer.appendSamples(marker.data(), marker.size());
+        BOOST_CHECK_EQUAL(writer.samplesWritten(), (num_frames + 1) * num_channels);
+
+        BOOST_REQUIRE_EQUAL(0, fseek(tmp, RIFFWAVE_SIZE + FORMAT_SIZE + CHUNK_SIZE, SEEK_SET));
+        std::vector<std::uint8_t> data((num_frames + 1) * num_channels * sample_size);
+        BOOST_REQUIRE_EQUAL(1, fread(data.data(), data.size(), 1, tmp));
+
+        bool equal = true;
+        for (std::size_t channel = 0; channel < num_channels; ++channel)
+        {
+            std::vector<std::uint8_t> expected(num_frames * sample_size);
+            const float* const source = channels[channel].data();
+            if (format == WavFormatTag::WAV_FORMAT_PCM)
+            {
+                switch (sample_size)
+                {
+                case 2: wav_conversion::floatToPcm16Scalar(source, reinterpret_cast<std::int16_t*>(expected.data()), num_frames); break;
+                case 3: wav_conversion::floatToPcm24Scalar(source, expected.data(), num_frames); break;
+                default: wav_conversion::floatToPcm32Scalar(source, reinterpret_cast<std::int32_t*>(expected.data()), num_frames); break;
+                }
+            }
+            else if (sample_size == sizeof(double))
+            {
+                wav_conversion::floatToFloat64Scalar(source, reinterpret_cast<double*>(expected.data()), num_frames);
+            }
+            else
+            {
+                std::memcpy(expected.data(), source, expected.size());
+            }
+            for (std::size_t i = 0; i < num_frames && equal; ++i)
+            {
+                equal = std::memcmp(&data[(i * num_channels + channel) * sample_size], &expected[i * sample_size], sample_size) == 0;
+            }
+        }
+        BOOST_CHECK(equal);
+        BOOST_CHECK_EQUAL(std::memcmp(&data[num_frames * num_channels * sample_size], marker.data(), marker.size()), 0);
+        writer.close();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(AppendDoubleFramesTest)
+{
+    const std::size_t num_channels = 2;
+    const std::size_t num_frames = 10000;
+    std::vector<std::vector<double>> channels(num_channels, std::vector<double>(num_frames));
+    for (std::size_t frame = 0; frame < num_frames; ++frame)
+    {
+        channels[0][frame] = std::sin(0.01 * static_cast<double>(frame));
+        channels[1][frame] = std::cos(0.02 * static_cast<double>(frame)) * 0.5;
+    }
+
+    const std::pair<WavFormatTag, std::size_t> formats[] = {
+        { WavFormatTag::WAV_FORMAT_PCM, 2 }, { WavFormatTag::WAV_FORMAT_PCM, 3 }, { WavFormatTag::WAV_FORMAT_PCM, 4 },
+        { WavFormatTag::WAV_FORMAT_FLOAT, 4 }, { WavFormatTag::WAV_FORMAT_FLOAT, 8 } };
+    for (const auto& sample_format : formats)
+    {
+        const WavFormatTag format = sample_format.first;
+        const std::size_t sample_size = sample_format.second;
+        FILE* tmp = std::tmpfile();
+        WavWriter writer(tmp);
+        writer.writeHeader(format, sample_size * 8, 44100, num_channels, num_frames);
+
+        std::size_t frame = 0;
+        for (std::size_t block = 1; frame < num_frames; block = block * 3 + 1)
+        {
+            const std::size_t count = std::min(block, num_frames - frame);
+            const double* block_channels[num_channels] = { channels[0].data() + frame, channels[1].data() + frame };
+            writer.appendFrames(block_channels, count);
+            frame += count;
+        }
+        writer.flush();
+
+        BOOST_REQUIRE_EQUAL(0, fseek(tmp, RIFFWAVE_SIZE + FORMAT_SIZE + CHUNK_SIZE, SEEK_SET));
+        std::vector<std::uint8_t> data(num_frames * num_channels * sample_size);
+        BOOST_REQUIRE_EQUAL(1, fread(data.data(), data.size(), 1, tmp));
+
+        bool equal = true;
+        for (std::size_t channel = 0; channel < num_channels; ++channel)
+        {
+            std::vector<std::uint8_t> expected(num_frames * sample_size);
+            const double* const source = channels[channel].data();
+            if (format == WavFormatTag::WAV_FORMAT_PCM)
+            {
+                switch (sample_size)
+                {
+                case 2: wav_conversion::doubleToPcm16Scalar(source, reinterpret_cast<std::int16_t*>(expected.data()), num_frames); break;
+                case 3: wav_conversion::doubleToPcm24Scalar(source, expected.data(), num_frames); break;
+                default: wav_conversion::doubleToPcm32Scalar(source, reinterpret_cast<std::int32_t*>(expected.data()), num_frames); break;
+                }
+            }
+            else if (sample_size == sizeof(float))
+            {
+                wav_conversion::doubleToFloat32Scalar(source, reinterpret_cast<float*>(expected.data()), num_frames);
+            }
+            else
+            {
+                // 64 bit float samples are copied as they are
+                std::memcpy(expected.data(), source, expected.size());
+            }
+            for (std::size_t i = 0; i < num_frames && equal; ++i)
+            {
+                equal = std::memcmp(&data[(i * num_channels + channel) * sample_size], &expected[i * sample_size], sample_size) == 0;
+            }
+        }
+        BOOST_CHECK(equal);
+        writer.close();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MemoryMappedTest)
+{
+    const std::size_t num_channels = 2;
+    const std::size_t num_frames = 100000;
+    std::vector<std::vector<float>> channels(num_channels, std::vector<float>(num_frames));
+    for (std::size_t frame = 0; frame < num_frames; ++frame)
+    {
+        channels[0][frame] = static_cast<float>(std::sin(0.01 * static_cast<double>(frame)));
+        channels[1][frame] = static_cast<float>(std::cos(0.02 * static_cast<double>(frame)) * 0.5);
+    }
+
+    // both backends have to produce the same file
+    const auto write_file = [&](WavIoMode mode, bool lazy_header) -> std::vector<char>
+    {
+        const char* filename = "wav_writer_memory_mapped_test.wav";
+        {
+            WavWriter writer(filename);
+            writer.setIoMode(mode);
+            if (lazy_header)
+            {
+                writer.writeHeader(WavFormatTag::WAV_FORMAT_PCM, 16, 44100, num_channels);
+            }
+            else
+            {
+                writer.writeHeader(WavFormatTag::WAV_FORMAT_PCM, 16, 44100, num_channels, num_frames + 1);
+            }
+            std::size_t frame = 0;
+            for (std::size_t block = 1; frame < num_frames; block = block * 5 + 3)
+            {
+                const std::size_t count = std::min(block, num_frames - frame);
+                const float* block_channels[num_channels] = { channels[0].data() + frame, channels[1].data() + frame };
+                writer.appendFrames(block_channels, count);
+                frame += count;
+            }
+            const std::int16_t marker[num_channels] = { 1, 2 };
+            writer.appendSamples(marker, sizeof(marker));
+            writer.close();
+        }
+
+        std::vector<char> content;
+        FILE* file = std::fopen(filename, "rb");
+        if (file)
+        {
+            char buffer[4096];
+            for (std::size_t read; (read = fread(buffer, 1, sizeof(buffer), file)) > 0;)
+            {
+                content.insert(content.end(), buffer, buffer + read);
+            }
+            std::fclose(file);
+        }
+        std::remove(filename);
+        return content;
+    };
+
+    for (const bool lazy_header : { false, true })
+    {
+        const auto buffered = write_file(WavIoMode::BUFFERED, lazy_header);
+        const auto mapped = write_file(WavIoMode::MEMORY_MAPPED, lazy_header);
+        BOOST_CHECK_EQUAL(buffered.size(), (lazy_header ? RIFFWAVE_SIZE + DS64_SIZE : RIFFWAVE_SIZE) + FORMAT_SIZE + CHUNK_SIZE + (num_frames + 1) * num_channels * 2);
+        BOOST_CHECK(buffered == mapped);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(AppendFramesUnsupportedFormatTest)
+{
+    FILE* tmp = std::tmpfile();
+    WavWriter writer(tmp);
+    writer.writeHeader(WavFormatTag::WAV_FORMAT_PCM, 8, 44100, 1, 1);
+    const float value = 0.0f;
+    const float* channels[1] = { &value };
+    BOOST_CHECK_THROW(writer.appendFrames(channels, 1), std::domain_error);
+    writer.writeHeader(WavFormatTag::WAV_FORMAT_FLOAT, 16, 44100, 1, 1);
+    BOOST_CHECK_THROW(writer.appendFrames(channels, 1), std::domain_error);
+}
+
+BOOST_AUTO_TEST_CASE(AppendFramesDitherTest)
+{
+    // a constant signal between two quantization steps
+    const std::size_t num_frames = 50000;
+    std::vector<float> channel(num_frames, 100.25f / 32768.0f);
+    const float* channels[1] = { channel.data() };
+
+    FILE* tmp = std::tmpfile();
+    WavWriter writer(tmp);
+    writer.writeHeader(WavFormatTag::WAV_FORMAT_PCM, 16, 44100, 1, num_frames);
+    writer.setDither(true);
+    writer.appendFrames(channels, num_frames);
+    writer.flush();
+
+    BOOST_REQUIRE_EQUAL(0, fseek(tmp, RIFFWAVE_SIZE + FORMAT_SIZE + CHUNK_SIZE, SEEK_SET));
+    std::vector<std::int16_t> samples(num_frames);
+    BOOST_REQUIRE_EQUAL(samples.size(), fread(samples.data(), sizeof(std::int16_t), samples.size(), tmp));
+
+    // dither of one LSB spreads the values over the neighbouring steps
+    double sum = 0;
+    for (const auto sample : samples)
+    {
+        BOOST_REQUIRE(sample >= 99 && sample <= 101);
+        sum += sample;
+    }
+    BOOST_CHECK_CLOSE(sum / num_frames, 100.25, 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(DitherMeanErrorTest)
+{
+    // silence and constant signals half a step off, mean and sign of the quantization error must not depend on them
+    const std::size_t count = 200000;
+    const auto noise = ditherNoise(count);
+    for (const double lsb : { 0.0, 0.5, -0.5 })
+    {
+        std::vector<double> values(count, lsb / 32768.0);
+        std::vector<std::int16_t> pcm16(count);
+        wav_conversion::doubleToPcm16(values.data(), pcm16.data(), count, noise.data());
+        std::vector<float> float_values(count, static_cast<float>(lsb / 8388608.0));
+        std::vector<std::uint8_t> pcm24(3 * count);
+        wav_conversion::floatToPcm24(float_values.data(), pcm24.data(), count, noise.data());
+
+        double pcm16_error = 0;
+        double pcm24_error = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            pcm16_error += pcm16[i] - lsb;
+            pcm24_error += pcm24Sample(pcm24, i) - lsb;
+        }
+        BOOST_CHECK_SMALL(pcm16_error / count, 0.01);
+        BOOST_CHECK_SMALL(pcm24_error / count, 0.01);
+    }
+}
+
 #if 0
 BOOST_AUTO_TEST_CASE(ExternalUsabiliyTest)
 {
@@ -0,0 +1,85 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkapi_block_descriptor_xml.h"
+
+#include <boost/lexical_cast.hpp>
+#include <pugixml.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    const std::uint64_t REGION_COUNT = 1000;
+    const int REPETITIONS = 200;
+
+    /// DOM based parsing as done before the pull parser was added
+    std::size_t parseWithDom(const std::string& xml)
+    {
+        odk::DataRegions data_regions;
+        pugi::xml_document doc;
+        doc.load_buffer(xml.data(), xml.size(), pugi::parse_default, pugi::encoding_utf8);
+        auto region_nodes = doc.document_element().select_nodes("DataRegion");
+        data_regions.m_data_regions.reserve(region_nodes.size());
+        for (auto region_node : region_nodes)
+        {
+            auto channel_id = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("channel_id").value());
+            auto begin = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("begin").value());
+            auto end = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("end").value());
+            data_regions.m_data_regions.emplace_back(channel_id, odk::Interval<std::uint64_t>(begin, end));
+        }
+        return data_regions.m_data_regions.size();
+    }
+
+    template <class Parse>
+    void measure(const char* name, Parse parse)
+    {
+        std::size_t regions = parse();
+        const auto start = std::chrono::steady_clock::now();
+        for (int repetition = 0; repetition < REPETITIONS; ++repetition)
+        {
+            regions += parse();
+        }
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        std::cout << name << " " << REGION_COUNT << " regions: " << elapsed.count() / REPETITIONS << " us per telegram"
+                  << " (" << regions / (REPETITIONS + 1) << " regions)" << std::endl;
+    }
+}
+
+int main()
+{
+    odk::DataRegions data_regions;
+    odk::BlockListDescriptor block_list;
+    block_list.m_block_count = 100;
+    block_list.m_windows.emplace_back(12.5, 13.5);
+    for (std::uint64_t region = 0; region < REGION_COUNT; ++region)
+    {
+        const odk::DataRegion data_region(region % 50, odk::Interval<std::uint64_t>(1000000 + region * 1000, 1000000 + region * 1000 + 500));
+        data_regions.m_data_regions.push_back(data_region);
+        block_list.m_invalid_regions.push_back(data_region);
+    }
+    const auto regions_xml = data_regions.generate();
+    const auto block_list_xml = block_list.generate();
+
+    measure("DataRegions DOM", [&regions_xml]()
+    {
+        return parseWithDom(regions_xml);
+    });
+
+    odk::DataRegions parsed_regions;
+    measure("DataRegions::parse", [&regions_xml, &parsed_regions]()
+    {
+        parsed_regions.parse(regions_xml);
+        return parsed_regions.m_data_regions.size();
+    });
+
+    odk::BlockListDescriptor parsed_block_list;
+    measure("BlockListDescriptor::parse", [&block_list_xml, &parsed_block_list]()
+    {
+        parsed_block_list.parse(block_list_xml);
+        return parsed_block_list.m_invalid_regions.size();
+    });
+    return 0;
+}
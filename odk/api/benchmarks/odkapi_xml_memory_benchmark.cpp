@@ -0,0 +1,85 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkapi_block_descriptor_xml.h"
+#include "odkapi_update_config_xml.h"
+#include "odkuni_xpugixml.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    const int REPETITIONS = 2000;
+
+    const char* const UPDATE_CONFIG_XML =
+        R"xxx(<?xml version="1.0"?><UpdateConfig protocol_version="1.0"><Channel local_id="2">)xxx"
+        R"xxx(<Property name="Frequency"><ScalarValue><Value>10000</Value><Unit>Hz</Unit></ScalarValue>)xxx"
+        R"xxx(<Constraints><DoubleRangeConstraint min="1" max="50000"/></Constraints></Property>)xxx"
+        R"xxx(<Property name="Waveform"><StringValue>Square</StringValue></Property></Channel></UpdateConfig>)xxx";
+
+    /// not in the form understood by the pull parser, uses the DOM and XPath
+    const char* const BLOCK_LIST_XML =
+        R"xxx(<BlockListDescriptor block_count="2"><!-- comment --><Intervals><Interval begin="0.5" end="1.5"/></Intervals></BlockListDescriptor>)xxx";
+
+    std::size_t processTelegrams()
+    {
+        odk::UpdateConfigTelegram update_config;
+        update_config.parse(UPDATE_CONFIG_XML);
+        const auto generated = update_config.generate();
+
+        odk::BlockListDescriptor block_list;
+        block_list.parse(BLOCK_LIST_XML);
+        return generated.size() + block_list.m_windows.size();
+    }
+
+    template <class Process>
+    double measure(Process process)
+    {
+        std::size_t result = process();
+        const auto start = std::chrono::steady_clock::now();
+        for (int repetition = 0; repetition < REPETITIONS; ++repetition)
+        {
+            result += process();
+        }
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        return result > 0 ? elapsed.count() / REPETITIONS : 0.0;
+    }
+}
+
+int main()
+{
+    {
+        pugi::xml_document doc;
+        doc.load_string(UPDATE_CONFIG_XML);
+        std::string xml;
+        const auto stream_time = measure([&doc]()
+        {
+            std::stringstream ss;
+            doc.save(ss, "", pugi::format_raw);
+            return ss.str().size();
+        });
+        const auto writer_time = measure([&doc, &xml]()
+        {
+            xpugi::toXML(doc, xml);
+            return xml.size();
+        });
+        std::cout << "save via std::stringstream: " << stream_time << " us, into reused std::string: " << writer_time << " us" << std::endl;
+    }
+
+    // pugixml has to be configured while no document exists
+    const auto malloc_time = measure(&processTelegrams);
+    xpugi::installMemoryCache();
+    const auto before = xpugi::getMemoryCacheStatistics();
+    const auto cached_time = measure(&processTelegrams);
+    const auto after = xpugi::getMemoryCacheStatistics();
+
+    const auto cycles = static_cast<double>(REPETITIONS + 1);
+    std::cout << "UpdateConfig parse + generate, BlockListDescriptor DOM parse: "
+              << malloc_time << " us with malloc, " << cached_time << " us with the memory cache" << std::endl;
+    std::cout << "pugixml allocations per cycle: " << static_cast<double>(after.m_allocations - before.m_allocations) / cycles
+              << ", from the system: " << static_cast<double>(after.m_system_allocations - before.m_system_allocations) / cycles << std::endl;
+    return 0;
+}
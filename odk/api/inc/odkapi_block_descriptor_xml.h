@@ -66,6 +66,8 @@ namespace odk
 
         std::vector<Interval<double>> m_windows;
         std::vector<DataRegion> m_invalid_regions;
+        /// true if the invalid regions of the windows are reported (InvalidRegions element present, even if empty)
+        bool m_invalid_regions_included;
     };
 
     class DataRegions
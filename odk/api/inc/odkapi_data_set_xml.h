@@ -75,12 +75,26 @@ namespace odk
 
         ODK_NODISCARD std::string generate() const;
 
+        /**
+         * Writes the same XML as generate() into xml, reusing its capacity
+         * The telegram is serialised directly, without building a document, so that requests
+         * sent every processing cycle only cost formatting the numbers.
+         */
+        void generate(std::string& xml) const;
+
         std::uint64_t m_id;
 
         boost::optional<DataWindow> m_data_window;
         boost::optional<SingleValue> m_single_value;
         boost::optional<DataStream> m_data_stream;
 
+        /**
+         * Asks the host to report the invalid regions of the data window in the BlockListDescriptor of the reply
+         * (@see BlockListDescriptor::m_invalid_regions_included), which saves a separate DATA_REGIONS_READ.
+         * Hosts without support ignore the attribute.
+         */
+        boost::optional<bool> m_include_regions;
+
     };
 
     class PluginDataStartRequest
@@ -142,6 +156,12 @@ namespace odk
 
         ODK_NODISCARD std::string generate() const;
 
+        /**
+         * Writes the same XML as generate() into xml, reusing its capacity
+         * @see PluginDataRequest::generate(std::string&)
+         */
+        void generate(std::string& xml) const;
+
         std::uint64_t m_id;
         boost::optional<DataWindow> m_data_window;
     };
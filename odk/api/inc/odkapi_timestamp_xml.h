@@ -10,6 +10,8 @@
 
 namespace odk
 {
+    class XmlPullParser;
+
     class Timestamp
     {
     public:
@@ -20,6 +22,11 @@ namespace odk
         ODK_NODISCARD std::string generate() const;
 
         bool parseTickFrequencyAttributes(const pugi::xml_node& node);
+        /**
+         * Reads the attributes of the current start tag of the pull parser without allocating memory.
+         * @return false if they are not in a form understood by the pull parser, the DOM overload has to be used then
+         */
+        bool parseTickFrequencyAttributes(XmlPullParser& parser) noexcept;
         void writeTickFrequencyAttributes(pugi::xml_node& node) const;
 
         ODK_NODISCARD bool timestampValid() const noexcept;
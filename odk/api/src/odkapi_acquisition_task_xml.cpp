@@ -5,12 +5,86 @@
 
 #include "odkbase_basic_values.h"
 
+#include "odkuni_xml_pull_parser.h"
 #include "odkuni_xpugixml.h"
 
 #include <boost/lexical_cast.hpp>
 
 namespace odk
 {
+    namespace
+    {
+        /**
+         * Pull parser path of AcquisitionTaskProcessTelegram::parse, returns false for anything it does not understand
+         */
+        bool readProcessTelegram(XmlPullParser& parser, AcquisitionTaskProcessTelegram& telegram) noexcept
+        {
+            if (parser.next() != XmlPullParser::Event::START_ELEMENT)
+            {
+                return false;
+            }
+
+            // other spellings of the version are left to the DOM path
+            bool version_seen = false;
+            boost::string_view name;
+            boost::string_view value;
+            while (parser.nextAttribute(name, value))
+            {
+                if (XmlPullParser::equals(name, "protocol_version") && !version_seen)
+                {
+                    version_seen = true;
+                    if (!XmlPullParser::equals(value, "1.0"))
+                    {
+                        return false;
+                    }
+                }
+            }
+            if (parser.failed())
+            {
+                return false;
+            }
+
+            bool start_seen = false;
+            bool end_seen = false;
+            for (;;)
+            {
+                switch (parser.next())
+                {
+                case XmlPullParser::Event::END_ELEMENT:
+                    return parser.next() == XmlPullParser::Event::END_DOCUMENT;
+                case XmlPullParser::Event::START_ELEMENT:
+                    if (parser.nameIs("Start") && !start_seen)
+                    {
+                        start_seen = true;
+                        if (!telegram.m_start.parseTickFrequencyAttributes(parser))
+                        {
+                            return false;
+                        }
+                    }
+                    else if (parser.nameIs("End") && !end_seen)
+                    {
+                        end_seen = true;
+                        if (!telegram.m_end.parseTickFrequencyAttributes(parser))
+                        {
+                            return false;
+                        }
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    if (parser.next() != XmlPullParser::Event::END_ELEMENT)
+                    {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+                }
+            }
+        }
+    }
+
     AddAcquisitionTaskTelegram::AddAcquisitionTaskTelegram() noexcept
         : m_id()
     {}
@@ -95,6 +169,19 @@ namespace odk
             return false;
         }
 
+        // sent for every processing cycle, read it without a DOM if possible
+        const auto start = m_start;
+        const auto end = m_end;
+        XmlPullParser parser(xml_string);
+        if (readProcessTelegram(parser, *this))
+        {
+            return true;
+        }
+
+        // not in the form understood by the pull parser, use the full parser
+        m_start = start;
+        m_end = end;
+
         pugi::xml_document doc;
         auto status = doc.load_buffer(xml_string.data(), xml_string.size(), pugi::parse_default, pugi::encoding_utf8);
         if (status.status == pugi::status_ok)
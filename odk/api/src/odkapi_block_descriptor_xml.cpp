@@ -2,6 +2,7 @@
 
 #include "odkapi_block_descriptor_xml.h"
 
+#include "odkuni_xml_pull_parser.h"
 #include "odkuni_xpugixml.h"
 
 #include <boost/lexical_cast.hpp>
@@ -9,6 +10,354 @@
 
 namespace odk
 {
+    namespace
+    {
+        bool convert(const boost::string_view& value, std::uint32_t& target) noexcept
+        {
+            return XmlPullParser::toInteger(value, target);
+        }
+
+        bool convert(const boost::string_view& value, std::uint64_t& target) noexcept
+        {
+            return XmlPullParser::toInteger(value, target);
+        }
+
+        bool convert(const boost::string_view& value, double& target) noexcept
+        {
+            // the same conversion as the DOM path to get identical results, plain numbers are read without allocating
+            return XmlPullParser::toDouble(value, target)
+                || boost::conversion::try_lexical_convert(value.data(), value.size(), target);
+        }
+
+        /**
+         * Converts the value of the first occurrence of an attribute, later ones are ignored like in the DOM
+         */
+        template <class T>
+        bool readFirst(unsigned int& seen, unsigned int flag, const boost::string_view& value, T& target) noexcept
+        {
+            if (seen & flag)
+            {
+                return true;
+            }
+            seen |= flag;
+            return convert(value, target);
+        }
+
+        /**
+         * Reads the children of the current element, all of them have to be empty elements named child_name
+         */
+        template <std::size_t N, class ReadChild>
+        bool readChildren(XmlPullParser& parser, const char (&child_name)[N], ReadChild read_child)
+        {
+            for (;;)
+            {
+                switch (parser.next())
+                {
+                case XmlPullParser::Event::END_ELEMENT:
+                    return true;
+                case XmlPullParser::Event::START_ELEMENT:
+                    if (!parser.nameIs(child_name) || !read_child() || parser.next() != XmlPullParser::Event::END_ELEMENT)
+                    {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+                }
+            }
+        }
+
+        bool readDataRegion(XmlPullParser& parser, std::vector<DataRegion>& regions)
+        {
+            std::uint64_t channel_id = 0;
+            std::uint64_t begin = 0;
+            std::uint64_t end = 0;
+            unsigned int seen = 0;
+
+            // attributes in the order written by DataRegions::generate
+            if (parser.readIntegerAttribute("channel_id", channel_id))
+            {
+                seen |= 1u;
+                if (parser.readIntegerAttribute("begin", begin))
+                {
+                    seen |= 2u;
+                    if (parser.readIntegerAttribute("end", end))
+                    {
+                        seen |= 4u;
+                    }
+                }
+            }
+
+            boost::string_view name;
+            boost::string_view value;
+            while (parser.nextAttribute(name, value))
+            {
+                bool ok = true;
+                if (XmlPullParser::equals(name, "channel_id"))
+                {
+                    ok = readFirst(seen, 1u, value, channel_id);
+                }
+                else if (XmlPullParser::equals(name, "begin"))
+                {
+                    ok = readFirst(seen, 2u, value, begin);
+                }
+                else if (XmlPullParser::equals(name, "end"))
+                {
+                    ok = readFirst(seen, 4u, value, end);
+                }
+                if (!ok)
+                {
+                    return false;
+                }
+            }
+            // missing attributes make the DOM path fail, it reports the error
+            if (parser.failed() || seen != 7u)
+            {
+                return false;
+            }
+            regions.emplace_back(channel_id, Interval<std::uint64_t>(begin, end));
+            return true;
+        }
+
+        bool readInterval(XmlPullParser& parser, std::vector<Interval<double>>& windows)
+        {
+            double begin = 0;
+            double end = 0;
+            unsigned int seen = 0;
+            boost::string_view name;
+            boost::string_view value;
+            while (parser.nextAttribute(name, value))
+            {
+                bool ok = true;
+                if (XmlPullParser::equals(name, "begin"))
+                {
+                    ok = readFirst(seen, 1u, value, begin);
+                }
+                else if (XmlPullParser::equals(name, "end"))
+                {
+                    ok = readFirst(seen, 2u, value, end);
+                }
+                if (!ok)
+                {
+                    return false;
+                }
+            }
+            if (parser.failed() || seen != 3u)
+            {
+                return false;
+            }
+            windows.emplace_back(begin, end);
+            return true;
+        }
+
+        /**
+         * Pull parser path of BlockListDescriptor::parse, returns false for anything it does not understand
+         */
+        bool readBlockList(XmlPullParser& parser, BlockListDescriptor& block_list)
+        {
+            if (parser.next() != XmlPullParser::Event::START_ELEMENT || !parser.nameIs("BlockListDescriptor"))
+            {
+                return false;
+            }
+
+            unsigned int seen = 0;
+            boost::string_view name;
+            boost::string_view value;
+            while (parser.nextAttribute(name, value))
+            {
+                if (XmlPullParser::equals(name, "block_count") && !readFirst(seen, 1u, value, block_list.m_block_count))
+                {
+                    return false;
+                }
+            }
+            if (parser.failed() || seen == 0)
+            {
+                return false;
+            }
+
+            for (;;)
+            {
+                switch (parser.next())
+                {
+                case XmlPullParser::Event::END_ELEMENT:
+                    return parser.next() == XmlPullParser::Event::END_DOCUMENT;
+                case XmlPullParser::Event::START_ELEMENT:
+                    if (parser.nameIs("Intervals"))
+                    {
+                        if (!readChildren(parser, "Interval", [&parser, &block_list]() { return readInterval(parser, block_list.m_windows); }))
+                        {
+                            return false;
+                        }
+                    }
+                    else if (parser.nameIs("InvalidRegions"))
+                    {
+                        block_list.m_invalid_regions_included = true;
+                        if (!readChildren(parser, "DataRegion", [&parser, &block_list]() { return readDataRegion(parser, block_list.m_invalid_regions); }))
+                        {
+                            return false;
+                        }
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+                }
+            }
+        }
+
+        /**
+         * Reads the attributes in the order written by BlockDescriptor::generate without looking at their names
+         * @return flags of the attributes read, in the order of readBlockChannel
+         */
+        unsigned int readCanonicalChannel(XmlPullParser& parser, BlockChannelDescriptor& channel_desc) noexcept
+        {
+            if (!parser.readIntegerAttribute("channel_id", channel_desc.m_channel_id))
+            {
+                return 0u;
+            }
+            if (!parser.readIntegerAttribute("offset", channel_desc.m_offset))
+            {
+                return 1u;
+            }
+            if (!parser.readIntegerAttribute("count", channel_desc.m_count))
+            {
+                return 3u;
+            }
+            if (!parser.readIntegerAttribute("first_sample_index", channel_desc.m_first_sample_index))
+            {
+                return 7u;
+            }
+            if (!parser.readIntegerAttribute("timestamp", channel_desc.m_timestamp))
+            {
+                return 15u;
+            }
+            if (!parser.readIntegerAttribute("duration", channel_desc.m_duration))
+            {
+                return 31u;
+            }
+            return 63u;
+        }
+
+        bool readBlockChannel(XmlPullParser& parser, std::vector<BlockChannelDescriptor>& channels)
+        {
+            // missing attributes are 0 like in the DOM path
+            BlockChannelDescriptor channel_desc;
+            unsigned int seen = readCanonicalChannel(parser, channel_desc);
+
+            boost::string_view name;
+            boost::string_view value;
+            while (parser.nextAttribute(name, value))
+            {
+                bool ok = true;
+                if (XmlPullParser::equals(name, "channel_id"))
+                {
+                    ok = readFirst(seen, 1u, value, channel_desc.m_channel_id);
+                }
+                else if (XmlPullParser::equals(name, "offset"))
+                {
+                    ok = readFirst(seen, 2u, value, channel_desc.m_offset);
+                }
+                else if (XmlPullParser::equals(name, "count"))
+                {
+                    ok = readFirst(seen, 4u, value, channel_desc.m_count);
+                }
+                else if (XmlPullParser::equals(name, "first_sample_index"))
+                {
+                    ok = readFirst(seen, 8u, value, channel_desc.m_first_sample_index);
+                }
+                else if (XmlPullParser::equals(name, "timestamp"))
+                {
+                    ok = readFirst(seen, 16u, value, channel_desc.m_timestamp);
+                }
+                else if (XmlPullParser::equals(name, "duration"))
+                {
+                    ok = readFirst(seen, 32u, value, channel_desc.m_duration);
+                }
+                if (!ok)
+                {
+                    return false;
+                }
+            }
+            if (parser.failed())
+            {
+                return false;
+            }
+            channels.push_back(channel_desc);
+            return true;
+        }
+
+        /**
+         * Pull parser path of BlockDescriptor::parse, returns false for anything it does not understand
+         */
+        bool readBlockDescriptor(XmlPullParser& parser, BlockDescriptor& block_descriptor)
+        {
+            if (parser.next() != XmlPullParser::Event::START_ELEMENT || !parser.nameIs("BlockDescriptor"))
+            {
+                return false;
+            }
+
+            unsigned int seen = 0;
+            if (parser.readIntegerAttribute("stream_id", block_descriptor.m_stream_id))
+            {
+                seen |= 1u;
+                if (parser.readIntegerAttribute("data_size", block_descriptor.m_data_size))
+                {
+                    seen |= 2u;
+                }
+            }
+
+            boost::string_view name;
+            boost::string_view value;
+            while (parser.nextAttribute(name, value))
+            {
+                bool ok = true;
+                if (XmlPullParser::equals(name, "stream_id"))
+                {
+                    ok = readFirst(seen, 1u, value, block_descriptor.m_stream_id);
+                }
+                else if (XmlPullParser::equals(name, "data_size"))
+                {
+                    ok = readFirst(seen, 2u, value, block_descriptor.m_data_size);
+                }
+                if (!ok)
+                {
+                    return false;
+                }
+            }
+            if (parser.failed())
+            {
+                return false;
+            }
+            if ((seen & 1u) == 0)
+            {
+                block_descriptor.m_stream_id = 0;
+            }
+            if ((seen & 2u) == 0)
+            {
+                block_descriptor.m_data_size = 0;
+            }
+
+            return readChildren(parser, "Channel", [&parser, &block_descriptor]() { return readBlockChannel(parser, block_descriptor.m_block_channels); })
+                && parser.next() == XmlPullParser::Event::END_DOCUMENT;
+        }
+
+        /**
+         * Pull parser path of DataRegions::parse, returns false for anything it does not understand
+         */
+        bool readDataRegions(XmlPullParser& parser, std::vector<DataRegion>& regions)
+        {
+            if (parser.next() != XmlPullParser::Event::START_ELEMENT || !parser.nameIs("DataRegions"))
+            {
+                return false;
+            }
+            return readChildren(parser, "DataRegion", [&parser, &regions]() { return readDataRegion(parser, regions); })
+                && parser.next() == XmlPullParser::Event::END_DOCUMENT;
+        }
+    }
+
     BlockChannelDescriptor::BlockChannelDescriptor() noexcept
         : m_offset()
         , m_channel_id()
@@ -33,8 +382,16 @@ namespace odk
             return false;
         }
 
-        pugi::xml_document doc;
         m_block_channels.clear();
+        XmlPullParser parser(xml_string);
+        if (readBlockDescriptor(parser, *this))
+        {
+            return true;
+        }
+
+        // not understood by the pull parser, use the full parser
+        m_block_channels.clear();
+        pugi::xml_document doc;
         auto status = doc.load_buffer(xml_string.data(), xml_string.size(), pugi::parse_default, pugi::encoding_utf8);
         if (status.status == pugi::status_ok)
         {
@@ -89,16 +446,33 @@ namespace odk
     BlockListDescriptor::BlockListDescriptor() noexcept
         : m_block_count(0)
         , m_windows()
+        , m_invalid_regions()
+        , m_invalid_regions_included(false)
     {
     }
 
     bool BlockListDescriptor::parse(const boost::string_view& xml_string)
     {
         m_windows.clear();
+        m_invalid_regions.clear();
+        m_invalid_regions_included = false;
 
         if (xml_string.empty())
             return false;
 
+        const auto block_count = m_block_count;
+        XmlPullParser parser(xml_string);
+        if (readBlockList(parser, *this))
+        {
+            return true;
+        }
+
+        // not in the form understood by the pull parser, use the full parser
+        m_block_count = block_count;
+        m_windows.clear();
+        m_invalid_regions.clear();
+        m_invalid_regions_included = false;
+
         pugi::xml_document doc;
         auto status = doc.load_buffer(xml_string.data(), xml_string.size(), pugi::parse_default, pugi::encoding_utf8);
         if (status.status == pugi::status_ok)
@@ -119,6 +493,7 @@ namespace odk
                     m_windows.emplace_back(begin, end);
                 }
 
+                m_invalid_regions_included = !block_list_desc_node.child("InvalidRegions").empty();
                 auto channel_region_nodes = block_list_desc_node.select_nodes("InvalidRegions/DataRegion");
                 m_invalid_regions.reserve(channel_region_nodes.size());
                 for (auto a_region_node : channel_region_nodes)
@@ -155,7 +530,7 @@ namespace odk
                 interval_node.append_attribute("end").set_value(interval.m_end);
             }
         }
-        if (!m_invalid_regions.empty())
+        if (m_invalid_regions_included || !m_invalid_regions.empty())
         {
             auto regions_node = block_list_desc_node.append_child("InvalidRegions");
 
@@ -173,9 +548,19 @@ namespace odk
 
     bool DataRegions::parse(const boost::string_view& xml_string)
     {
-        pugi::xml_document doc;
         m_data_regions.clear();
 
+        XmlPullParser parser(xml_string);
+        if (readDataRegions(parser, m_data_regions))
+        {
+            return true;
+        }
+
+        // not in the form understood by the pull parser, use the full parser
+        m_data_regions.clear();
+
+        pugi::xml_document doc;
+
         auto status = doc.load_buffer(xml_string.data(), xml_string.size(), pugi::parse_default, pugi::encoding_utf8);
         if (status.status == pugi::status_ok)
         {
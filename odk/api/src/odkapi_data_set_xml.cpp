@@ -7,8 +7,130 @@
 
 #include <boost/lexical_cast.hpp>
 
+#include <cstdio>
+#include <cstring>
+
 namespace odk
 {
+    namespace
+    {
+        struct FormattedDouble
+        {
+            std::uint64_t m_bits = 0;
+            int m_length = -1;
+            char m_text[32];
+        };
+
+        /**
+         * Formats value like pugi::xml_attribute::set_value(double)
+         * Consecutive data windows share their boundaries (the end of one window is the start of the next one
+         * and regions and data are requested for the same window), so the last few results are kept per thread.
+         */
+        const FormattedDouble& formatDouble(double value)
+        {
+            static const std::size_t CACHE_SIZE = 4;
+            thread_local FormattedDouble cache[CACHE_SIZE];
+            thread_local std::size_t next_entry = 0;
+
+            std::uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (const auto& entry : cache)
+            {
+                if (entry.m_length >= 0 && entry.m_bits == bits)
+                {
+                    return entry;
+                }
+            }
+
+            auto& entry = cache[next_entry];
+            next_entry = (next_entry + 1) % CACHE_SIZE;
+            entry.m_bits = bits;
+            entry.m_length = std::snprintf(entry.m_text, sizeof(entry.m_text), "%.17g", value);
+            return entry;
+        }
+
+        /**
+         * Minimal XML writer producing the same output as pugixml with format_raw
+         * for telegrams that consist of elements with numeric attributes only
+         */
+        class TelegramWriter
+        {
+        public:
+            explicit TelegramWriter(std::string& xml)
+                : m_xml(xml)
+            {
+                m_xml.assign("<?xml version=\"1.0\"?>");
+            }
+
+            void openElement(const char* name)
+            {
+                m_xml += '<';
+                m_xml += name;
+            }
+
+            void attribute(const char* name, std::uint64_t value)
+            {
+                char buffer[32];
+                const int length = std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value));
+                appendAttribute(name, buffer, length);
+            }
+
+            void attribute(const char* name, bool value)
+            {
+                appendAttribute(name, value ? "true" : "false", value ? 4 : 5);
+            }
+
+            void attribute(const char* name, double value)
+            {
+                const auto& formatted = formatDouble(value);
+                appendAttribute(name, formatted.m_text, formatted.m_length);
+            }
+
+            /// ends the start tag of an element that has children
+            void beginChildren()
+            {
+                m_xml += '>';
+            }
+
+            /// ends an element without children
+            void closeEmptyElement()
+            {
+                m_xml += "/>";
+            }
+
+            void closeElement(const char* name)
+            {
+                m_xml += "</";
+                m_xml += name;
+                m_xml += '>';
+            }
+
+        private:
+            void appendAttribute(const char* name, const char* value, int length)
+            {
+                m_xml += ' ';
+                m_xml += name;
+                m_xml += "=\"";
+                m_xml.append(value, static_cast<std::size_t>(length));
+                m_xml += '"';
+            }
+
+            std::string& m_xml;
+        };
+
+        void writeWindow(TelegramWriter& writer, double start, double end, const boost::optional<bool>& include_regions = boost::none)
+        {
+            writer.openElement("Window");
+            writer.attribute("start", start);
+            writer.attribute("end", end);
+            if (include_regions)
+            {
+                writer.attribute("include_regions", *include_regions);
+            }
+            writer.closeEmptyElement();
+        }
+    }
+
     PluginDataSet::PluginDataSet()
         : m_id()
         , m_channels()
@@ -122,11 +244,16 @@ namespace odk
                 auto data_request_node = doc.document_element();
                 m_id = boost::lexical_cast<std::uint64_t>(data_request_node.attribute("data_set_key").value());
 
+                m_include_regions = boost::none;
                 if(auto window_node = data_request_node.child("Window"))
                 {
                     m_data_window = DataWindow(
                                 boost::lexical_cast<double>(window_node.attribute("start").value()),
                                 boost::lexical_cast<double>(window_node.attribute("end").value()));
+                    if (auto include_regions_attr = window_node.attribute("include_regions"))
+                    {
+                        m_include_regions = include_regions_attr.as_bool();
+                    }
                 }
 
                 if(auto single_value_node = data_request_node.child("SingleValue"))
@@ -160,6 +287,10 @@ namespace odk
             auto window_node = data_request_node.append_child("Window");
             window_node.append_attribute("start").set_value(m_data_window->m_start);
             window_node.append_attribute("end").set_value(m_data_window->m_stop);
+            if (m_include_regions)
+            {
+                window_node.append_attribute("include_regions").set_value(*m_include_regions);
+            }
         }
 
         if(m_single_value)
@@ -176,6 +307,39 @@ namespace odk
         return xpugi::toXML(doc);
     }
 
+    void PluginDataRequest::generate(std::string& xml) const
+    {
+        TelegramWriter writer(xml);
+        writer.openElement("DataTransferRequest");
+        writer.attribute("data_set_key", m_id);
+        if (!m_data_window && !m_single_value && !m_data_stream)
+        {
+            writer.closeEmptyElement();
+            return;
+        }
+        writer.beginChildren();
+
+        if (m_data_window)
+        {
+            writeWindow(writer, m_data_window->m_start, m_data_window->m_stop, m_include_regions);
+        }
+
+        if (m_single_value)
+        {
+            writer.openElement("SingleValue");
+            writer.attribute("timestamp", m_single_value->m_timestamp);
+            writer.closeEmptyElement();
+        }
+
+        if (m_data_stream)
+        {
+            writer.openElement("DataStream");
+            writer.closeEmptyElement();
+        }
+
+        writer.closeElement("DataTransferRequest");
+    }
+
 
     PluginDataStartRequest::PluginDataStartRequest()
         : m_id(std::numeric_limits<std::uint64_t>::max())
@@ -347,5 +511,20 @@ namespace odk
         return xpugi::toXML(doc);
     }
 
+    void PluginDataRegionsRequest::generate(std::string& xml) const
+    {
+        TelegramWriter writer(xml);
+        writer.openElement("DataRegionsRequest");
+        writer.attribute("data_set_key", m_id);
+        if (!m_data_window)
+        {
+            writer.closeEmptyElement();
+            return;
+        }
+        writer.beginChildren();
+        writeWindow(writer, m_data_window->m_start, m_data_window->m_stop);
+        writer.closeElement("DataRegionsRequest");
+    }
+
 }
 
@@ -2,6 +2,7 @@
 
 #include "odkapi_timestamp_xml.h"
 
+#include "odkuni_xml_pull_parser.h"
 #include "odkuni_xpugixml.h"
 
 #include <boost/lexical_cast.hpp>
@@ -29,6 +30,18 @@ namespace odk
         if (xml_string.empty())
             return false;
 
+        // the master timestamp is queried every processing cycle, read it without a DOM if possible
+        const Timestamp previous = *this;
+        XmlPullParser parser(xml_string);
+        if (parser.next() == XmlPullParser::Event::START_ELEMENT && parseTickFrequencyAttributes(parser)
+            && parser.next() == XmlPullParser::Event::END_ELEMENT && parser.next() == XmlPullParser::Event::END_DOCUMENT)
+        {
+            return true;
+        }
+
+        // not in the form understood by the pull parser, use the full parser
+        *this = previous;
+
         pugi::xml_document doc;
         auto status = doc.load_buffer(xml_string.data(), xml_string.size(), pugi::parse_default, pugi::encoding_utf8);
         if (status.status == pugi::status_ok)
@@ -84,6 +97,45 @@ namespace odk
         }
     }
 
+    bool Timestamp::parseTickFrequencyAttributes(XmlPullParser& parser) noexcept
+    {
+        m_ticks = 0;
+        m_frequency = -1;
+
+        // the first occurrence of an attribute is used like in the DOM
+        unsigned int seen = 0;
+        if (parser.readIntegerAttribute("ticks", m_ticks))
+        {
+            seen |= 1u;
+        }
+
+        boost::string_view name;
+        boost::string_view value;
+        while (parser.nextAttribute(name, value))
+        {
+            if (XmlPullParser::equals(name, "ticks") && !(seen & 1u))
+            {
+                seen |= 1u;
+                if (!XmlPullParser::toInteger(value, m_ticks))
+                {
+                    return false;
+                }
+            }
+            else if (XmlPullParser::equals(name, "frequency") && !(seen & 2u))
+            {
+                seen |= 2u;
+                // the same conversion as the DOM path to get identical results, plain numbers are read without allocating
+                if (!XmlPullParser::toDouble(value, m_frequency)
+                    && !boost::conversion::try_lexical_convert(value.data(), value.size(), m_frequency))
+                {
+                    return false;
+                }
+            }
+        }
+        // missing attributes are left to the DOM path, it reports the error
+        return !parser.failed() && seen == 3u;
+    }
+
     AbsoluteTime::AbsoluteTime()
         : m_year(0)
         , m_month(0)
@@ -68,29 +68,33 @@ namespace odk
         return time;
     }
 
-    void addSamples(odk::IfHost* host, std::uint32_t local_channel_id, std::uint64_t timestamp, const void* data, size_t data_size)
+    namespace
     {
-        const std::uint8_t* timestamp_bytes = reinterpret_cast<const std::uint8_t*>(&timestamp);
-        const std::uint8_t* data_bytes = reinterpret_cast<const std::uint8_t*>(data);
-
-        std::vector<std::uint8_t> sample;
-        sample.reserve(sizeof(std::uint64_t) + data_size); // reserve but do not fill with 0
-        sample.insert(sample.end(), timestamp_bytes, timestamp_bytes + sizeof(std::uint64_t));
-        sample.insert(sample.end(), data_bytes, data_bytes + data_size);
+        /**
+         * Prepends the timestamp to the sample data in a buffer that is reused by all calls of the thread
+         */
+        const std::vector<std::uint8_t>& prepareSampleMessage(std::uint64_t timestamp, const void* data, size_t data_size)
+        {
+            thread_local std::vector<std::uint8_t> sample;
+            sample.resize(sizeof(std::uint64_t) + data_size); // does not shrink the capacity
+            std::memcpy(sample.data(), &timestamp, sizeof(std::uint64_t));
+            if (data_size > 0)
+            {
+                std::memcpy(sample.data() + sizeof(std::uint64_t), data, data_size);
+            }
+            return sample;
+        }
+    }
 
+    void addSamples(odk::IfHost* host, std::uint32_t local_channel_id, std::uint64_t timestamp, const void* data, size_t data_size)
+    {
+        const auto& sample = prepareSampleMessage(timestamp, data, data_size);
         host->messageSyncData(odk::host_msg::ADD_CONTIGUOUS_SAMPLES, local_channel_id, sample.data(), sample.size(), nullptr);
     }
 
     void addSample(odk::IfHost* host, std::uint32_t local_channel_id, std::uint64_t timestamp, const void* data, size_t data_size)
     {
-        const std::uint8_t* timestamp_bytes = reinterpret_cast<const std::uint8_t*>(&timestamp);
-        const std::uint8_t* data_bytes = reinterpret_cast<const std::uint8_t*>(data);
-
-        std::vector<std::uint8_t> sample;
-        sample.reserve(sizeof(std::uint64_t) + data_size); // reserve but do not fill with 0
-        sample.insert(sample.end(), timestamp_bytes, timestamp_bytes + sizeof(std::uint64_t));
-        sample.insert(sample.end(), data_bytes, data_bytes + data_size);
-
+        const auto& sample = prepareSampleMessage(timestamp, data, data_size);
         host->messageSyncData(odk::host_msg::ADD_SAMPLE, local_channel_id, sample.data(), sample.size(), nullptr);
     }
 
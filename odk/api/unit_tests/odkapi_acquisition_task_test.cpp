@@ -67,4 +67,40 @@ BOOST_AUTO_TEST_CASE(AcquisitionTaskProcessTelegramSerialization)
     BOOST_CHECK_EQUAL(deserialized.m_end.m_frequency, orig.m_end.m_frequency);
 }
 
+BOOST_AUTO_TEST_CASE(AcquisitionTaskProcessTelegramSpellings)
+{
+    // the first ones are read by the pull parser, the others by the DOM
+    const char* const telegrams[] = {
+        R"(<AcquisitionTaskProcess protocol_version="1.0"><Start ticks="100" frequency="10000"/><End ticks="20300" frequency="1e4"/></AcquisitionTaskProcess>)",
+        R"(<?xml version="1.0"?><AcquisitionTaskProcess><End frequency="10000" ticks="20300"/><Start ticks="100" frequency="10000.0"/></AcquisitionTaskProcess>)",
+        R"(<AcquisitionTaskProcess protocol_version="1"><Start ticks="100" frequency="10000"/><End ticks="20300" frequency="10000"/></AcquisitionTaskProcess>)",
+        R"(<AcquisitionTaskProcess><!-- comment --><Start ticks="100" frequency="10000"/><End ticks="20300" frequency="10000"/></AcquisitionTaskProcess>)",
+        R"(<AcquisitionTaskProcess><Start ticks="100" frequency="10000"/><End ticks="20300" frequency="10000"/><Other/></AcquisitionTaskProcess>)",
+    };
+    for (const auto telegram : telegrams)
+    {
+        BOOST_TEST_CONTEXT(telegram)
+        {
+            odk::AcquisitionTaskProcessTelegram deserialized;
+            BOOST_CHECK(deserialized.parse(telegram));
+            BOOST_CHECK_EQUAL(deserialized.m_start.m_ticks, 100);
+            BOOST_CHECK_EQUAL(deserialized.m_start.m_frequency, 10000);
+            BOOST_CHECK_EQUAL(deserialized.m_end.m_ticks, 20300);
+            BOOST_CHECK_EQUAL(deserialized.m_end.m_frequency, 10000);
+        }
+    }
+
+    odk::AcquisitionTaskProcessTelegram unsupported_version;
+    BOOST_CHECK(!unsupported_version.parse(R"(<AcquisitionTaskProcess protocol_version="2.0"><Start ticks="1" frequency="1"/></AcquisitionTaskProcess>)"));
+    BOOST_CHECK(!unsupported_version.m_start.timestampValid());
+
+    // a telegram without timestamps does not keep the ones of the previous telegram
+    odk::AcquisitionTaskProcessTelegram reused;
+    BOOST_CHECK(reused.parse(telegrams[0]));
+    reused = {};
+    BOOST_CHECK(reused.parse(R"(<AcquisitionTaskProcess protocol_version="1.0"/>)"));
+    BOOST_CHECK(!reused.m_start.timestampValid());
+    BOOST_CHECK(!reused.m_end.timestampValid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,8 +2,15 @@
 
 #include "odkapi_block_descriptor_xml.h"
 
+#include <boost/lexical_cast.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/version.hpp>
+#include <pugixml.hpp>
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
 
 // MSVC warning https://lists.boost.org/boost-users/2014/11/83281.php
 #if defined(_MSC_VER) && BOOST_VERSION == 105700
@@ -12,6 +19,127 @@
 
 using namespace odk;
 
+namespace
+{
+    /**
+     * DOM based BlockListDescriptor::parse as it was before the pull parser was added
+     */
+    bool parseBlockListWithDom(const std::string& xml_string, BlockListDescriptor& block_list)
+    {
+        block_list.m_windows.clear();
+        block_list.m_invalid_regions.clear();
+        block_list.m_invalid_regions_included = false;
+
+        if (xml_string.empty())
+            return false;
+
+        pugi::xml_document doc;
+        auto status = doc.load_buffer(xml_string.data(), xml_string.size(), pugi::parse_default, pugi::encoding_utf8);
+        if (status.status == pugi::status_ok)
+        {
+            try
+            {
+                auto block_list_desc_node = doc.document_element();
+                block_list.m_block_count = boost::lexical_cast<std::uint32_t>(block_list_desc_node.attribute("block_count").value());
+
+                for (auto interval_node : block_list_desc_node.select_nodes("Intervals/Interval"))
+                {
+                    auto begin = boost::lexical_cast<double>(interval_node.node().attribute("begin").value());
+                    auto end = boost::lexical_cast<double>(interval_node.node().attribute("end").value());
+                    block_list.m_windows.emplace_back(begin, end);
+                }
+
+                block_list.m_invalid_regions_included = !block_list_desc_node.child("InvalidRegions").empty();
+                for (auto region_node : block_list_desc_node.select_nodes("InvalidRegions/DataRegion"))
+                {
+                    auto channel_id = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("channel_id").value());
+                    auto begin = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("begin").value());
+                    auto end = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("end").value());
+                    block_list.m_invalid_regions.emplace_back(channel_id, Interval<std::uint64_t>(begin, end));
+                }
+            }
+            catch (const boost::bad_lexical_cast&)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * DOM based DataRegions::parse as it was before the pull parser was added
+     */
+    bool parseDataRegionsWithDom(const std::string& xml_string, DataRegions& data_regions)
+    {
+        data_regions.m_data_regions.clear();
+
+        pugi::xml_document doc;
+        auto status = doc.load_buffer(xml_string.data(), xml_string.size(), pugi::parse_default, pugi::encoding_utf8);
+        if (status.status == pugi::status_ok)
+        {
+            try
+            {
+                for (auto region_node : doc.document_element().select_nodes("DataRegion"))
+                {
+                    auto channel_id = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("channel_id").value());
+                    auto begin = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("begin").value());
+                    auto end = boost::lexical_cast<std::uint64_t>(region_node.node().attribute("end").value());
+                    data_regions.m_data_regions.emplace_back(channel_id, Interval<std::uint64_t>(begin, end));
+                }
+            }
+            catch (const boost::bad_lexical_cast&)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool sameRegions(const std::vector<DataRegion>& lhs, const std::vector<DataRegion>& rhs)
+    {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+            [](const DataRegion& a, const DataRegion& b)
+            {
+                return a.m_channel_id == b.m_channel_id && a.m_region == b.m_region;
+            });
+    }
+
+    bool sameWindows(const std::vector<Interval<double>>& lhs, const std::vector<Interval<double>>& rhs)
+    {
+        // compare the bits to treat NaN values as equal
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+            [](const Interval<double>& a, const Interval<double>& b)
+            {
+                return std::memcmp(&a.m_begin, &b.m_begin, sizeof(double)) == 0 && std::memcmp(&a.m_end, &b.m_end, sizeof(double)) == 0;
+            });
+    }
+
+    void checkSameResult(const std::string& xml)
+    {
+        BlockListDescriptor expected_block_list;
+        expected_block_list.m_block_count = 17;
+        const bool expected_block_list_result = parseBlockListWithDom(xml, expected_block_list);
+        BlockListDescriptor block_list;
+        block_list.m_block_count = 17;
+        const bool block_list_result = block_list.parse(xml);
+
+        BOOST_CHECK_MESSAGE(block_list_result == expected_block_list_result
+            && block_list.m_block_count == expected_block_list.m_block_count
+            && block_list.m_invalid_regions_included == expected_block_list.m_invalid_regions_included
+            && sameWindows(block_list.m_windows, expected_block_list.m_windows)
+            && sameRegions(block_list.m_invalid_regions, expected_block_list.m_invalid_regions),
+            "BlockListDescriptor results differ for: " << xml);
+
+        DataRegions expected_regions;
+        const bool expected_regions_result = parseDataRegionsWithDom(xml, expected_regions);
+        DataRegions regions;
+        const bool regions_result = regions.parse(xml);
+        BOOST_CHECK_MESSAGE(regions_result == expected_regions_result
+            && sameRegions(regions.m_data_regions, expected_regions.m_data_regions),
+            "DataRegions results differ for: " << xml);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE(block_descriptor)
 
 BOOST_AUTO_TEST_CASE(parse_generate)
@@ -65,4 +193,198 @@ BOOST_AUTO_TEST_CASE(parse_generate)
     BOOST_CHECK_EQUAL(block_descriptor.m_block_channels.at(1).m_duration, 300);
 }
 
+namespace
+{
+    void checkEqual(const BlockDescriptor& a, const BlockDescriptor& b)
+    {
+        BOOST_CHECK_EQUAL(a.m_stream_id, b.m_stream_id);
+        BOOST_CHECK_EQUAL(a.m_data_size, b.m_data_size);
+        BOOST_REQUIRE_EQUAL(a.m_block_channels.size(), b.m_block_channels.size());
+        for (std::size_t i = 0; i < a.m_block_channels.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL(a.m_block_channels[i].m_channel_id, b.m_block_channels[i].m_channel_id);
+            BOOST_CHECK_EQUAL(a.m_block_channels[i].m_offset, b.m_block_channels[i].m_offset);
+            BOOST_CHECK_EQUAL(a.m_block_channels[i].m_first_sample_index, b.m_block_channels[i].m_first_sample_index);
+            BOOST_CHECK_EQUAL(a.m_block_channels[i].m_count, b.m_block_channels[i].m_count);
+            BOOST_CHECK_EQUAL(a.m_block_channels[i].m_timestamp, b.m_block_channels[i].m_timestamp);
+            BOOST_CHECK_EQUAL(a.m_block_channels[i].m_duration, b.m_block_channels[i].m_duration);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parse_variants)
+{
+    BlockDescriptor expected;
+    expected.m_stream_id = 7;
+    expected.m_data_size = 4096;
+    {
+        BlockChannelDescriptor bcd;
+        bcd.m_channel_id = 18446744073709551615ull;
+        bcd.m_offset = 4294967295u;
+        bcd.m_first_sample_index = 12;
+        bcd.m_count = 34;
+        bcd.m_timestamp = 56;
+        bcd.m_duration = 78;
+        expected.m_block_channels.push_back(bcd);
+    }
+    {
+        BlockChannelDescriptor bcd;
+        bcd.m_channel_id = 3;
+        expected.m_block_channels.push_back(bcd);
+    }
+
+    const char* const variants[] = {
+        // canonical form handled without DOM
+        R"xxx(<?xml version="1.0"?>
+<BlockDescriptor stream_id="7" data_size="4096"><Channel channel_id="18446744073709551615" offset="4294967295" count="34" first_sample_index="12" timestamp="56" duration="78"/><Channel channel_id="3"/></BlockDescriptor>)xxx",
+        // single quotes, explicit end tags, unknown attributes
+        "<BlockDescriptor data_size='4096' foo='bar' stream_id='7'>\n"
+            "  <Channel duration='78' timestamp='56' first_sample_index='12' count='34' offset='4294967295' channel_id='18446744073709551615'></Channel>\n"
+            "  <Channel channel_id='3' />\n"
+            "</BlockDescriptor>\n",
+        // forms that are delegated to the DOM parser
+        R"xxx(<BlockDescriptor stream_id="7" data_size="4096"><!-- comment --><Channel channel_id="18446744073709551615" offset="4294967295" count="34" first_sample_index="12" timestamp="56" duration="78"/><Channel channel_id="3"/></BlockDescriptor>)xxx",
+        R"xxx(<BlockDescriptor stream_id="0x7" data_size="4096"><Channel channel_id="18446744073709551615" offset="4294967295" count="34" first_sample_index="12" timestamp="56" duration="78"/><Channel channel_id="3"/></BlockDescriptor>)xxx",
+        R"xxx(<BlockDescriptor stream_id="7" data_size="4096" name="a&amp;b"><Channel channel_id="18446744073709551615" offset="4294967295" count="34" first_sample_index="12" timestamp="56" duration="78"/><Other/><Channel channel_id="3"/></BlockDescriptor>)xxx",
+    };
+
+    for (const auto& xml : variants)
+    {
+        BlockDescriptor block_descriptor;
+        BOOST_CHECK(block_descriptor.parse(xml));
+        checkEqual(block_descriptor, expected);
+    }
+
+    BlockDescriptor block_descriptor;
+    BOOST_CHECK(block_descriptor.parse(expected.generate()));
+    checkEqual(block_descriptor, expected);
+
+    // reparsing replaces previous content
+    BOOST_CHECK(block_descriptor.parse("<BlockDescriptor stream_id='1'/>"));
+    BOOST_CHECK_EQUAL(block_descriptor.m_stream_id, 1);
+    BOOST_CHECK_EQUAL(block_descriptor.m_data_size, 0);
+    BOOST_CHECK(block_descriptor.m_block_channels.empty());
+
+    BOOST_CHECK(!block_descriptor.parse(""));
+}
+
+BOOST_AUTO_TEST_CASE(block_list_invalid_regions)
+{
+    BlockListDescriptor block_list;
+    BOOST_CHECK(block_list.parse(R"xxx(<BlockListDescriptor block_count="2"><Intervals><Interval begin="0.5" end="1.5"/></Intervals>)xxx"
+        R"xxx(<InvalidRegions><DataRegion channel_id="3" begin="10" end="20"/><DataRegion channel_id="1" begin="0" end="5"/></InvalidRegions></BlockListDescriptor>)xxx"));
+    BOOST_CHECK_EQUAL(block_list.m_block_count, 2);
+    BOOST_REQUIRE_EQUAL(block_list.m_windows.size(), 1);
+    BOOST_CHECK(block_list.m_invalid_regions_included);
+    BOOST_REQUIRE_EQUAL(block_list.m_invalid_regions.size(), 2);
+    BOOST_CHECK_EQUAL(block_list.m_invalid_regions[0].m_channel_id, 3);
+    BOOST_CHECK_EQUAL(block_list.m_invalid_regions[0].m_region.m_begin, 10);
+    BOOST_CHECK_EQUAL(block_list.m_invalid_regions[0].m_region.m_end, 20);
+    BOOST_CHECK_EQUAL(block_list.m_invalid_regions[1].m_channel_id, 1);
+
+    // reparsing replaces the regions, an empty element reports that all samples are valid
+    BOOST_CHECK(block_list.parse(R"xxx(<BlockListDescriptor block_count="1"><InvalidRegions/></BlockListDescriptor>)xxx"));
+    BOOST_CHECK(block_list.m_invalid_regions_included);
+    BOOST_CHECK(block_list.m_invalid_regions.empty());
+
+    BlockListDescriptor reparsed;
+    BOOST_CHECK(reparsed.parse(block_list.generate()));
+    BOOST_CHECK(reparsed.m_invalid_regions_included);
+    BOOST_CHECK(reparsed.m_invalid_regions.empty());
+
+    // hosts without region support omit the element
+    BOOST_CHECK(block_list.parse(R"xxx(<BlockListDescriptor block_count="1"/>)xxx"));
+    BOOST_CHECK(!block_list.m_invalid_regions_included);
+    BOOST_CHECK(reparsed.parse(block_list.generate()));
+    BOOST_CHECK(!reparsed.m_invalid_regions_included);
+}
+
+BOOST_AUTO_TEST_CASE(block_list_and_regions_match_dom)
+{
+    const char* const documents[] = {
+        "",
+        "<BlockListDescriptor/>",
+        "<BlockListDescriptor block_count='3'/>",
+        "<BlockListDescriptor block_count=\"3\" block_count=\"4\"><Intervals></Intervals></BlockListDescriptor>",
+        "<?xml version='1.0' encoding='UTF-8'?>\n<BlockListDescriptor block_count = '1' >\n  <Intervals>\n    <Interval end='2.5' begin='-1e3'/>\n  </Intervals>\n</BlockListDescriptor>\n",
+        "<BlockListDescriptor block_count='1'><Intervals><Interval begin='nan' end='inf'/><Interval begin=' 1' end='2'/></Intervals></BlockListDescriptor>",
+        "<BlockListDescriptor block_count='1'><Intervals><Interval begin='1' end='2'/><Interval begin='x' end='2'/></Intervals></BlockListDescriptor>",
+        "<BlockListDescriptor block_count='4294967296'/>",
+        "<BlockListDescriptor block_count='+1'/>",
+        "<BlockListDescriptor block_count='-1'/>",
+        "<BlockListDescriptor block_count='1'><InvalidRegions><DataRegion channel_id='1' begin='2'/></InvalidRegions></BlockListDescriptor>",
+        "<BlockListDescriptor block_count='1'><InvalidRegions/><InvalidRegions><DataRegion channel_id='1' begin='2' end='3'/></InvalidRegions></BlockListDescriptor>",
+        "<BlockListDescriptor block_count='1'><Other><Interval begin='1' end='2'/></Other></BlockListDescriptor>",
+        "<BlockListDescriptor block_count='1'><!-- comment --></BlockListDescriptor>",
+        "<BlockListDescriptor block_count='1'>text</BlockListDescriptor>",
+        "<BlockListDescriptor block_count='1'></Other>",
+        "<DataRegions><DataRegion channel_id='18446744073709551615' begin='0' end='18446744073709551616'/></DataRegions>",
+        "<DataRegions><DataRegion channel_id='1' begin='0' end='5'><Child/></DataRegion></DataRegions>",
+        "<Other><DataRegion channel_id='1' begin='0' end='5'/></Other>",
+        "<DataRegions><DataRegion channel_id='&#49;' begin='0' end='5'/></DataRegions>",
+        "<DataRegions/><DataRegions/>",
+        "<DataRegions><DataRegion channel_id=\"1\" begin=\"2\" end=\"3\" end=\"4\" channel_id=\"5\"/></DataRegions>",
+        "<DataRegions><DataRegion channel_id=\"1\" begin=\"99999999999999999999\" end=\"3\"/></DataRegions>",
+        "<DataRegions><DataRegion channel_id=\"1\"  begin=\"2\" end='3'/><DataRegion begin=\"2\" channel_id=\"1\" end=\"3\"/></DataRegions>",
+        "<?xml?><DataRegions/>",
+        "<?xml version='1.0' ?> <DataRegions/>",
+        "<?xml-stylesheet href='a'?><DataRegions/>",
+    };
+    for (const auto& xml : documents)
+    {
+        checkSameResult(xml);
+    }
+
+    // random documents in canonical form, mutated with fragments that are likely to change the result
+    const char* const fragments[] = {
+        " ", "\t", "\n", "'", "\"", "<", ">", "/", "=", "-", "+", ".", "e", "x", "0", "9", "&amp;", "&#49;",
+        "<!-- c -->", "<Other/>", "</Intervals>", "<InvalidRegions/>", "<DataRegion channel_id='1' begin='2' end='3'/>",
+        "<?xml version=\"1.0\"?>", "begin=\"1\" ", std::string(1, '\0').c_str(),
+    };
+    std::mt19937 random(4711);
+    std::uniform_int_distribution<std::uint64_t> tick(0, 100000);
+    for (int document = 0; document < 2000; ++document)
+    {
+        BlockListDescriptor block_list;
+        block_list.m_block_count = static_cast<std::uint32_t>(tick(random));
+        for (std::uint64_t window = tick(random) % 3; window > 0; --window)
+        {
+            block_list.m_windows.emplace_back(static_cast<double>(tick(random)) / 7, static_cast<double>(tick(random)) * 1e-3);
+        }
+        block_list.m_invalid_regions_included = tick(random) % 2 == 0;
+        DataRegions data_regions;
+        for (std::uint64_t region = tick(random) % 6; region > 0; --region)
+        {
+            const DataRegion data_region(tick(random) % 4, Interval<std::uint64_t>(tick(random), tick(random)));
+            block_list.m_invalid_regions.push_back(data_region);
+            data_regions.m_data_regions.push_back(data_region);
+        }
+
+        std::string xml = document % 2 ? block_list.generate() : data_regions.generate();
+        checkSameResult(xml);
+
+        const int mutations = static_cast<int>(tick(random) % 3) + 1;
+        for (int mutation = 0; mutation < mutations; ++mutation)
+        {
+            const auto pos = static_cast<std::size_t>(tick(random) % (xml.size() + 1));
+            switch (tick(random) % 4)
+            {
+            case 0:
+                xml.erase(pos, static_cast<std::size_t>(tick(random) % 4) + 1);
+                break;
+            case 1:
+                xml.resize(pos);
+                break;
+            default:
+            {
+                const auto& fragment = fragments[tick(random) % (sizeof(fragments) / sizeof(fragments[0]))];
+                xml.insert(pos, fragment, std::max<std::size_t>(std::strlen(fragment), 1));
+                break;
+            }
+            }
+            checkSameResult(xml);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
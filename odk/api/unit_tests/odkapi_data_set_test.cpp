@@ -5,6 +5,9 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/version.hpp>
 
+#include <limits>
+#include <string>
+
 // MSVC warning https://lists.boost.org/boost-users/2014/11/83281.php
 #if defined(_MSC_VER) && BOOST_VERSION == 105700
 #pragma warning(disable:4003)
@@ -152,6 +155,33 @@ BOOST_AUTO_TEST_CASE(parse_generate_parse_data_request)
     BOOST_CHECK_EQUAL(data_request.m_data_window->m_stop, 12.34);
 }
 
+BOOST_AUTO_TEST_CASE(parse_generate_parse_data_request_include_regions)
+{
+    const char* const xml_content =
+        R"xxx(<?xml version='1.0' encoding='UTF-8'?>
+            <DataTransferRequest data_set_key="418">
+                <Window start="0.0" end="12.34" include_regions="true"/>
+            </DataTransferRequest>
+            )xxx"
+    ;
+
+    PluginDataRequest data_request;
+    BOOST_CHECK(data_request.parse(xml_content));
+    BOOST_REQUIRE(data_request.m_include_regions);
+    BOOST_CHECK(*data_request.m_include_regions);
+
+    BOOST_CHECK(data_request.parse(data_request.generate()));
+    BOOST_REQUIRE(data_request.m_data_window);
+    BOOST_CHECK_EQUAL(data_request.m_data_window->m_stop, 12.34);
+    BOOST_REQUIRE(data_request.m_include_regions);
+    BOOST_CHECK(*data_request.m_include_regions);
+
+    // requests of older plugins do not ask for regions
+    BOOST_CHECK(data_request.parse(R"xxx(<DataTransferRequest data_set_key="418"><Window start="0.0" end="12.34"/></DataTransferRequest>)xxx"));
+    BOOST_CHECK(!data_request.m_include_regions);
+    BOOST_CHECK(data_request.generate().find("include_regions") == std::string::npos);
+}
+
 BOOST_AUTO_TEST_CASE(parse_generate_parse_data_request_single_value)
 {
     const char* const xml_content =
@@ -242,4 +272,45 @@ BOOST_AUTO_TEST_CASE(parse_generate_parse_data_stop_request)
     BOOST_CHECK_EQUAL(data_stop_request.m_id, 418);
 }
 
+BOOST_AUTO_TEST_CASE(generate_into_buffer_matches_generate)
+{
+    const double values[] = { 0.0, 12.34, 2.0 / 3.0, 1e300, -5.5, 123456789.125 };
+
+    std::string xml;
+    for (const double start : values)
+    {
+        for (const double end : values)
+        {
+            PluginDataRequest window_request(418, PluginDataRequest::DataWindow(start, end));
+            window_request.generate(xml);
+            BOOST_CHECK_EQUAL(xml, window_request.generate());
+
+            window_request.m_include_regions = end > start;
+            window_request.generate(xml);
+            BOOST_CHECK_EQUAL(xml, window_request.generate());
+
+            PluginDataRegionsRequest regions_request(std::numeric_limits<std::uint64_t>::max());
+            regions_request.m_data_window = PluginDataRegionsRequest::DataWindow(start, end);
+            regions_request.generate(xml);
+            BOOST_CHECK_EQUAL(xml, regions_request.generate());
+        }
+    }
+
+    PluginDataRequest single_value_request(1, PluginDataRequest::SingleValue(0.123));
+    single_value_request.generate(xml);
+    BOOST_CHECK_EQUAL(xml, single_value_request.generate());
+
+    PluginDataRequest stream_request(2, PluginDataRequest::DataStream());
+    stream_request.generate(xml);
+    BOOST_CHECK_EQUAL(xml, stream_request.generate());
+
+    PluginDataRequest empty_request;
+    empty_request.generate(xml);
+    BOOST_CHECK_EQUAL(xml, empty_request.generate());
+
+    PluginDataRegionsRequest empty_regions_request(3);
+    empty_regions_request.generate(xml);
+    BOOST_CHECK_EQUAL(xml, empty_regions_request.generate());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
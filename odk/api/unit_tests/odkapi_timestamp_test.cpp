@@ -5,6 +5,9 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/version.hpp>
 
+#include <string>
+#include <utility>
+
 using namespace odk;
 
 BOOST_AUTO_TEST_SUITE(timestamp_parse)
@@ -39,4 +42,32 @@ BOOST_AUTO_TEST_CASE(generate_parse)
     BOOST_CHECK_EQUAL(event2.m_frequency, 1e6);
 }
 
+BOOST_AUTO_TEST_CASE(parse_frequency_spellings)
+{
+    // the plain numbers are read by the pull parser, the others by the DOM
+    const std::pair<const char*, double> frequencies[] = {
+        { "1000", 1000.0 },
+        { "-0.5", -0.5 },
+        { "1.25e-3", 1.25e-3 },
+        { "1E+20", 1e20 },
+        { "+1000", 1000.0 },
+        { ".5", 0.5 },
+    };
+    for (const auto& frequency : frequencies)
+    {
+        BOOST_TEST_CONTEXT(frequency.first)
+        {
+            Timestamp event;
+            BOOST_CHECK(event.parse(std::string(R"(<Timestamp ticks="123" frequency=")") + frequency.first + R"("/>)"));
+            BOOST_CHECK_EQUAL(event.m_ticks, 123);
+            BOOST_CHECK_EQUAL(event.m_frequency, frequency.second);
+        }
+    }
+
+    Timestamp event;
+    BOOST_CHECK(!event.parse(R"(<Timestamp ticks="123" frequency="1e999"/>)"));
+    BOOST_CHECK(!event.parse(R"(<Timestamp ticks="123"/>)"));
+    BOOST_CHECK(!event.timestampValid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,96 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkapi_block_descriptor_xml.h"
+#include "odkapi_update_config_xml.h"
+#include "odkuni_xpugixml.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+using namespace odk;
+
+namespace
+{
+    const char* const UPDATE_CONFIG_XML =
+        R"xxx(<?xml version='1.0' encoding='UTF-8'?>
+<UpdateConfig protocol_version="1.0">
+    <Channel local_id="2">
+        <Property name = "Frequency">
+            <ScalarValue>
+                <Value>10000</Value>
+                <Unit>Hz</Unit>
+            </ScalarValue>
+            <Constraints>
+                <DoubleRangeConstraint min = "1" max = "50000"/>
+            </Constraints>
+        </Property>
+        <Property name = "Waveform">
+            <StringValue>Square</StringValue>
+        </Property>
+    </Channel>
+</UpdateConfig>
+)xxx";
+
+    /// not in the form understood by the pull parser, uses the DOM and XPath
+    const char* const BLOCK_LIST_XML =
+        R"xxx(<BlockListDescriptor block_count="2"><!-- comment --><Intervals><Interval begin="0.5" end="1.5"/></Intervals></BlockListDescriptor>)xxx";
+}
+
+BOOST_AUTO_TEST_SUITE(xml_memory_test_suite)
+
+BOOST_AUTO_TEST_CASE(ToXMLIntoString)
+{
+    pugi::xml_document doc;
+    auto root = doc.append_child("Root");
+    root.append_attribute("a").set_value(1);
+    root.append_child("Child").append_attribute("x").set_value("y");
+
+    std::string xml = "previous content";
+    xpugi::toXML(doc, xml);
+    BOOST_CHECK_EQUAL(xml, R"xxx(<?xml version="1.0"?><Root a="1"><Child x="y"/></Root>)xxx");
+    BOOST_CHECK_EQUAL(xml, xpugi::toXML(doc));
+
+    const auto capacity = xml.capacity();
+    const auto data = xml.data();
+    xpugi::toXML(doc, xml);
+    BOOST_CHECK_EQUAL(xml.capacity(), capacity);
+    BOOST_CHECK_EQUAL(static_cast<const void*>(xml.data()), static_cast<const void*>(data));
+
+    xpugi::toXML(doc, xml, true);
+    BOOST_CHECK_EQUAL(xml, xpugi::toXML(doc, true));
+    BOOST_CHECK_EQUAL(xpugi::toXML(root), R"xxx(<Root a="1"><Child x="y"/></Root>)xxx");
+}
+
+BOOST_AUTO_TEST_CASE(TelegramsUseCachedMemory)
+{
+    // no document exists between test cases
+    xpugi::installMemoryCache();
+
+    std::string generated;
+    const auto process_telegrams = [&generated]()
+    {
+        UpdateConfigTelegram update_config;
+        BOOST_REQUIRE(update_config.parse(UPDATE_CONFIG_XML));
+        generated = update_config.generate();
+
+        BlockListDescriptor block_list;
+        BOOST_REQUIRE(block_list.parse(BLOCK_LIST_XML));
+        BOOST_REQUIRE_EQUAL(block_list.m_windows.size(), 1);
+    };
+
+    // the first cycle fills the cache
+    process_telegrams();
+
+    const auto before = xpugi::getMemoryCacheStatistics();
+    for (int cycle = 0; cycle < 10; ++cycle)
+    {
+        process_telegrams();
+    }
+    const auto after = xpugi::getMemoryCacheStatistics();
+
+    BOOST_CHECK_GE(after.m_allocations - before.m_allocations, 10 * 4);
+    BOOST_CHECK_EQUAL(after.m_system_allocations - before.m_system_allocations, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
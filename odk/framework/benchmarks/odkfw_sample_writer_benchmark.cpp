@@ -0,0 +1,145 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkfw_sample_writer.h"
+#include "odkapi_error_codes.h"
+#include "odkapi_utils.h"
+#include "odkbase_if_host.h"
+#include "odkuni_defines.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+namespace
+{
+    const std::uint32_t CHANNEL_COUNT = 4;
+    const std::uint64_t SAMPLES_PER_PROCESS = 10000;
+    const int REPETITIONS = 50;
+
+    /**
+     * Host that only counts the sample messages and bytes it receives
+     */
+    class CountingHost : public odk::IfHost
+    {
+    public:
+        odk::IfValue* PLUGIN_API createValue(odk::IfValue::Type type) const override
+        {
+            ODK_UNUSED(type);
+            return nullptr;
+        }
+
+        std::uint64_t PLUGIN_API messageSync(odk::MessageId msg_id, std::uint64_t key, const odk::IfValue* param, const odk::IfValue** ret) override
+        {
+            ODK_UNUSED(msg_id);
+            ODK_UNUSED(key);
+            ODK_UNUSED(param);
+            ODK_UNUSED(ret);
+            return odk::error_codes::NOT_IMPLEMENTED;
+        }
+
+        std::uint64_t PLUGIN_API messageSyncData(odk::MessageId msg_id, std::uint64_t key, const void* param, std::uint64_t param_size, const odk::IfValue** ret) override
+        {
+            ODK_UNUSED(msg_id);
+            ODK_UNUSED(key);
+            ODK_UNUSED(param);
+            ODK_UNUSED(ret);
+            ++m_messages;
+            m_bytes += param_size;
+            return odk::error_codes::OK;
+        }
+
+        std::uint64_t PLUGIN_API messageAsync(odk::MessageId msg_id, std::uint64_t key, const odk::IfValue* param) override
+        {
+            ODK_UNUSED(msg_id);
+            ODK_UNUSED(key);
+            ODK_UNUSED(param);
+            return odk::error_codes::NOT_IMPLEMENTED;
+        }
+
+        const odk::IfValue* PLUGIN_API query(const char* context, const char* item, const odk::IfValue* param) override
+        {
+            ODK_UNUSED(context);
+            ODK_UNUSED(item);
+            ODK_UNUSED(param);
+            return nullptr;
+        }
+
+        const odk::IfValue* PLUGIN_API queryXML(const char* context, const char* item, const char* xml, std::uint64_t xml_size) override
+        {
+            ODK_UNUSED(context);
+            ODK_UNUSED(item);
+            ODK_UNUSED(xml);
+            ODK_UNUSED(xml_size);
+            return nullptr;
+        }
+
+        std::uint64_t m_messages = 0;
+        std::uint64_t m_bytes = 0;
+    };
+
+    template <class Process>
+    void measure(const char* name, Process process)
+    {
+        CountingHost host;
+        process(host);
+
+        host.m_messages = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int repetition = 0; repetition < REPETITIONS; ++repetition)
+        {
+            process(host);
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+        const auto samples = static_cast<double>(REPETITIONS) * SAMPLES_PER_PROCESS * CHANNEL_COUNT;
+        std::cout << name << ": " << samples / elapsed.count() / 1e6 << " M samples/s, "
+                  << host.m_messages / REPETITIONS << " messages per process call" << std::endl;
+    }
+}
+
+int main()
+{
+    // every input sample produces one sample per output channel, like the bin detector example
+    measure("odk::addSample", [](CountingHost& host)
+    {
+        for (std::uint64_t sample = 0; sample < SAMPLES_PER_PROCESS; ++sample)
+        {
+            const double value = static_cast<double>(sample);
+            for (std::uint32_t channel = 0; channel < CHANNEL_COUNT; ++channel)
+            {
+                odk::addSample(&host, channel, sample, value);
+            }
+        }
+    });
+
+    odk::framework::SampleWriter single_writer;
+    measure("SampleWriter::addSample", [&single_writer](CountingHost& host)
+    {
+        single_writer.setHost(&host);
+        for (std::uint64_t sample = 0; sample < SAMPLES_PER_PROCESS; ++sample)
+        {
+            const double value = static_cast<double>(sample);
+            for (std::uint32_t channel = 0; channel < CHANNEL_COUNT; ++channel)
+            {
+                single_writer.addSample(channel, sample, value);
+            }
+        }
+        single_writer.flush();
+    });
+
+    odk::framework::SampleWriter contiguous_writer;
+    measure("SampleWriter::addSamples", [&contiguous_writer](CountingHost& host)
+    {
+        contiguous_writer.setHost(&host);
+        for (std::uint64_t sample = 0; sample < SAMPLES_PER_PROCESS; ++sample)
+        {
+            const double value = static_cast<double>(sample);
+            for (std::uint32_t channel = 0; channel < CHANNEL_COUNT; ++channel)
+            {
+                contiguous_writer.addSamples(channel, sample, &value, 1);
+            }
+        }
+        contiguous_writer.flush();
+    });
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkfw_stream_iterator.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace odk::framework;
+
+namespace
+{
+    const std::uint64_t BLOCK_COUNT = 100;
+    const std::uint64_t SAMPLES_PER_BLOCK = 1000;
+    const int SEEK_COUNT = 1000;
+
+    template <class Function>
+    double measure(Function&& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / SEEK_COUNT;
+    }
+
+    void run(const char* name, const StreamIterator& iterator, const std::vector<std::uint64_t>& targets)
+    {
+        double checksum_linear = 0;
+        const auto linear = measure([&]()
+        {
+            for (auto target : targets)
+            {
+                StreamIterator it(iterator);
+                while (it.valid() && it.timestamp() < target)
+                {
+                    ++it;
+                }
+                checksum_linear += it.value<double>();
+            }
+        });
+
+        double checksum_seek = 0;
+        const auto seek = measure([&]()
+        {
+            StreamIterator it(iterator);
+            for (auto target : targets)
+            {
+                it.seek(target);
+                checksum_seek += it.value<double>();
+            }
+        });
+
+        std::cout << name << ": linear " << linear << " us, seek " << seek << " us per lookup"
+                  << (checksum_linear == checksum_seek ? "" : " (MISMATCH)") << std::endl;
+    }
+}
+
+int main()
+{
+    const auto total_samples = BLOCK_COUNT * SAMPLES_PER_BLOCK;
+    std::vector<double> values(total_samples);
+    std::vector<std::uint64_t> timestamps(total_samples);
+    for (std::uint64_t i = 0; i < total_samples; ++i)
+    {
+        values[i] = static_cast<double>(i);
+        timestamps[i] = 3 * i;
+    }
+
+    StreamIterator sync_iterator;
+    StreamIterator async_iterator;
+    for (std::uint64_t block = 0; block < BLOCK_COUNT; ++block)
+    {
+        const auto first = block * SAMPLES_PER_BLOCK;
+        const auto last = first + SAMPLES_PER_BLOCK;
+        sync_iterator.addRange(BlockIterator(&values[first], sizeof(double), first),
+                               BlockIterator(values.data() + last, sizeof(double), last));
+        async_iterator.addRange(BlockIterator(&values[first], sizeof(double), &timestamps[first], sizeof(std::uint64_t)),
+                                BlockIterator(values.data() + last, sizeof(double), timestamps.data() + last, sizeof(std::uint64_t)));
+    }
+
+    std::mt19937_64 random(42);
+    std::vector<std::uint64_t> targets(SEEK_COUNT);
+    for (auto& target : targets)
+    {
+        target = random() % total_samples;
+    }
+    run("sync", sync_iterator, targets);
+
+    for (auto& target : targets)
+    {
+        target *= 3;
+    }
+    run("async", async_iterator, targets);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkfw_stream_reader.h"
+#include "odkapi_block_descriptor_xml.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const std::uint64_t STREAM_ID = 1;
+    const std::uint64_t CHANNEL_COUNT = 500;
+    const std::uint64_t BLOCK_COUNT = 50;
+    const std::uint64_t SAMPLES_PER_BLOCK = 10;
+    const int REPETITIONS = 20;
+
+    odk::StreamDescriptor createStreamDescriptor()
+    {
+        odk::StreamDescriptor sd;
+        sd.m_stream_id = STREAM_ID;
+        for (std::uint64_t channel_id = 0; channel_id < CHANNEL_COUNT; ++channel_id)
+        {
+            odk::ChannelDescriptor cd;
+            cd.m_channel_id = channel_id;
+            cd.m_dimension = 1;
+            cd.m_stride = 64;
+            cd.m_size = 64;
+            cd.m_type = odk::SampleType::DOUBLE;
+            sd.m_channel_descriptors.push_back(cd);
+        }
+        return sd;
+    }
+
+    /// Every block contains SAMPLES_PER_BLOCK samples of every channel, one channel after the other
+    std::vector<odk::BlockDescriptor> createBlockDescriptors()
+    {
+        std::vector<odk::BlockDescriptor> blocks;
+        for (std::uint64_t block = 0; block < BLOCK_COUNT; ++block)
+        {
+            odk::BlockDescriptor bd;
+            bd.m_stream_id = STREAM_ID;
+            bd.m_data_size = CHANNEL_COUNT * SAMPLES_PER_BLOCK * sizeof(double);
+            for (std::uint64_t channel_id = 0; channel_id < CHANNEL_COUNT; ++channel_id)
+            {
+                odk::BlockChannelDescriptor bcd;
+                bcd.m_channel_id = channel_id;
+                bcd.m_offset = static_cast<std::uint32_t>(channel_id * SAMPLES_PER_BLOCK * 64);
+                bcd.m_count = SAMPLES_PER_BLOCK;
+                bcd.m_first_sample_index = block * SAMPLES_PER_BLOCK;
+                bcd.m_timestamp = block * SAMPLES_PER_BLOCK;
+                bcd.m_duration = SAMPLES_PER_BLOCK;
+                bd.m_block_channels.push_back(bcd);
+            }
+            blocks.push_back(bd);
+        }
+        return blocks;
+    }
+}
+
+int main()
+{
+    const auto stream_descriptor = createStreamDescriptor();
+    const auto block_descriptors = createBlockDescriptors();
+    const std::vector<double> data(CHANNEL_COUNT * SAMPLES_PER_BLOCK);
+
+    odk::framework::StreamReader reader(stream_descriptor);
+    std::vector<odk::framework::StreamIterator> iterators(CHANNEL_COUNT);
+    std::uint64_t total_samples = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int repetition = 0; repetition < REPETITIONS; ++repetition)
+    {
+        reader.clearBlocks();
+        for (const auto& block_descriptor : block_descriptors)
+        {
+            reader.addDataBlock(block_descriptor, data.data());
+        }
+        for (std::uint64_t channel_id = 0; channel_id < CHANNEL_COUNT; ++channel_id)
+        {
+            reader.updateStreamIterator(channel_id, iterators[channel_id], odk::Interval<std::uint64_t>(0, BLOCK_COUNT * SAMPLES_PER_BLOCK));
+            total_samples += iterators[channel_id].getTotalSampleCount();
+        }
+    }
+    const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "StreamReader " << CHANNEL_COUNT << " channels x " << BLOCK_COUNT << " blocks: "
+              << elapsed.count() / REPETITIONS << " us per update of all iterators"
+              << " (" << total_samples / REPETITIONS << " samples)" << std::endl;
+    return 0;
+}
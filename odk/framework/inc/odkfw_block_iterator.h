@@ -9,6 +9,47 @@ namespace odk
 {
 namespace framework
 {
+    /**
+     * How samples and their timestamps are stored inside a block
+     */
+    enum class SampleLayout
+    {
+        GAP,                                ///< no samples, just a range of timestamps
+        IMPLICIT_TIMESTAMP,                 ///< fixed size samples, timestamp incremented every sample
+        EXPLICIT_TIMESTAMP,                 ///< fixed size samples with a timestamp field
+        EXPLICIT_TIMESTAMP_DYNAMIC_SIZE     ///< samples with a timestamp and a sample size field
+    };
+
+    /**
+     * Run of consecutive samples inside a single block
+     * allows processing whole blocks in tight loops instead of stepping an iterator per sample
+     */
+    struct SampleSpan
+    {
+        const void* m_data = nullptr;                   ///< address of the first sample, nullptr for a gap
+        std::size_t m_stride = 0;                       ///< distance between two samples in bytes
+        std::uint64_t m_count = 0;                      ///< number of samples
+        std::uint64_t m_timestamp = 0;                  ///< timestamp of the first sample
+        const std::uint64_t* m_timestamps = nullptr;    ///< explicit timestamp of the first sample (same stride as data), nullptr if timestamps are implicit
+
+        ODK_NODISCARD inline bool empty() const noexcept { return m_count == 0; }
+
+        /// Value of sample at index (0 <= index < m_count) of a span that is not a gap
+        template<class SampleFormat>
+        ODK_NODISCARD inline const SampleFormat& value(std::uint64_t index) const noexcept
+        {
+            return *reinterpret_cast<const SampleFormat*>(static_cast<const std::uint8_t*>(m_data) + index * m_stride);
+        }
+
+        /// Timestamp of sample at index (0 <= index < m_count)
+        ODK_NODISCARD inline std::uint64_t timestamp(std::uint64_t index) const noexcept
+        {
+            return m_timestamps
+                ? *reinterpret_cast<const std::uint64_t*>(reinterpret_cast<const std::uint8_t*>(m_timestamps) + index * m_stride)
+                : m_timestamp + index;
+        }
+    };
+
     class BlockIterator
     {
     public:
@@ -25,9 +66,41 @@ namespace framework
         /// Dynamic sample size of the sample (0 if it has a static size)
         ODK_NODISCARD inline std::size_t size() const noexcept { return m_sample_size ? *m_sample_size : m_sample_size_value; }
 
+        ODK_NODISCARD inline SampleLayout layout() const noexcept
+        {
+            return !m_data ? SampleLayout::GAP
+                : !m_timestamp ? SampleLayout::IMPLICIT_TIMESTAMP
+                : !m_sample_size ? SampleLayout::EXPLICIT_TIMESTAMP
+                : SampleLayout::EXPLICIT_TIMESTAMP_DYNAMIC_SIZE;
+        }
+
+        /// Raw layout information used to create a TypedBlockIterator
+        ODK_NODISCARD inline std::size_t dataStride() const noexcept { return m_data_stride; }
+        ODK_NODISCARD inline const std::uint64_t* timestampData() const noexcept { return m_timestamp; }
+        ODK_NODISCARD inline std::size_t timestampStride() const noexcept { return m_timestamp ? m_timestamp_stride : 0; }
+        ODK_NODISCARD inline const std::uint32_t* sampleSizeData() const noexcept { return m_sample_size; }
+        ODK_NODISCARD inline std::size_t sampleSizeStride() const noexcept { return m_sample_size ? m_sample_size_stride : 0; }
+
         BlockIterator& operator++();
+
+        /**
+         * Steps back one sample
+         * throws std::runtime_error for samples with dynamic size, @see stepBack
+         */
         BlockIterator& operator--();
 
+        /**
+         * Steps back one sample whose size is known to the caller (e.g. from an offset table)
+         * also works for samples with dynamic size
+         */
+        BlockIterator& stepBack(std::size_t previous_sample_size) noexcept;
+
+        /**
+         * Advances by count samples at once
+         * samples with dynamic size are stepped one by one
+         */
+        BlockIterator& operator+=(std::uint64_t count);
+
         ODK_NODISCARD inline bool operator==(const BlockIterator& other) const noexcept
         {
             return m_data && other.m_data ?
@@ -55,8 +128,19 @@ namespace framework
             return timestamp() >= other.timestamp();
         }
 
+        /**
+         * Number of samples between this position and other
+         * has to step through every sample if the samples have a dynamic size,
+         * use the sample counts kept by StreamIterator where possible
+         */
         ODK_NODISCARD std::uint64_t distanceTo(const BlockIterator& other) const noexcept;
 
+        /**
+         * Describes the samples from this position up to end (at most max_count samples)
+         * gaps yield spans without data, samples with dynamic size yield spans of a single sample
+         */
+        ODK_NODISCARD SampleSpan spanTo(const BlockIterator& end, std::uint64_t max_count) const noexcept;
+
     private:
         const void* m_data;
         std::size_t m_data_stride;
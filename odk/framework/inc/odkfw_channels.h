@@ -6,6 +6,7 @@
 #include "odkfw_interfaces.h"
 #include "odkfw_if_message_handler.h"
 #include "odkfw_properties.h"
+#include "odkfw_sample_writer.h"
 
 #include "odkbase_if_host.h"
 
@@ -80,6 +81,42 @@ namespace framework
 
         const std::string getName();
 
+        /**
+         * Stages a sample with an explicit timestamp (e.g. for async channels)
+         * Staged samples are sent by flushSamples(), which SoftwareChannelInstance calls after every process call.
+         * Every sample is still sent with its own odk::host_msg::ADD_SAMPLE message, but from a buffer that is reused.
+         */
+        void addSample(std::uint64_t timestamp, const void* data, std::size_t data_size);
+
+        template <class T>
+        inline void addSample(std::uint64_t timestamp, const T& value)
+        {
+            addSample(timestamp, &value, sizeof(T));
+        }
+
+        /**
+         * Stages sample_count samples with consecutive timestamps (sync channels)
+         * Consecutive calls are sent as a single odk::host_msg::ADD_CONTIGUOUS_SAMPLES message by flushSamples()
+         */
+        void addSamples(std::uint64_t timestamp, const void* data, std::size_t sample_size, std::size_t sample_count);
+
+        template <class T>
+        inline void addSamples(std::uint64_t timestamp, const T* values, std::size_t sample_count)
+        {
+            addSamples(timestamp, values, sizeof(T), sample_count);
+        }
+
+        /**
+         * Sends all staged samples to the host
+         * @return result of the first host message that failed, odk::error_codes::OK otherwise
+         */
+        std::uint64_t flushSamples();
+
+        /**
+         * Discards all staged samples without sending them
+         */
+        void clearSamples() noexcept;
+
     protected:
         void setChangeListener(IfPluginChannelChangeListener* l);
 
@@ -113,6 +150,7 @@ namespace framework
         odk::UpdateChannelsTelegram::PluginChannelInfo m_channel_info;
         std::vector<std::pair<std::string, ChannelPropertyPtr>> m_properties;
         PluginChannelPtr m_local_parent;
+        SampleWriter m_sample_writer;
     };
 
     class PluginTask
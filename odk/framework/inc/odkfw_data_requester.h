@@ -14,8 +14,13 @@
 #include "odkapi_data_set_descriptor_xml.h"
 #include "odkfw_stream_iterator.h"
 
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -36,37 +41,208 @@ namespace framework
         static uint64_t m_next_id;
     };
 
-    class DataRequester : public IfIteratorUpdater
+    /**
+     * Reads the recorded data of one or more channels window by window
+     *
+     * All channels share one data set, so every window is requested from the host once for all of them.
+     * The iterators of the channels share the windows as well and a window is kept until every iterator
+     * has moved past it. Iterators should therefore be advanced alongside each other, reading one channel
+     * to the end before the others keeps all windows of the interval in memory. The iterators of different
+     * channels may be advanced from different threads.
+     *
+     * The data regions of the channels are requested once per interval. Samples outside of the valid regions
+     * are reported as gaps by the iterators, which skip them unless StreamIterator::setSkipGaps(false) is used.
+     */
+    class DataRequester
     {
-        static constexpr uint64_t BLOCK_SIZE = 1000;
+        /// window length used until the data rate of the channel is known
         static constexpr double BLOCK_LENGTH = 0.1;
+        static constexpr double MIN_WINDOW_LENGTH = 0.001;
+        static constexpr double MAX_WINDOW_LENGTH = 3600.0;
 
     public:
+        static constexpr std::uint64_t DEFAULT_WINDOW_BYTES = 1024 * 1024;
+
+        /**
+         * Counters of the DATA_READ requests sent since construction
+         */
+        struct Statistics
+        {
+            std::uint64_t m_requests = 0;
+            /// requests answered without data blocks
+            std::uint64_t m_empty_requests = 0;
+            std::uint64_t m_blocks = 0;
+            std::uint64_t m_bytes = 0;
+            /// length in seconds of the next window that will be requested
+            double m_window_length = 0;
+        };
+
         DataRequester(odk::IfHost *host, std::uint64_t channel_id, bool user_reduced = false);
 
+        DataRequester(odk::IfHost *host, std::vector<std::uint64_t> channel_ids, bool user_reduced = false);
+
         DataRequester(const DataRequester& ) = delete;
 
         ~DataRequester();
 
         void setupDataRequest();
 
-        void fetchMoreData();
+        /**
+         * Requests up to window_count windows ahead on a background thread while the iterator is consumed,
+         * so that the consumer does not wait for a host round-trip whenever the iterator runs dry.
+         * 0 (the default) requests each window synchronously when it is needed.
+         * Has to be called before getIterator.
+         */
+        void setPrefetchWindows(std::size_t window_count);
+
+        /**
+         * Sets the amount of sample data that should be requested per window.
+         * Windows start with a length estimated from the sample rate of the channel
+         * and follow the number of bytes actually delivered per second.
+         */
+        void setWindowByteBudget(std::uint64_t bytes);
+
+        ODK_NODISCARD Statistics getStatistics() const;
+
+        /**
+         * Appends the next window with data blocks to the windows shared by the iterators
+         * @return false at the end of the interval or if the host did not deliver data
+         */
+        bool fetchMoreData();
+
+        /**
+         * Returns the iterator of the first channel, positioned at the start of the interval
+         * @throws std::runtime_error if the channel is not part of the data set
+         */
+        std::shared_ptr<StreamIterator> getIterator(double start, double end);
 
-        void updateStreamIterator(StreamIterator* iterator) final;
+        /**
+         * Returns the iterators of all channels that are part of the data set, positioned at the start of the interval
+         * The same iterators are returned and repositioned by every call.
+         */
+        std::map<std::uint64_t, std::shared_ptr<StreamIterator>> getIterators(double start, double end);
 
-        std::shared_ptr<StreamIterator> getIterator(double start, double end);
+        /**
+         * Announces the interval of the next getIterators call.
+         * With prefetching enabled its first windows are requested as soon as all windows of the current interval
+         * have been requested, so that the consumer does not wait for them when it moves on.
+         */
+        void setNextInterval(double start, double end);
 
     private:
+        /**
+         * One DATA_READ reply with its decoded block descriptors
+         * The block list keeps the sample data alive until the window is recycled.
+         */
+        struct Window
+        {
+            odk::detail::ApiObjectPtr<const IfDataBlockList> m_data_block_list;
+            /// one reader per stream of the data set, cleared blocks keep their allocations for reuse
+            std::vector<StreamReader> m_stream_readers;
+            /// decodes the blocks of data sets with several streams
+            BlockDescriptor m_block_descriptor;
+            std::size_t m_block_count = 0;
+            std::uint64_t m_bytes = 0;
+            /// the window covers [m_begin, m_end), including the empty windows requested before it
+            double m_begin = 0;
+            double m_end = 0;
+            /// interval the window was requested for, @see m_prefetch_generation
+            std::uint64_t m_generation = 0;
+            bool m_valid = false;
+        };
+
+        /**
+         * Moves the iterator of one channel through the shared windows
+         */
+        class ChannelUpdater : public IfIteratorUpdater
+        {
+        public:
+            ChannelUpdater(DataRequester& requester, std::uint64_t channel_id, std::size_t stream_index);
+
+            void updateStreamIterator(StreamIterator* iterator) final;
+
+            DataRequester& m_requester;
+            std::uint64_t m_channel_id;
+            /// index into Window::m_stream_readers
+            std::size_t m_stream_index;
+            /// ticks per second, 0 if the timebase is unknown and gaps cannot be located
+            double m_frequency;
+            /// window the iterator is moved to next, counted from the start of the interval
+            std::uint64_t m_next_window;
+            std::shared_ptr<StreamIterator> m_iterator;
+        };
+
+        void advance(ChannelUpdater& channel);
+        void releaseConsumedWindows();
+
+        void readDataRegions(double start, double end);
+        /// ticks of the channel covered by the window
+        odk::Interval<std::uint64_t> getWindowTicks(const ChannelUpdater& channel, const Window& window) const;
+        /// hands the window to the iterators together with the data regions it covers
+        void addWindow(std::unique_ptr<Window> window);
+        /// adds an empty window up to the end of the interval, so that trailing gaps are reported
+        bool addTailWindow();
+
+        bool readWindow(Window& window, double start, double end);
+        /// m_prefetch_mutex has to be locked
+        double getWindowEnd(double start, double end) const noexcept;
+        /// m_prefetch_mutex has to be locked
+        void resetWindowLength() noexcept;
+        /// m_prefetch_mutex has to be locked
+        void updateWindowLength(const Window& window, double start) noexcept;
+        std::unique_ptr<Window> takeFreeWindow();
+        /// m_prefetch_mutex has to be locked
+        std::unique_ptr<Window> takeFreeWindowLocked();
+        void recycleWindow(std::unique_ptr<Window> window);
+
+        bool fetchPrefetchedData();
+        void restartPrefetch(double start, double end);
+        void stopPrefetch();
+        void prefetchData();
+
         odk::IfHost* m_host;
         double m_current_position;
         double m_end_position;
-        uint64_t m_channel_id;
+        std::vector<std::uint64_t> m_channel_ids;
         DataSetDescriptor m_dataset_descriptor;
-        odk::detail::ApiObjectPtr<const IfDataBlockList> m_data_block_list;
-        odk::framework::StreamReader m_stream_reader;
-        std::shared_ptr<StreamIterator> m_iterator;
+        /// channels of m_channel_ids that are part of the data set, referenced by their iterators
+        std::vector<std::unique_ptr<ChannelUpdater>> m_channels;
+        /// windows of the interval in use by at least one iterator, the first one has the index m_first_window
+        std::deque<std::unique_ptr<Window>> m_windows;
+        std::uint64_t m_first_window;
+        /// interval of the prefetched windows handed to the iterators
+        std::uint64_t m_consumer_generation;
+        /// end of the last window handed to the iterators
+        double m_window_begin;
+        /// valid regions of the interval, sorted by channel and begin
+        std::vector<odk::DataRegion> m_data_regions;
         bool m_is_single_value;
         bool m_user_reduced;
+        /// serialises the iterators of different channels moving through the shared windows
+        std::mutex m_advance_mutex;
+
+        std::size_t m_prefetch_windows;
+        std::thread m_prefetch_thread;
+        /// guards all members below
+        mutable std::mutex m_prefetch_mutex;
+        std::uint64_t m_window_bytes;
+        /// bytes per second of the channel as configured, 0 if unknown
+        double m_nominal_data_rate;
+        Statistics m_statistics;
+        std::condition_variable m_prefetch_condition;
+        std::deque<std::unique_ptr<Window>> m_ready_windows;
+        std::vector<std::unique_ptr<Window>> m_free_windows;
+        double m_prefetch_start;
+        double m_prefetch_position;
+        double m_prefetch_end;
+        /// set by setNextInterval until the prefetch thread moves on to that interval
+        bool m_has_next_interval;
+        double m_next_start;
+        double m_next_end;
+        /// incremented for every interval to tell the windows of different intervals apart
+        std::uint64_t m_prefetch_generation;
+        bool m_prefetch_in_flight;
+        bool m_stop_prefetch;
     };
 }
 }
@@ -8,9 +8,13 @@
 #include "odkuni_defines.h"
 
 #include <atomic>
+#include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 #include <stdint.h>
 
 namespace odk
@@ -34,6 +38,8 @@ namespace framework
         public:
             std::map<uint64_t, std::shared_ptr<odk::framework::StreamIterator>> m_channel_iterators;
             std::map<uint64_t, std::shared_ptr<odk::framework::StreamIterator>> m_reduced_channel_iterators;
+            /// index into m_properties.m_export_intervals of the interval the iterators are positioned in
+            std::size_t m_interval_index = 0;
         };
 
         ExportInstance();
@@ -65,10 +71,95 @@ namespace framework
 
         void notifyProgress(uint64_t progress) const;
 
+        /**
+         * Reports the progress of the current export interval as progress of the whole export
+         * The intervals are weighted by their length.
+         * @param interval_progress exported part of the current interval, 0 to 1
+         */
+        void notifyIntervalProgress(double interval_progress) const;
+
+        /**
+         * Positions the iterators of the processing context at the start of the next export interval
+         * The iterators stay the same objects. With prefetching enabled (setPrefetchWindows) the data of the
+         * following interval is requested in the background while this one is exported.
+         * @return false if the current interval was the last one
+         */
+        bool nextExportInterval();
+
+        /**
+         * Runs task(task_index) for every task_index in [0, task_count) and returns when all of them are done
+         *
+         * The tasks are distributed over the export thread and further worker threads, the thread count is taken
+         * from the custom export property WORKER_THREADS (1 if not set, all tasks run on the export thread then).
+         * Tasks have to be independent of each other, e.g. one task per channel that writes a file of its own.
+         * The iterators of different channels may be advanced from different tasks. One task per channel relies on
+         * every channel having a data set of its own (the default, see setGroupChannels): with grouped channels a
+         * window is kept until the slowest task has passed it, so tasks should then split the export by time instead.
+         * No further tasks are started after setCanceled or a failed task.
+         * @throws the exception of the first failed task, std::runtime_error if the export has been canceled
+         */
+        void runParallel(std::size_t task_count, const std::function<void(std::size_t)>& task);
+
+        /**
+         * Reports the progress of one task of runParallel
+         * The average over all tasks is reported as progress of the current export interval.
+         * @param progress done part of the task, 0 to 1
+         * @throws std::runtime_error if the export has been canceled
+         */
+        void notifyTaskProgress(std::size_t task_index, double progress);
+
+        ODK_NODISCARD bool isCanceled() const noexcept;
+
+        /**
+         * Number of threads used by runParallel
+         * Replaced by the custom property WORKER_THREADS of an export that is started afterwards.
+         */
+        void setWorkerThreads(std::size_t thread_count) noexcept;
+
+        /**
+         * Number of data windows requested ahead of exportData for each channel, 0 (the default) requests them on demand
+         * Prefetched windows are requested from a background thread while exportData runs, so the host has to
+         * accept concurrent messageSync calls of the plugin. Takes effect for exports started afterwards.
+         */
+        void setPrefetchWindows(std::size_t window_count) noexcept;
+
+        /**
+         * Requests the data of all channels through one data set, so that every window is read once for all of them
+         * A window stays loaded until the iterators of all channels have passed it, so this is only suitable
+         * for plugins that advance the iterators alongside each other. Reading one channel to the end before
+         * the next one keeps every window of the interval in memory.
+         * Off by default, every channel gets a data set of its own then. Takes effect for exports started afterwards,
+         * called from configureExport for the export that is being started.
+         */
+        void setGroupChannels(bool enabled) noexcept;
+
+        /**
+         * Called when an export starts, before the data of its channels is requested
+         * Allows to choose the settings above for the channels and properties of this export. Does nothing by default.
+         */
+        virtual void configureExport(const ValidationContext& context);
+
+        /**
+         * True if all channels of the context are sampled at the same rate
+         * Iterators advanced by the same number of samples then stay at the same time, so grouped channels
+         * (setGroupChannels) keep few windows loaded. Channels without sample rate are not compared.
+         */
+        ODK_NODISCARD static bool haveEqualSampleRates(const ValidationContext& context);
+
     private:
+        void requestInterval(std::size_t interval_index);
+
         odk::IfHost* m_host = nullptr;
         std::thread m_worker_thread;
         std::atomic<bool> m_canceled;
+        std::size_t m_prefetch_windows;
+        bool m_group_channels;
+        std::size_t m_worker_threads;
+        /// guards the task progress, host notifications about it are serialised as well
+        std::mutex m_task_mutex;
+        std::vector<double> m_task_progress;
+        double m_task_progress_sum;
+        double m_reported_task_progress;
         std::vector<std::unique_ptr<DataRequester>> m_data_requester;
         std::vector<std::unique_ptr<DataRequester>> m_reduced_requester;
         ProcessingContext m_context;
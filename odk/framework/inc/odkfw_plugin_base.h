@@ -34,13 +34,14 @@
 #endif
 
 
-#define OXY_REGISTER_PLUGIN1(PLUGIN_NAME, PLUGIN_MANIFEST, PLUGIN_CLASS)                                                \
+#define OXY_REGISTER_PLUGIN_IMPL(PLUGIN_NAME, PLUGIN_MANIFEST, PLUGIN_CLASS, BEFORE_CREATE)                             \
             extern "C" {                                                                                                \
                 DLL_EXPORT const char* dwGetPluginName() { return PLUGIN_NAME; }                                        \
                 DLL_EXPORT const char* dwGetPluginManifest() { return PLUGIN_MANIFEST; }                                \
                 DLL_EXPORT int dwCreatePlugin(odk::UuidType uuid, void** plugin) {                                      \
                     if (uuid == odk::Oxygen_Plugin_Uuid) {                                                              \
                         if (plugin) {                                                                                   \
+                            BEFORE_CREATE;                                                                              \
                             auto plugin_inst = new PLUGIN_CLASS();                                                      \
                             *plugin = plugin_inst;                                                                      \
                         }                                                                                               \
@@ -56,6 +57,19 @@
                 }                                                                                                       \
             }
 
+#define OXY_REGISTER_PLUGIN1(PLUGIN_NAME, PLUGIN_MANIFEST, PLUGIN_CLASS)                                                \
+            OXY_REGISTER_PLUGIN_IMPL(PLUGIN_NAME, PLUGIN_MANIFEST, PLUGIN_CLASS, (void)0)
+
+/**
+ * Registers the plugin like OXY_REGISTER_PLUGIN1 and installs the pugixml memory cache before the plugin is created
+ * (@see odk::framework::PluginBase::installXmlMemoryCache).
+ * Only for plugins that do not create or parse XML documents during static initialisation, e.g. in a global
+ * pugi::xml_document: memory allocated by pugixml before the cache is installed cannot be released through it.
+ */
+#define OXY_REGISTER_PLUGIN1_WITH_XML_MEMORY_CACHE(PLUGIN_NAME, PLUGIN_MANIFEST, PLUGIN_CLASS)                          \
+            OXY_REGISTER_PLUGIN_IMPL(PLUGIN_NAME, PLUGIN_MANIFEST, PLUGIN_CLASS,                                        \
+                odk::framework::PluginBase::installXmlMemoryCache())
+
 namespace odk
 {
 namespace framework
@@ -70,6 +84,13 @@ namespace framework
         {
         }
 
+        /**
+         * Routes the memory of pugixml through xpugi::installMemoryCache
+         * pugixml sets its allocator for the whole plugin library, so this is an opt-in that has to be called
+         * before the plugin creates any XML document (@see OXY_REGISTER_PLUGIN1_WITH_XML_MEMORY_CACHE).
+         */
+        static void installXmlMemoryCache();
+
         // only override for special message handling; normal stuff should register handlers
         virtual bool handleMessage(odk::PluginMessageId id, std::uint64_t key, const odk::IfValue* param, const odk::IfValue** ret, std::uint64_t& ret_code)
         {
@@ -0,0 +1,110 @@
+// Copyright DEWETRON GmbH 2026
+
+#pragma once
+
+#include "odkbase_if_host_fwd.h"
+#include "odkuni_defines.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace odk
+{
+    namespace framework
+    {
+        /**
+         * The SampleWriter collects output samples of multiple channels in reusable staging buffers
+         * and sends them to the host when flush() is called (e.g. once at the end of a process call).
+         *
+         * Samples added with addSamples() to the same channel are merged into a single
+         * odk::host_msg::ADD_CONTIGUOUS_SAMPLES message as long as their timestamps are consecutive.
+         * Samples added with addSample() are stored as timestamp + value records that are sent with
+         * odk::host_msg::ADD_SAMPLE directly from the staging buffer, without copying them again.
+         *
+         * After the buffers have grown to the size needed per flush, adding and sending samples does not allocate memory.
+         * Samples that have not been flushed are discarded when the writer is destroyed.
+         */
+        class SampleWriter
+        {
+        public:
+            explicit SampleWriter(odk::IfHost* host = nullptr);
+
+            void setHost(odk::IfHost* host) noexcept;
+
+            /**
+             * Stages a single sample with an explicit timestamp
+             */
+            void addSample(std::uint32_t local_channel_id, std::uint64_t timestamp, const void* data, std::size_t data_size);
+
+            template <class T>
+            inline void addSample(std::uint32_t local_channel_id, std::uint64_t timestamp, const T& data)
+            {
+                addSample(local_channel_id, timestamp, &data, sizeof(T));
+            }
+
+            /**
+             * Stages sample_count samples of sample_size bytes with consecutive timestamps starting at timestamp
+             * If the timestamp does not continue the samples already staged for the channel, those are sent first.
+             */
+            void addSamples(std::uint32_t local_channel_id, std::uint64_t timestamp, const void* data, std::size_t sample_size, std::size_t sample_count);
+
+            template <class T>
+            inline void addSamples(std::uint32_t local_channel_id, std::uint64_t timestamp, const T* data, std::size_t sample_count)
+            {
+                addSamples(local_channel_id, timestamp, data, sizeof(T), sample_count);
+            }
+
+            /**
+             * Sends all staged samples to the host, channel by channel in the order the samples were added to each channel
+             * @return result of the first host->messageSyncData call that failed, odk::error_codes::OK otherwise
+             */
+            std::uint64_t flush();
+
+            /**
+             * Discards all staged samples, the staging buffers are kept
+             */
+            void clear() noexcept;
+
+            /**
+             * Number of staged samples of all channels
+             */
+            ODK_NODISCARD std::size_t getPendingSampleCount() const noexcept;
+
+        private:
+            /**
+             * Byte buffer that only grows, appending does not initialize the bytes before copying
+             */
+            struct StagingBuffer
+            {
+                std::vector<std::uint8_t> m_storage;
+                std::size_t m_size = 0;
+
+                void append(const void* data, std::size_t size);
+                ODK_NODISCARD inline const std::uint8_t* data() const noexcept { return m_storage.data(); }
+            };
+
+            struct ChannelBuffer
+            {
+                std::uint32_t m_local_channel_id = 0;
+                /// timestamp of the first sample followed by the values of consecutive samples
+                StagingBuffer m_contiguous_samples;
+                std::size_t m_contiguous_sample_count = 0;
+                std::uint64_t m_next_timestamp = 0;
+                /// timestamp + value records of single samples
+                StagingBuffer m_samples;
+                /// end offset of every record in m_samples
+                std::vector<std::size_t> m_sample_ends;
+            };
+
+            ChannelBuffer& getChannelBuffer(std::uint32_t local_channel_id);
+            std::uint64_t flushContiguousSamples(ChannelBuffer& buffer);
+            std::uint64_t flushSamples(ChannelBuffer& buffer);
+
+            odk::IfHost* m_host;
+            /// ordered by local channel id
+            std::vector<ChannelBuffer> m_channel_buffers;
+            std::size_t m_last_channel_buffer;
+        };
+    }
+}
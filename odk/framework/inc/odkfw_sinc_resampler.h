@@ -0,0 +1,92 @@
+// Copyright DEWETRON GmbH 2026
+
+#pragma once
+
+#include "odkuni_defines.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace odk
+{
+    namespace framework
+    {
+        /**
+         * The SincResampler converts a stream of equidistant samples to a different sample rate
+         * It uses a polyphase table of a Blackman windowed sinc kernel with linear interpolation between the phases.
+         * The cutoff is lowered to the output Nyquist frequency when downsampling.
+         * Input is added block by block and only the samples that are still needed by the kernel are kept,
+         * so the memory usage does not depend on the length of the stream.
+         * Output sample n is located at the time of input sample n * input_rate / output_rate, samples
+         * before the first input sample are zero.
+         * The kernel table is immutable and shared by all resamplers with the same cutoff and half width,
+         * e.g. by the channels of an export.
+         *
+         * The half width is limited to MAX_HALF_WIDTH input samples. When decimating by more than
+         * MAX_HALF_WIDTH / zero_crossings (32 by default), the kernel spans fewer zero crossings of the
+         * lowered cutoff: the transition band gets wider and the aliasing suppression drops accordingly.
+         */
+        class SincResampler
+        {
+        public:
+            /// default number of zero crossings of the kernel on each side
+            static const std::size_t DEFAULT_ZERO_CROSSINGS = 16;
+            /// limit of the kernel half width in input samples, shortens the kernel for decimation ratios above MAX_HALF_WIDTH / zero_crossings
+            static const std::size_t MAX_HALF_WIDTH = 512;
+            /// number of precomputed kernel phases between two input samples
+            static const std::size_t PHASE_COUNT = 256;
+
+            SincResampler(double input_rate, double output_rate, std::size_t zero_crossings = DEFAULT_ZERO_CROSSINGS);
+
+            ODK_NODISCARD double getInputRate() const { return m_input_rate; }
+            ODK_NODISCARD double getOutputRate() const { return m_output_rate; }
+            ODK_NODISCARD std::size_t getHalfWidth() const { return m_half_width; }
+
+            /**
+             * Returns the polyphase table of PHASE_COUNT + 1 rows of 2 * getHalfWidth() coefficients
+             */
+            ODK_NODISCARD const std::vector<double>& getKernel() const { return *m_kernel; }
+
+            /**
+             * Returns the number of output samples computed since construction or reset
+             */
+            ODK_NODISCARD std::uint64_t getOutputCount() const { return m_output_index; }
+
+            /**
+             * Discards all input and starts a new stream
+             */
+            void reset();
+
+            /**
+             * Returns how many more input samples have to be added before process can compute num_output samples
+             */
+            ODK_NODISCARD std::size_t requiredInput(std::size_t num_output) const;
+
+            void addInput(const double* data, std::size_t num_samples);
+
+            /**
+             * Computes up to max_output samples from the input added so far
+             * @return number of samples written to output
+             */
+            std::size_t process(double* output, std::size_t max_output);
+
+        private:
+            /// index of the first input sample the kernel of output sample n needs
+            ODK_NODISCARD std::int64_t firstInput(std::uint64_t n) const;
+
+            double m_input_rate;
+            double m_output_rate;
+            /// input samples per output sample
+            double m_step;
+            std::size_t m_half_width;
+            /// PHASE_COUNT + 1 rows of 2 * m_half_width coefficients
+            std::shared_ptr<const std::vector<double>> m_kernel;
+            std::uint64_t m_output_index;
+            /// stream index of m_input[0], negative for the zeros in front of the stream
+            std::int64_t m_input_offset;
+            std::vector<double> m_input;
+        };
+    }
+}
@@ -1,6 +1,7 @@
 // Copyright DEWETRON GmbH 2019
 #pragma once
 
+#include "odkapi_acquisition_task_xml.h"
 #include "odkapi_block_descriptor_xml.h"
 #include "odkapi_data_set_descriptor_xml.h"
 #include "odkapi_timestamp_xml.h"
@@ -9,6 +10,7 @@
 #include "odkfw_input_channel.h"
 #include "odkfw_interfaces.h"
 #include "odkfw_stream_iterator.h"
+#include "odkfw_stream_reader.h"
 
 #include <set>
 
@@ -32,6 +34,7 @@ namespace framework
         struct ProcessingContext
         {
             Timestamp m_master_timestamp;
+            /// cycles without data keep the iterators of the channels, they are reset and hold no samples then
             std::map<uint64_t, odk::framework::StreamIterator> m_channel_iterators;
             std::pair<double, double> m_window;
         };
@@ -159,6 +162,7 @@ namespace framework
         /**
          * Called periodically as long as acquisition is running
          * processing and adding samples to output channels is done in here
+         * samples staged with PluginChannel::addSample/addSamples are sent to the host after the call returns
          *
          * @param context  time information and sample data of input channels of processing interval
          */
@@ -380,6 +384,33 @@ namespace framework
 
         void onProcess(odk::IfHost* host, std::uint64_t token, const odk::IfXMLValue* param) final;
 
+        /**
+         * Calls process and sends the samples staged on the output channels, which are discarded if process fails
+         * @return odk::error_codes::UNHANDLED_EXCEPTION if process failed, the result of flushOutputSamples otherwise
+         */
+        std::uint64_t processAndFlush(ProcessingContext& context, odk::IfHost* host);
+
+        /**
+         * Sends the samples staged on the output channels (@see PluginChannel::addSample) during a process call
+         * @return result of the first host message that failed, odk::error_codes::OK otherwise
+         */
+        std::uint64_t flushOutputSamples();
+
+        /**
+         * Drops the samples staged on the output channels, so that a failed process call sends nothing
+         */
+        void discardOutputSamples() noexcept;
+
+        /**
+         * Requests the valid regions of the data window with a separate DATA_REGIONS_READ and stores them in m_data_regions
+         */
+        void readDataRegions(odk::IfHost* host, double start, double end);
+
+        /**
+         * Copies m_request_xml into an XML value that is created once and reused for every request
+         */
+        const odk::IfXMLValue* updateRequestValue(odk::IfHost* host);
+
         void onChannelConfigChanged(odk::IfHost* host, std::uint64_t token) final;
 
         std::map<uint64_t, odk::framework::StreamIterator> createChannelIterators(
@@ -394,6 +425,22 @@ namespace framework
 
     protected:
         odk::IfHost* getHost();
+
+        /**
+         * Refreshes existing channel iterators in place, reusing their storage
+         *
+         * @param data_regions     valid regions of the channels, nullptr if all samples are valid
+         * @param invalid_regions  invalid regions of the channels as reported with the data (@see BlockListDescriptor::m_invalid_regions),
+         *                         used instead of data_regions if not nullptr
+         */
+        void updateChannelIterators(
+            std::map<uint64_t, odk::framework::StreamIterator>& iterators,
+            const std::vector<odk::StreamDescriptor>& stream_descriptor,
+            const odk::IfDataBlockList* block_list,
+            const odk::Interval<double>& covered_interval,
+            const odk::DataRegions* data_regions,
+            const std::vector<odk::DataRegion>* invalid_regions = nullptr);
+
         std::vector<PluginChannelPtr> m_output_channels;
 
     private:
@@ -404,6 +451,19 @@ namespace framework
         std::vector<InputChannelPtr> m_input_channel_proxies;
         boost::optional<DataSetDescriptor> m_dataset_descriptor;
         std::vector<const odk::IfDataBlockList*> m_block_lists;
+        StreamReader m_stream_reader;
+        ProcessingContext m_processing_context;
+        /// telegrams and data requests of onProcess, kept to reuse their storage
+        odk::AcquisitionTaskProcessTelegram m_process_telegram;
+        std::string m_request_xml;
+        odk::detail::ApiObjectPtr<odk::IfXMLValue> m_request_value;
+        odk::BlockListDescriptor m_list_descriptor;
+        odk::DataRegions m_data_regions;
+        std::vector<odk::DataRegion> m_invalid_regions;
+        /// cleared as soon as the host rejects a DATA_READ that requests the invalid regions but accepts it without them
+        bool m_data_read_includes_regions = true;
+        /// set once the host answered a DATA_READ with the requested invalid regions, a reply without them has none then
+        bool m_data_read_regions_confirmed = false;
         odk::IfHost* m_host = nullptr;
     };
 
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "odkfw_block_iterator.h"
+#include "odkfw_typed_block_iterator.h"
 #include "odkuni_assert.h"
 #include "odkuni_defines.h"
 
@@ -20,10 +21,10 @@ namespace framework
     public:
         StreamIterator() noexcept;
 
-        /// Start address of the sample
+        /// Start address of the sample, nullptr while the iterator is parked at the end of a block (see nextSpan)
         ODK_NODISCARD inline const void* data() const noexcept
         {
-            return valid() ? m_current_iterator.data() : nullptr;
+            return valid() && !m_advance_pending ? m_current_iterator.data() : nullptr;
         }
 
         /// Timestamp of the sample
@@ -34,7 +35,7 @@ namespace framework
 
         ODK_NODISCARD inline std::size_t size() const noexcept
         {
-            return valid() ? m_current_iterator.size() : 0;
+            return valid() && !m_advance_pending ? m_current_iterator.size() : 0;
         }
 
         template<class SampleFormat>
@@ -52,15 +53,60 @@ namespace framework
             return m_block_index >= 0;
         }
 
+        /**
+         * Adds a range of samples ordered by its first timestamp and moves the iterator to the first sample
+         */
         void addRange(const BlockIterator& begin, const BlockIterator& end);
 
+        /**
+         * Adds a range of sample_count samples ordered by its first timestamp and moves the iterator to the first sample
+         * Avoids counting samples with dynamic size one by one.
+         */
+        void addRange(const BlockIterator& begin, const BlockIterator& end, std::uint64_t sample_count);
+
+        /**
+         * Appends a range of samples without ordering it, sortRanges() has to be called after the last one
+         * Used to fill an iterator with many ranges at once.
+         */
+        void appendRange(const BlockIterator& begin, const BlockIterator& end);
+
+        /**
+         * Appends a range of sample_count samples without ordering it, sortRanges() has to be called after the last one
+         */
+        void appendRange(const BlockIterator& begin, const BlockIterator& end, std::uint64_t sample_count);
+
+        /**
+         * Appends a range of timestamps without samples (e.g. an invalid region), sortRanges() has to be called after the last one
+         * Gap ranges are only merged into the iterated ranges when gaps are not skipped.
+         */
+        void appendGapRange(std::uint64_t begin, std::uint64_t end);
+
+        /**
+         * Orders all appended ranges by their first timestamp and moves the iterator to the first sample
+         */
+        void sortRanges();
+
+        /**
+         * Removes all ranges, the allocated storage is kept to be reused by the next ranges
+         */
         void clearRanges() noexcept;
 
+        /**
+         * Removes all ranges and restores the settings of a newly constructed iterator
+         * while keeping the allocated storage
+         */
+        void reset() noexcept;
+
         void setDataRequester(IfIteratorUpdater* requester) noexcept;
 
         inline StreamIterator& operator++()
         {
             ODK_ASSERT(valid());
+            if (m_advance_pending)
+            {
+                resumeAdvance();
+                return *this;
+            }
             ++m_current_iterator;
             if (m_current_iterator == m_blocks_ranges[m_block_index].second)
             {
@@ -69,14 +115,104 @@ namespace framework
             return *this;
         }
 
+        /**
+         * Returns the samples from the current position up to the end of the current block
+         * (at most max_count samples) and advances the iterator behind them.
+         * Gaps that are not skipped are returned as spans without data.
+         * An empty span is returned if the iterator is not valid.
+         *
+         * With a data requester the samples of a block are only valid as long as the iterator has not moved
+         * to the next block, because the requester releases the data the iterator has passed.
+         * Therefore a span that ends a block leaves the iterator parked at the end of that block:
+         * it stays valid but has no data, and the next call of nextSpan(), nextRange(), operator++ or seek()
+         * moves it to the following block. The span stays readable until then.
+         */
+        SampleSpan nextSpan(std::uint64_t max_count = std::numeric_limits<std::uint64_t>::max());
+
+        /**
+         * Moves the iterator to the first sample with a timestamp not less than the given one.
+         * Blocks are located by binary search, inside a block the position is computed directly
+         * for implicit timestamps and by binary search for explicit timestamps.
+         * Samples with dynamic size are searched linearly inside their block.
+         *
+         * @return false if there is no such sample
+         */
+        bool seek(std::uint64_t timestamp);
+
+        /**
+         * Returns a copy of the iterator positioned at the first sample with a timestamp not less than the given one
+         * The copy is detached from the data requester: only the blocks loaded into this iterator are searched
+         * and the copy is not valid if the sample is behind them.
+         * @see seek
+         */
+        ODK_NODISCARD StreamIterator lowerBound(std::uint64_t timestamp) const;
+
+        /**
+         * Returns the remaining samples of the current block as a typed range and advances to the next block.
+         * Gaps are skipped. The iterator types have to match sampleLayout().
+         * Like a span of nextSpan(), the range stays readable until the iterator is moved again.
+         *
+         * @return false if there are no more samples
+         */
+        template <class TimestampPolicy, class SizePolicy>
+        bool nextRange(TypedBlockIterator<TimestampPolicy, SizePolicy>& begin, TypedBlockIterator<TimestampPolicy, SizePolicy>& end)
+        {
+            if (m_advance_pending)
+            {
+                resumeAdvance();
+            }
+            while (valid() && m_current_iterator.layout() == SampleLayout::GAP)
+            {
+                getNextBlock();
+            }
+            if (!valid())
+            {
+                return false;
+            }
+            const auto& block_end = m_blocks_ranges[m_block_index].second;
+            begin = TypedBlockIterator<TimestampPolicy, SizePolicy>(m_current_iterator);
+            end = TypedBlockIterator<TimestampPolicy, SizePolicy>(block_end);
+            m_current_iterator = block_end;
+            finishBlock();
+            return true;
+        }
+
+        /**
+         * Layout of the samples of the channel, used to select the matching TypedBlockIterator once
+         * GAP if the iterator has not been set up by a StreamReader
+         */
+        ODK_NODISCARD inline SampleLayout sampleLayout() const noexcept
+        {
+            return m_sample_layout;
+        }
+
+        void setSampleLayout(SampleLayout layout) noexcept;
+
+        /**
+         * Steps back one sample
+         * Samples with dynamic size are stepped back using an offset table of the current block,
+         * which is built on the first step back into that block.
+         */
         inline StreamIterator& operator--()
         {
             ODK_ASSERT(valid());
+            m_advance_pending = false;
             if (m_current_iterator == m_blocks_ranges[m_block_index].first)
             {
                 getPreviousBlock();
             }
-            --m_current_iterator;
+            if (!valid())
+            {
+                return *this;
+            }
+            if (m_current_iterator.sampleSizeData())
+            {
+                stepBackDynamicSize();
+            }
+            else
+            {
+                --m_current_iterator;
+            }
             return *this;
         }
 
@@ -94,21 +230,43 @@ namespace framework
         void setSignalGaps(bool enabled) noexcept;
         void setSkipGaps(bool enabled);
 
-        ODK_NODISCARD std::uint64_t getTotalSampleCount() const noexcept;
+        /**
+         * Number of samples in all ranges (gaps excluded)
+         */
+        ODK_NODISCARD inline std::uint64_t getTotalSampleCount() const noexcept
+        {
+            return m_total_sample_count;
+        }
 
         using BlockIteratorRange = std::pair<BlockIterator, BlockIterator>;
 
     private:
         void getNextBlock();
+        void finishBlock();
+        void resumeAdvance();
         void getPreviousBlock();
+        bool seekInBlock(std::size_t block_index, std::uint64_t timestamp);
+        void mergeGapRanges();
+        void rewind();
+        void stepBackDynamicSize();
+        void invalidateSampleOffsets() noexcept;
 
     private:
         std::vector<BlockIteratorRange> m_blocks_ranges;
+        /// gaps that are not part of m_blocks_ranges because they are skipped anyway
+        std::vector<BlockIteratorRange> m_gap_ranges;
         int m_block_index;
+        std::uint64_t m_total_sample_count;
+        /// byte offsets of the samples of block m_sample_offsets_block, used to step back samples with dynamic size
+        std::vector<std::uint64_t> m_sample_offsets;
+        int m_sample_offsets_block;
         BlockIterator m_current_iterator;
         IfIteratorUpdater* m_data_requester;
+        /// the iterator is parked at the end of block m_block_index, set instead of requesting more data right away
+        bool m_advance_pending;
         bool m_signal_gaps;
         bool m_skip_gaps;
+        SampleLayout m_sample_layout;
     };
 
     class IfIteratorUpdater
@@ -7,8 +7,7 @@
 #include "odkuni_defines.h"
 
 #include <cstddef>
-#include <map>
-#include <set>
+#include <vector>
 
 namespace odk
 {
@@ -39,6 +38,15 @@ namespace framework
         void addDataBlock(const BlockDescriptor& block_descriptor, const void* data);
         void addDataBlock(BlockDescriptor&& block_descriptor, const void* data);
 
+        /**
+         * Decodes a BlockDescriptor telegram as delivered with an IfDataBlock and adds the block of data
+         * @return false if the descriptor could not be decoded or describes no channels
+         */
+        bool addDataBlock(const boost::string_view& block_descriptor_xml, const void* data);
+
+        /**
+         * Marks a region of a channel as valid, samples outside of all valid regions are reported as gaps
+         */
         void addDataRegion(const odk::DataRegion& region);
 
         /**
@@ -57,15 +65,53 @@ namespace framework
          */
         ODK_NODISCARD bool hasChannel(std::uint64_t channel_id) const;
 
-        void clearBlocks();
+        /**
+         * Removes all blocks and data regions
+         * Allocated storage is kept to be reused by the next blocks
+         */
+        void clearBlocks() noexcept;
 
     private:
+        /**
+         * Locates the samples of one channel inside one of the stored blocks
+         */
+        struct ChannelIndexEntry
+        {
+            std::uint32_t m_block;          ///< index into m_blocks
+            std::uint32_t m_block_channel;  ///< index into BlockDescriptor::m_block_channels
+        };
+
+        using ChannelKey = std::pair<std::uint64_t, std::uint64_t>; ///< stream id, channel id
+
         const ChannelDescriptor* getChannelDescriptor(std::uint64_t channel_id) const;
 
+        BlockDescriptor& nextBlockSlot();
+
+        /**
+         * Groups the block channels of all stored blocks by stream and channel
+         * after blocks have been added
+         */
+        void ensureChannelIndex() const;
+
+        std::uint32_t findOrInsertChannelKey(const ChannelKey& key) const;
+
         using BlockDescriptorData = std::tuple<BlockDescriptor, const void*>;
         StreamDescriptor m_stream_descriptor;
-        std::multimap<std::uint64_t, BlockDescriptorData> m_blocks;
-        std::map<std::uint64_t, std::set<odk::Interval<std::uint64_t>>> m_data_regions;
+        /// only the first m_block_count entries are in use, the others keep their allocations for reuse
+        std::vector<BlockDescriptorData> m_blocks;
+        std::size_t m_block_count = 0;
+        /// sorted by channel id and region
+        std::vector<odk::DataRegion> m_data_regions;
+        /// sorted by channel id, refers to m_stream_descriptor.m_channel_descriptors
+        std::vector<std::pair<std::uint64_t, std::size_t>> m_channel_descriptor_index;
+        /// sorted, distinct keys of all channels seen in blocks, kept across clearBlocks
+        mutable std::vector<ChannelKey> m_channel_keys;
+        /// m_channel_index[m_channel_offsets[k], m_channel_offsets[k + 1]) are the entries of m_channel_keys[k]
+        mutable std::vector<std::size_t> m_channel_offsets;
+        /// entries grouped by channel key, in block order within a group
+        mutable std::vector<ChannelIndexEntry> m_channel_index;
+        mutable std::vector<std::uint32_t> m_entry_keys;
+        mutable bool m_channel_index_valid = true;
     };
 }
 }
@@ -0,0 +1,189 @@
+// Copyright DEWETRON GmbH 2026
+#pragma once
+
+#include "odkfw_block_iterator.h"
+#include "odkuni_assert.h"
+#include "odkuni_defines.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace odk
+{
+namespace framework
+{
+    /// Timestamps are not stored, they increment by one with every sample (sync channels)
+    struct ImplicitTimestamp {};
+    /// Every sample stores its own timestamp (async channels)
+    struct ExplicitTimestamp {};
+    /// All samples have the size given by the channel descriptor
+    struct FixedSize {};
+    /// Every sample stores its own size
+    struct DynamicSize {};
+
+    /**
+     * BlockIterator specialised at compile time for one sample layout
+     * The layout is chosen once (@see StreamIterator::sampleLayout) so that stepping through a block
+     * does not need to check for timestamp or size fields on every sample.
+     */
+    template <class TimestampPolicy, class SizePolicy>
+    class TypedBlockIterator;
+
+    template <>
+    class TypedBlockIterator<ImplicitTimestamp, FixedSize>
+    {
+    public:
+        static constexpr SampleLayout LAYOUT = SampleLayout::IMPLICIT_TIMESTAMP;
+
+        TypedBlockIterator() noexcept = default;
+
+        TypedBlockIterator(const void* data, std::size_t data_stride, std::uint64_t timestamp) noexcept
+            : m_data(static_cast<const std::uint8_t*>(data))
+            , m_data_stride(data_stride)
+            , m_timestamp(timestamp)
+        {
+        }
+
+        explicit TypedBlockIterator(const BlockIterator& it) noexcept
+            : TypedBlockIterator(it.data(), it.dataStride(), it.timestamp())
+        {
+            ODK_ASSERT(it.layout() == LAYOUT);
+        }
+
+        ODK_NODISCARD inline const void* data() const noexcept { return m_data; }
+        ODK_NODISCARD inline std::uint64_t timestamp() const noexcept { return m_timestamp; }
+        ODK_NODISCARD inline std::size_t size() const noexcept { return 0; }
+
+        template <class SampleFormat>
+        ODK_NODISCARD inline const SampleFormat& value() const noexcept
+        {
+            return *reinterpret_cast<const SampleFormat*>(m_data);
+        }
+
+        inline TypedBlockIterator& operator++() noexcept
+        {
+            m_data += m_data_stride;
+            ++m_timestamp;
+            return *this;
+        }
+
+        ODK_NODISCARD inline bool operator==(const TypedBlockIterator& other) const noexcept { return m_data == other.m_data; }
+        ODK_NODISCARD inline bool operator!=(const TypedBlockIterator& other) const noexcept { return m_data != other.m_data; }
+
+    private:
+        const std::uint8_t* m_data = nullptr;
+        std::size_t m_data_stride = 0;
+        std::uint64_t m_timestamp = 0;
+    };
+
+    template <>
+    class TypedBlockIterator<ExplicitTimestamp, FixedSize>
+    {
+    public:
+        static constexpr SampleLayout LAYOUT = SampleLayout::EXPLICIT_TIMESTAMP;
+
+        TypedBlockIterator() noexcept = default;
+
+        TypedBlockIterator(const void* data, std::size_t data_stride, const std::uint64_t* timestamp, std::size_t timestamp_stride) noexcept
+            : m_data(static_cast<const std::uint8_t*>(data))
+            , m_data_stride(data_stride)
+            , m_timestamp(reinterpret_cast<const std::uint8_t*>(timestamp))
+            , m_timestamp_stride(timestamp_stride)
+        {
+        }
+
+        explicit TypedBlockIterator(const BlockIterator& it) noexcept
+            : TypedBlockIterator(it.data(), it.dataStride(), it.timestampData(), it.timestampStride())
+        {
+            ODK_ASSERT(it.layout() == LAYOUT);
+        }
+
+        ODK_NODISCARD inline const void* data() const noexcept { return m_data; }
+        ODK_NODISCARD inline std::uint64_t timestamp() const noexcept { return *reinterpret_cast<const std::uint64_t*>(m_timestamp); }
+        ODK_NODISCARD inline std::size_t size() const noexcept { return 0; }
+
+        template <class SampleFormat>
+        ODK_NODISCARD inline const SampleFormat& value() const noexcept
+        {
+            return *reinterpret_cast<const SampleFormat*>(m_data);
+        }
+
+        inline TypedBlockIterator& operator++() noexcept
+        {
+            m_data += m_data_stride;
+            m_timestamp += m_timestamp_stride;
+            return *this;
+        }
+
+        ODK_NODISCARD inline bool operator==(const TypedBlockIterator& other) const noexcept { return m_data == other.m_data; }
+        ODK_NODISCARD inline bool operator!=(const TypedBlockIterator& other) const noexcept { return m_data != other.m_data; }
+
+    private:
+        const std::uint8_t* m_data = nullptr;
+        std::size_t m_data_stride = 0;
+        const std::uint8_t* m_timestamp = nullptr;
+        std::size_t m_timestamp_stride = 0;
+    };
+
+    template <>
+    class TypedBlockIterator<ExplicitTimestamp, DynamicSize>
+    {
+    public:
+        static constexpr SampleLayout LAYOUT = SampleLayout::EXPLICIT_TIMESTAMP_DYNAMIC_SIZE;
+
+        TypedBlockIterator() noexcept = default;
+
+        TypedBlockIterator(const void* data, std::size_t data_stride,
+                           const std::uint64_t* timestamp, std::size_t timestamp_stride,
+                           const std::uint32_t* sample_size, std::size_t sample_size_stride) noexcept
+            : m_data(static_cast<const std::uint8_t*>(data))
+            , m_data_stride(data_stride)
+            , m_timestamp(reinterpret_cast<const std::uint8_t*>(timestamp))
+            , m_timestamp_stride(timestamp_stride)
+            , m_sample_size(reinterpret_cast<const std::uint8_t*>(sample_size))
+            , m_sample_size_stride(sample_size_stride)
+        {
+        }
+
+        explicit TypedBlockIterator(const BlockIterator& it) noexcept
+            : TypedBlockIterator(it.data(), it.dataStride(), it.timestampData(), it.timestampStride(), it.sampleSizeData(), it.sampleSizeStride())
+        {
+            ODK_ASSERT(it.layout() == LAYOUT);
+        }
+
+        ODK_NODISCARD inline const void* data() const noexcept { return m_data; }
+        ODK_NODISCARD inline std::uint64_t timestamp() const noexcept { return *reinterpret_cast<const std::uint64_t*>(m_timestamp); }
+        ODK_NODISCARD inline std::size_t size() const noexcept { return *reinterpret_cast<const std::uint32_t*>(m_sample_size); }
+
+        template <class SampleFormat>
+        ODK_NODISCARD inline const SampleFormat& value() const noexcept
+        {
+            return *reinterpret_cast<const SampleFormat*>(m_data);
+        }
+
+        inline TypedBlockIterator& operator++() noexcept
+        {
+            const std::size_t sample_size = size();
+            m_data += m_data_stride + sample_size;
+            m_timestamp += m_timestamp_stride + sample_size;
+            m_sample_size += m_sample_size_stride + sample_size;
+            return *this;
+        }
+
+        ODK_NODISCARD inline bool operator==(const TypedBlockIterator& other) const noexcept { return m_data == other.m_data; }
+        ODK_NODISCARD inline bool operator!=(const TypedBlockIterator& other) const noexcept { return m_data != other.m_data; }
+
+    private:
+        const std::uint8_t* m_data = nullptr;
+        std::size_t m_data_stride = 0;
+        const std::uint8_t* m_timestamp = nullptr;
+        std::size_t m_timestamp_stride = 0;
+        const std::uint8_t* m_sample_size = nullptr;
+        std::size_t m_sample_size_stride = 0;
+    };
+
+    using SyncBlockIterator = TypedBlockIterator<ImplicitTimestamp, FixedSize>;
+    using AsyncBlockIterator = TypedBlockIterator<ExplicitTimestamp, FixedSize>;
+    using AsyncDynamicBlockIterator = TypedBlockIterator<ExplicitTimestamp, DynamicSize>;
+}
+}
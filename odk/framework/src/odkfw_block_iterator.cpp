@@ -1,6 +1,8 @@
 // Copyright DEWETRON GmbH 2017
 
 #include "odkfw_block_iterator.h"
+
+#include <algorithm>
 #include <stdexcept>
 
 namespace odk
@@ -114,6 +116,85 @@ namespace framework
         return *this;
     }
 
+    BlockIterator& BlockIterator::stepBack(std::size_t previous_sample_size) noexcept
+    {
+        if (m_data)
+        {
+            m_data = reinterpret_cast<const std::uint8_t*>(m_data) - m_data_stride - previous_sample_size;
+        }
+
+        if (m_timestamp)
+        {
+            m_timestamp = reinterpret_cast<const std::uint64_t*>(
+                reinterpret_cast<const std::uint8_t*>(m_timestamp) - m_timestamp_stride - previous_sample_size);
+        }
+        else
+        {
+            --m_timestamp_value;
+        }
+
+        if (m_sample_size)
+        {
+            m_sample_size = reinterpret_cast<const std::uint32_t*>(
+                reinterpret_cast<const std::uint8_t*>(m_sample_size) - m_sample_size_stride - previous_sample_size);
+        }
+        return *this;
+    }
+
+    BlockIterator& BlockIterator::operator+=(std::uint64_t count)
+    {
+        if (m_sample_size)
+        {
+            for (; count > 0; --count)
+            {
+                ++(*this);
+            }
+            return *this;
+        }
+
+        const auto bytes = count * m_data_stride;
+        if (m_data)
+        {
+            m_data = reinterpret_cast<const std::uint8_t*>(m_data) + bytes;
+        }
+
+        if (m_timestamp)
+        {
+            m_timestamp = reinterpret_cast<const std::uint64_t*>(
+                reinterpret_cast<const std::uint8_t*>(m_timestamp) + bytes);
+        }
+        else
+        {
+            m_timestamp_value += count;
+        }
+        return *this;
+    }
+
+    SampleSpan BlockIterator::spanTo(const BlockIterator& end, std::uint64_t max_count) const noexcept
+    {
+        SampleSpan span;
+        span.m_data = m_data;
+        span.m_stride = m_data_stride;
+        span.m_timestamp = timestamp();
+        span.m_timestamps = m_timestamp;
+
+        if (!m_data)
+        {
+            const auto end_timestamp = end.timestamp();
+            span.m_count = end_timestamp > span.m_timestamp ? end_timestamp - span.m_timestamp : 0;
+        }
+        else if (m_sample_size)
+        {
+            span.m_count = *this != end ? 1 : 0;
+        }
+        else
+        {
+            span.m_count = distanceTo(end);
+        }
+        span.m_count = std::min(span.m_count, max_count);
+        return span;
+    }
+
     std::uint64_t BlockIterator::distanceTo(const BlockIterator& other) const noexcept
     {
         auto end_pos = reinterpret_cast<const std::uint8_t*>(other.m_data);
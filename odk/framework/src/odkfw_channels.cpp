@@ -38,6 +38,7 @@ namespace framework
     PluginChannel::PluginChannel(std::uint32_t local_id, IfPluginChannelChangeListener* change_listener, odk::IfHost* host)
         : m_change_listener(change_listener)
         , m_host(host)
+        , m_sample_writer(host)
     {
         ODK_ASSERT(m_host);
         m_channel_info.m_local_id = local_id;
@@ -56,6 +57,26 @@ namespace framework
         return m_channel_info.m_local_id;
     }
 
+    void PluginChannel::addSample(std::uint64_t timestamp, const void* data, std::size_t data_size)
+    {
+        m_sample_writer.addSample(getLocalId(), timestamp, data, data_size);
+    }
+
+    void PluginChannel::addSamples(std::uint64_t timestamp, const void* data, std::size_t sample_size, std::size_t sample_count)
+    {
+        m_sample_writer.addSamples(getLocalId(), timestamp, data, sample_size, sample_count);
+    }
+
+    std::uint64_t PluginChannel::flushSamples()
+    {
+        return m_sample_writer.flush();
+    }
+
+    void PluginChannel::clearSamples() noexcept
+    {
+        m_sample_writer.clear();
+    }
+
     PluginChannel& PluginChannel::setSampleFormat(
         odk::ChannelDataformat::SampleOccurrence occurrence, odk::ChannelDataformat::SampleFormat format, std::uint32_t dimension)
     {
@@ -3,6 +3,15 @@
 #include "odkfw_data_requester.h"
 #include "odkapi_oxygen_queries.h"
 #include "odkapi_channel_dataformat_xml.h"
+#include "odkapi_timebase_xml.h"
+#include "odkapi_utils.h"
+#include "odkuni_assert.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <pugixml.hpp>
 
 namespace odk
 {
@@ -10,18 +19,64 @@ namespace framework
 {
     uint64_t DataRequestIDManager::m_next_id = 0;
 
+    constexpr double DataRequester::MIN_WINDOW_LENGTH;
+    constexpr double DataRequester::MAX_WINDOW_LENGTH;
+    constexpr std::uint64_t DataRequester::DEFAULT_WINDOW_BYTES;
+
+    DataRequester::ChannelUpdater::ChannelUpdater(DataRequester& requester, std::uint64_t channel_id, std::size_t stream_index)
+        : m_requester(requester)
+        , m_channel_id(channel_id)
+        , m_stream_index(stream_index)
+        , m_frequency(0)
+        , m_next_window(0)
+        , m_iterator(std::make_shared<StreamIterator>())
+    {
+        m_iterator->setDataRequester(this);
+    }
+
+    void DataRequester::ChannelUpdater::updateStreamIterator(StreamIterator* iterator)
+    {
+        ODK_UNUSED(iterator);
+        ODK_ASSERT(iterator == m_iterator.get());
+        m_requester.advance(*this);
+    }
+
     DataRequester::DataRequester(IfHost *host, uint64_t channel_id, bool user_reduced)
+        : DataRequester(host, std::vector<std::uint64_t>(1, channel_id), user_reduced)
+    {
+    }
+
+    DataRequester::DataRequester(IfHost *host, std::vector<std::uint64_t> channel_ids, bool user_reduced)
         : m_host(host)
         , m_current_position(-1)
-        , m_channel_id(channel_id)
+        , m_end_position(-1)
+        , m_channel_ids(std::move(channel_ids))
+        , m_first_window(0)
+        , m_consumer_generation(0)
+        , m_window_begin(-1)
         , m_is_single_value(false)
         , m_user_reduced(user_reduced)
+        , m_prefetch_windows(0)
+        , m_window_bytes(DEFAULT_WINDOW_BYTES)
+        , m_nominal_data_rate(0)
+        , m_prefetch_start(-1)
+        , m_prefetch_position(-1)
+        , m_prefetch_end(-1)
+        , m_has_next_interval(false)
+        , m_next_start(-1)
+        , m_next_end(-1)
+        , m_prefetch_generation(0)
+        , m_prefetch_in_flight(false)
+        , m_stop_prefetch(false)
     {
         setupDataRequest();
     }
 
     DataRequester::~DataRequester()
     {
+        // no DATA_READ may be issued once the data set is removed
+        stopPrefetch();
+
         auto msg = m_host->createValue<odk::IfUIntValue>();
         msg->set(m_dataset_descriptor.m_id);
         m_host->messageSync(odk::host_msg::DATA_GROUP_REMOVE, 0, msg.get(), nullptr);
@@ -34,7 +89,7 @@ namespace framework
         request.m_data_set_type = DataSetType::SCALED;
         request.m_data_mode = m_user_reduced ? DataSetMode::REDUCED : DataSetMode::NORMAL;
         request.m_policy = StreamPolicy::EXACT;
-        request.m_channels.push_back(m_channel_id);
+        request.m_channels = m_channel_ids;
 
         auto xml_msg = m_host->createValue<odk::IfXMLValue>();
         if (!xml_msg)
@@ -55,131 +110,632 @@ namespace framework
             m_dataset_descriptor.parse(group_add_result->asStringView());
         }
 
-        if (m_dataset_descriptor.m_stream_descriptors.size() == 1)
+        // iterators are provided for the requested channels that are part of the data set
+        m_windows.clear();
+        m_channels.clear();
+        for (const auto channel_id : m_channel_ids)
         {
-            m_stream_reader.setStreamDescriptor(m_dataset_descriptor.m_stream_descriptors.at(0));
+            for (std::size_t stream_index = 0; stream_index < m_dataset_descriptor.m_stream_descriptors.size(); ++stream_index)
+            {
+                const auto& channel_descriptors = m_dataset_descriptor.m_stream_descriptors[stream_index].m_channel_descriptors;
+                if (std::any_of(channel_descriptors.begin(), channel_descriptors.end(),
+                    [channel_id](const ChannelDescriptor& channel_descriptor)
+                    {
+                        return channel_descriptor.m_channel_id == channel_id;
+                    }))
+                {
+                    m_channels.push_back(std::make_unique<ChannelUpdater>(*this, channel_id, stream_index));
+                    break;
+                }
+            }
         }
 
-        std::string channel_context = odk::queries::OxygenChannels + ("#" + std::to_string(m_channel_id));
-        auto data_format_xml = m_host->getValue<IfXMLValue>(channel_context.c_str(), "DataFormat");
-        odk::ChannelDataformat dataformat;
-        if (dataformat.parse(data_format_xml->asStringView()))
+        // reduced data is delivered at its own rate, the first windows measure it
+        m_is_single_value = !m_channel_ids.empty();
+        m_nominal_data_rate = 0;
+        for (const auto channel_id : m_channel_ids)
         {
-            m_is_single_value = dataformat.m_sample_occurrence == odk::ChannelDataformat::SampleOccurrence::SINGLE_VALUE;
+            std::string channel_context = odk::queries::OxygenChannels + ("#" + std::to_string(channel_id));
+            auto data_format_xml = m_host->getValue<IfXMLValue>(channel_context.c_str(), "DataFormat");
+            odk::ChannelDataformat dataformat;
+            if (data_format_xml && dataformat.parse(data_format_xml->asStringView()))
+            {
+                m_is_single_value = m_is_single_value && dataformat.m_sample_occurrence == odk::ChannelDataformat::SampleOccurrence::SINGLE_VALUE;
+            }
+            else
+            {
+                m_is_single_value = false;
+            }
+
+            const auto channel = std::find_if(m_channels.begin(), m_channels.end(),
+                [channel_id](const std::unique_ptr<ChannelUpdater>& updater)
+                {
+                    return updater->m_channel_id == channel_id;
+                });
+            if (channel == m_channels.end())
+            {
+                continue;
+            }
+            auto timebase_xml = m_host->getValue<IfXMLValue>(channel_context.c_str(), "Timebase");
+            pugi::xml_document doc;
+            odk::Timebase timebase;
+            if (timebase_xml && doc.load_string(timebase_xml->getValue()) && timebase.extract(doc)
+                && timebase.m_type == odk::Timebase::TimebaseType::SIMPLE && timebase.m_frequency > 0)
+            {
+                (*channel)->m_frequency = timebase.m_frequency;
+                if (m_user_reduced)
+                {
+                    continue;
+                }
+                for (const auto& channel_descriptor : m_dataset_descriptor.m_stream_descriptors[(*channel)->m_stream_index].m_channel_descriptors)
+                {
+                    if (channel_descriptor.m_channel_id == channel_id)
+                    {
+                        m_nominal_data_rate += timebase.m_frequency * channel_descriptor.m_stride / 8.0;
+                        break;
+                    }
+                }
+            }
         }
+
+        std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+        // windows keep the stream descriptors of the previous data set
+        m_free_windows.clear();
+        resetWindowLength();
     }
 
-    void DataRequester::fetchMoreData()
+    void DataRequester::setWindowByteBudget(std::uint64_t bytes)
     {
-        m_stream_reader.clearBlocks();
-        m_data_block_list.reset();
+        ODK_ASSERT(bytes > 0);
+        std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+        m_window_bytes = bytes;
+        resetWindowLength();
+    }
 
-        while(m_current_position != m_end_position
-              && (!m_data_block_list || m_data_block_list->getBlockCount() == 0))
+    DataRequester::Statistics DataRequester::getStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+        return m_statistics;
+    }
+
+    double DataRequester::getWindowEnd(double start, double end) const noexcept
+    {
+        return std::min(start + m_statistics.m_window_length, end);
+    }
+
+    void DataRequester::resetWindowLength() noexcept
+    {
+        m_statistics.m_window_length = m_nominal_data_rate > 0 ? m_window_bytes / m_nominal_data_rate : BLOCK_LENGTH;
+        m_statistics.m_window_length = std::max(MIN_WINDOW_LENGTH, std::min(m_statistics.m_window_length, MAX_WINDOW_LENGTH));
+    }
+
+    void DataRequester::updateWindowLength(const Window& window, double start) noexcept
+    {
+        ++m_statistics.m_requests;
+        m_statistics.m_blocks += window.m_block_count;
+        m_statistics.m_bytes += window.m_bytes;
+
+        const double window_length = window.m_end - start;
+        if (window.m_bytes == 0)
         {
-            double next_position = std::min(m_current_position + BLOCK_LENGTH, m_end_position);
+            ++m_statistics.m_empty_requests;
+            // cross regions without data quickly
+            m_statistics.m_window_length *= 2;
+        }
+        else if (window_length > 0)
+        {
+            // windows only partially covered by data underestimate the rate, so grow at most by a factor of 2
+            const double observed_rate = window.m_bytes / window_length;
+            m_statistics.m_window_length = std::min(m_window_bytes / observed_rate, 2 * m_statistics.m_window_length);
+        }
+        m_statistics.m_window_length = std::max(MIN_WINDOW_LENGTH, std::min(m_statistics.m_window_length, MAX_WINDOW_LENGTH));
+    }
+
+    void DataRequester::setPrefetchWindows(std::size_t window_count)
+    {
+        ODK_ASSERT(!m_prefetch_thread.joinable());
+        m_prefetch_windows = window_count;
+    }
 
-            if (auto xml_msg = m_host->createValue<odk::IfXMLValue>())
+    bool DataRequester::readWindow(Window& window, double start, double end)
+    {
+        window.m_data_block_list.reset();
+        window.m_block_count = 0;
+        window.m_bytes = 0;
+        window.m_end = end;
+        window.m_valid = false;
+
+        if (auto xml_msg = m_host->createValue<odk::IfXMLValue>())
+        {
+            if (m_is_single_value)
             {
-                if (m_is_single_value)
-                {
-                    PluginDataRequest req(m_dataset_descriptor.m_id, odk::PluginDataRequest::SingleValue(std::numeric_limits<double>::max()));
-                    xml_msg->set(req.generate().c_str());
-                }
-                else
-                {
-                    PluginDataRequest req(m_dataset_descriptor.m_id, PluginDataRequest::DataWindow(m_current_position, next_position));
-                    xml_msg->set(req.generate().c_str());
-                }
+                PluginDataRequest req(m_dataset_descriptor.m_id, odk::PluginDataRequest::SingleValue(std::numeric_limits<double>::max()));
+                xml_msg->set(req.generate().c_str());
+            }
+            else
+            {
+                PluginDataRequest req(m_dataset_descriptor.m_id, PluginDataRequest::DataWindow(start, end));
+                xml_msg->set(req.generate().c_str());
+            }
+
+            const odk::IfValue* response = nullptr;
+            if (0 != m_host->messageSync(odk::host_msg::DATA_READ, 0, xml_msg.get(), &response))
+            {
+                return false;
+            }
+
+            window.m_data_block_list = odk::ptr(odk::value_cast<odk::IfDataBlockList>(response));
+        }
+        if (!window.m_data_block_list)
+        {
+            return false;
+        }
+
+        const auto block_count = window.m_data_block_list->getBlockCount();
 
-                const odk::IfValue* response = nullptr;
-                if (0 != m_host->messageSync(odk::host_msg::DATA_READ, 0, xml_msg.get(), &response))
+        auto block_list_descriptor_xml = odk::ptr(window.m_data_block_list->getBlockListDescription());
+        BlockListDescriptor list_descriptor;
+        list_descriptor.parse(block_list_descriptor_xml->asStringView());
+
+        for (int i = 0; i < block_count; ++i)
+        {
+            auto block = odk::ptr(window.m_data_block_list->getBlock(i));
+            auto block_descriptor_xml = odk::ptr(block->getBlockDescription());
+            bool added = false;
+            if (window.m_stream_readers.size() == 1)
+            {
+                // decoded in place so that the channel list of the slot is reused
+                added = window.m_stream_readers.front().addDataBlock(block_descriptor_xml->asStringView(), block->data());
+            }
+            else if (window.m_block_descriptor.parse(block_descriptor_xml->asStringView()))
+            {
+                for (std::size_t stream_index = 0; stream_index < window.m_stream_readers.size(); ++stream_index)
                 {
-                    return;
+                    if (m_dataset_descriptor.m_stream_descriptors[stream_index].m_stream_id == window.m_block_descriptor.m_stream_id)
+                    {
+                        window.m_stream_readers[stream_index].addDataBlock(window.m_block_descriptor, block->data());
+                        added = true;
+                        break;
+                    }
                 }
-
-                m_data_block_list = odk::ptr(odk::value_cast<odk::IfDataBlockList>(response));
-                m_current_position = next_position;
             }
+            if (added)
+            {
+                ++window.m_block_count;
+                window.m_bytes += static_cast<std::uint64_t>(block->dataSize());
+            }
+        }
+
+        window.m_valid = true;
+        return true;
+    }
 
-            const auto block_count = m_data_block_list->getBlockCount();
+    std::unique_ptr<DataRequester::Window> DataRequester::takeFreeWindow()
+    {
+        std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+        return takeFreeWindowLocked();
+    }
 
-            auto block_list_descriptor_xml = odk::ptr(m_data_block_list->getBlockListDescription());
-            BlockListDescriptor list_descriptor;
-            list_descriptor.parse(block_list_descriptor_xml->asStringView());
+    std::unique_ptr<DataRequester::Window> DataRequester::takeFreeWindowLocked()
+    {
+        if (m_free_windows.empty())
+        {
+            auto window = std::make_unique<Window>();
+            for (const auto& stream_descriptor : m_dataset_descriptor.m_stream_descriptors)
+            {
+                window->m_stream_readers.emplace_back(stream_descriptor);
+            }
+            return window;
+        }
+        auto window = std::move(m_free_windows.back());
+        m_free_windows.pop_back();
+        return window;
+    }
 
-            odk::framework::StreamReader stream_reader;
+    void DataRequester::recycleWindow(std::unique_ptr<Window> window)
+    {
+        if (window)
+        {
+            for (auto& stream_reader : window->m_stream_readers)
+            {
+                stream_reader.clearBlocks();
+            }
+            window->m_data_block_list.reset();
+            window->m_block_count = 0;
+            window->m_bytes = 0;
+            std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+            m_free_windows.push_back(std::move(window));
+        }
+    }
 
-            for (int i = 0; i < block_count; ++i)
+    bool DataRequester::fetchMoreData()
+    {
+        if (m_prefetch_thread.joinable())
+        {
+            return fetchPrefetchedData();
+        }
+
+        auto window = takeFreeWindow();
+        while (m_current_position != m_end_position)
+        {
+            double next_position;
+            {
+                std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+                next_position = getWindowEnd(m_current_position, m_end_position);
+            }
+            if (!readWindow(*window, m_current_position, next_position))
+            {
+                // like the prefetch thread, the interval is not continued after a failed request
+                m_current_position = m_end_position;
+                break;
+            }
             {
-                auto block = odk::ptr(m_data_block_list->getBlock(i));
-                auto block_descriptor_xml = odk::ptr(block->getBlockDescription());
+                std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+                updateWindowLength(*window, m_current_position);
+            }
+            m_current_position = next_position;
 
-                BlockDescriptor block_descriptor;
-                block_descriptor.parse(block_descriptor_xml->asStringView());
+            if (window->m_block_count != 0)
+            {
+                addWindow(std::move(window));
+                return true;
+            }
+        }
+        recycleWindow(std::move(window));
+        return addTailWindow();
+    }
 
-                if (!block_descriptor.m_block_channels.empty())
+    bool DataRequester::fetchPrefetchedData()
+    {
+        while (m_current_position != m_end_position)
+        {
+            std::unique_ptr<Window> window;
+            {
+                std::unique_lock<std::mutex> lock(m_prefetch_mutex);
+                m_prefetch_condition.wait(lock, [this]()
                 {
-                    m_stream_reader.addDataBlock(std::move(block_descriptor), block->data());
+                    return !m_ready_windows.empty() || m_prefetch_generation != m_consumer_generation
+                        || (!m_prefetch_in_flight && m_prefetch_position == m_prefetch_end);
+                });
+                // the windows of the next interval are kept for it
+                if (m_ready_windows.empty() || m_ready_windows.front()->m_generation != m_consumer_generation)
+                {
+                    break;
                 }
+                window = std::move(m_ready_windows.front());
+                m_ready_windows.pop_front();
+            }
+            // there is room for the next window now
+            m_prefetch_condition.notify_all();
+
+            if (!window->m_valid)
+            {
+                // the prefetch thread does not continue after a failed request
+                m_current_position = m_end_position;
+                recycleWindow(std::move(window));
+                break;
             }
+            m_current_position = window->m_end;
+
+            if (window->m_block_count != 0)
+            {
+                addWindow(std::move(window));
+                return true;
+            }
+            recycleWindow(std::move(window));
+        }
+        return addTailWindow();
+    }
+
+    void DataRequester::addWindow(std::unique_ptr<Window> window)
+    {
+        window->m_begin = m_window_begin;
+        m_window_begin = window->m_end;
+
+        for (const auto& channel : m_channels)
+        {
+            const auto ticks = getWindowTicks(*channel, *window);
+            if (ticks.m_begin >= ticks.m_end)
+            {
+                continue;
+            }
+            const auto channel_id = channel->m_channel_id;
+            // first region of the channel that ends inside of the window
+            auto region = std::lower_bound(m_data_regions.begin(), m_data_regions.end(), ticks.m_begin,
+                [channel_id](const odk::DataRegion& data_region, std::uint64_t tick)
+                {
+                    return data_region.m_channel_id < channel_id
+                        || (data_region.m_channel_id == channel_id && data_region.m_region.m_end <= tick);
+                });
+            auto& stream_reader = window->m_stream_readers[channel->m_stream_index];
+            for (; region != m_data_regions.end() && region->m_channel_id == channel_id && region->m_region.m_begin < ticks.m_end; ++region)
+            {
+                stream_reader.addDataRegion(*region);
+            }
+        }
+        m_windows.push_back(std::move(window));
+    }
+
+    bool DataRequester::addTailWindow()
+    {
+        if (m_is_single_value || m_window_begin < 0 || m_window_begin >= m_end_position)
+        {
+            return false;
+        }
+        auto window = takeFreeWindow();
+        window->m_end = m_end_position;
+        window->m_valid = true;
+        addWindow(std::move(window));
+        return true;
+    }
+
+    odk::Interval<std::uint64_t> DataRequester::getWindowTicks(const ChannelUpdater& channel, const Window& window) const
+    {
+        if (m_is_single_value || channel.m_frequency <= 0)
+        {
+            return odk::Interval<std::uint64_t>(0, 0);
+        }
+        return odk::Interval<std::uint64_t>(
+            odk::convertTimeToTickAtOrAfter(window.m_begin, channel.m_frequency),
+            odk::convertTimeToTickAtOrAfter(window.m_end, channel.m_frequency));
+    }
+
+    void DataRequester::readDataRegions(double start, double end)
+    {
+        m_data_regions.clear();
+        if (m_is_single_value)
+        {
+            return;
+        }
 
-            std::shared_ptr<odk::DataRegions> data_regions;
+        bool has_regions = false;
+        if (auto xml_msg = m_host->createValue<odk::IfXMLValue>())
+        {
+            PluginDataRegionsRequest req(m_dataset_descriptor.m_id);
+            req.m_data_window = PluginDataRegionsRequest::DataWindow(start, end);
+            xml_msg->set(req.generate().c_str());
+
+            const odk::IfValue* data_regions_result = nullptr;
+            m_host->messageSync(odk::host_msg::DATA_REGIONS_READ, 0, xml_msg.get(), &data_regions_result);
+            if (data_regions_result)
             {
-                auto xml_msg = m_host->createValue<odk::IfXMLValue>();
-                if (xml_msg)
+                const auto data_regions_result_xml = odk::value_cast<odk::IfXMLValue>(data_regions_result);
+                DataRegions data_regions;
+                if (data_regions_result_xml && data_regions.parse(data_regions_result_xml->asStringView()))
                 {
-                    PluginDataRegionsRequest req(m_dataset_descriptor.m_id);
-                    req.m_data_window = PluginDataRegionsRequest::DataWindow(m_current_position, next_position);
-                    xml_msg->set(req.generate().c_str());
+                    m_data_regions = std::move(data_regions.m_data_regions);
+                    has_regions = true;
                 }
+                data_regions_result->release();
+            }
+        }
 
-                const odk::IfValue* data_regions_result = nullptr;
-                m_host->messageSync(odk::host_msg::DATA_REGIONS_READ, 0, xml_msg.get(), &data_regions_result);
+        if (!has_regions)
+        {
+            // without region information all delivered data is valid
+            for (const auto& channel : m_channels)
+            {
+                m_data_regions.emplace_back(channel->m_channel_id, odk::Interval<std::uint64_t>(0, std::numeric_limits<std::uint64_t>::max()));
+            }
+        }
+        std::sort(m_data_regions.begin(), m_data_regions.end(),
+            [](const odk::DataRegion& lhs, const odk::DataRegion& rhs)
+            {
+                return lhs.m_channel_id < rhs.m_channel_id
+                    || (lhs.m_channel_id == rhs.m_channel_id && lhs.m_region.m_begin < rhs.m_region.m_begin);
+            });
+    }
+
+    void DataRequester::setNextInterval(double start, double end)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+            m_has_next_interval = true;
+            m_next_start = start;
+            m_next_end = end;
+        }
+        m_prefetch_condition.notify_all();
+    }
 
-                const odk::IfXMLValue* data_regions_result_xml = odk::value_cast<odk::IfXMLValue>(data_regions_result);
-                if (data_regions_result)
+    void DataRequester::restartPrefetch(double start, double end)
+    {
+        std::deque<std::unique_ptr<Window>> stale_windows;
+        {
+            std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+            if (m_prefetch_thread.joinable() && !m_has_next_interval && m_prefetch_generation != m_consumer_generation
+                && m_prefetch_start == start && m_prefetch_end == end)
+            {
+                // the prefetch thread has already moved on to the announced interval
+                m_consumer_generation = m_prefetch_generation;
+                while (!m_ready_windows.empty() && m_ready_windows.front()->m_generation != m_consumer_generation)
                 {
-                    if (data_regions_result_xml)
-                    {
-                        data_regions = std::make_shared<DataRegions>();
-                        data_regions->parse(data_regions_result_xml->asStringView());
-                    }
-                    data_regions_result->release();
+                    stale_windows.push_back(std::move(m_ready_windows.front()));
+                    m_ready_windows.pop_front();
                 }
             }
+            else
+            {
+                ++m_prefetch_generation;
+                m_consumer_generation = m_prefetch_generation;
+                stale_windows.swap(m_ready_windows);
+                m_prefetch_start = start;
+                m_prefetch_position = start;
+                m_prefetch_end = end;
+            }
+            m_has_next_interval = false;
+        }
+        m_prefetch_condition.notify_all();
+        for (auto& window : stale_windows)
+        {
+            recycleWindow(std::move(window));
+        }
+
+        if (!m_prefetch_thread.joinable())
+        {
+            m_prefetch_thread = std::thread(&DataRequester::prefetchData, this);
+        }
+    }
+
+    void DataRequester::stopPrefetch()
+    {
+        if (m_prefetch_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+                m_stop_prefetch = true;
+            }
+            m_prefetch_condition.notify_all();
+            m_prefetch_thread.join();
+        }
+    }
+
+    void DataRequester::prefetchData()
+    {
+        std::unique_lock<std::mutex> lock(m_prefetch_mutex);
+        for (;;)
+        {
+            m_prefetch_condition.wait(lock, [this]()
+            {
+                return m_stop_prefetch || (m_prefetch_position == m_prefetch_end && m_has_next_interval)
+                    || (m_prefetch_position != m_prefetch_end && m_ready_windows.size() < m_prefetch_windows);
+            });
+            if (m_stop_prefetch)
+            {
+                return;
+            }
+            if (m_prefetch_position == m_prefetch_end)
+            {
+                // the consumer takes the remaining windows of the current interval first
+                ++m_prefetch_generation;
+                m_prefetch_start = m_next_start;
+                m_prefetch_position = m_next_start;
+                m_prefetch_end = m_next_end;
+                m_has_next_interval = false;
+                m_prefetch_condition.notify_all();
+                continue;
+            }
+
+            auto window = takeFreeWindowLocked();
+            const auto generation = m_prefetch_generation;
+            const double start = m_prefetch_position;
+            const double end = getWindowEnd(start, m_prefetch_end);
+            m_prefetch_in_flight = true;
+            lock.unlock();
+
+            bool valid = false;
+            try
+            {
+                valid = readWindow(*window, start, end);
+            }
+            catch (const std::exception&)
+            {
+                // reported to the consumer as a failed request
+            }
 
-            if(data_regions)
+            lock.lock();
+            m_prefetch_in_flight = false;
+            if (valid)
             {
-                for(const auto& invalid_region : data_regions->m_data_regions)
+                updateWindowLength(*window, start);
+            }
+            if (generation == m_prefetch_generation)
+            {
+                window->m_generation = generation;
+                window->m_valid = valid;
+                m_prefetch_position = valid ? end : m_prefetch_end;
+                m_ready_windows.push_back(std::move(window));
+            }
+            else
+            {
+                // requested for a previous interval
+                lock.unlock();
+                recycleWindow(std::move(window));
+                lock.lock();
+            }
+            m_prefetch_condition.notify_all();
+        }
+    }
+
+    void DataRequester::advance(ChannelUpdater& channel)
+    {
+        std::lock_guard<std::mutex> lock(m_advance_mutex);
+        auto& iterator = *channel.m_iterator;
+        iterator.clearRanges();
+        // windows without samples of the channel are passed
+        while (!iterator.valid())
+        {
+            while (channel.m_next_window - m_first_window >= m_windows.size())
+            {
+                if (!fetchMoreData())
                 {
-                    stream_reader.addDataRegion(invalid_region);
+                    releaseConsumedWindows();
+                    return;
                 }
             }
+            auto& window = *m_windows[static_cast<std::size_t>(channel.m_next_window - m_first_window)];
+            ++channel.m_next_window;
+            window.m_stream_readers[channel.m_stream_index].updateStreamIterator(channel.m_channel_id, iterator, getWindowTicks(channel, window));
         }
+        releaseConsumedWindows();
     }
 
-    void DataRequester::updateStreamIterator(StreamIterator* iterator)
+    void DataRequester::releaseConsumedWindows()
     {
-        iterator->clearRanges();
-        if (m_current_position != m_end_position)
+        std::uint64_t next_window = std::numeric_limits<std::uint64_t>::max();
+        for (const auto& channel : m_channels)
         {
-            fetchMoreData();
-            m_stream_reader.updateStreamIterator(m_channel_id, *iterator, odk::Interval<std::uint64_t>(0, std::numeric_limits<std::uint64_t>::max()));
+            next_window = std::min(next_window, channel->m_next_window);
+        }
+        // the window before the next one is still iterated
+        while (!m_windows.empty() && m_first_window + 1 < next_window)
+        {
+            recycleWindow(std::move(m_windows.front()));
+            m_windows.pop_front();
+            ++m_first_window;
         }
     }
 
-    std::shared_ptr<StreamIterator> DataRequester::getIterator(double start, double end)
+    std::map<std::uint64_t, std::shared_ptr<StreamIterator>> DataRequester::getIterators(double start, double end)
     {
+        for (auto& channel : m_channels)
+        {
+            channel->m_iterator->clearRanges();
+            channel->m_next_window = 0;
+        }
+        for (auto& window : m_windows)
+        {
+            recycleWindow(std::move(window));
+        }
+        m_windows.clear();
+        m_first_window = 0;
+
         m_current_position = start;
         m_end_position = end;
-        fetchMoreData();
-        if(!m_iterator)
+        m_window_begin = start;
+        readDataRegions(start, end);
+        if (m_prefetch_windows > 0)
+        {
+            restartPrefetch(start, end);
+        }
+
+        std::map<std::uint64_t, std::shared_ptr<StreamIterator>> iterators;
+        for (auto& channel : m_channels)
+        {
+            advance(*channel);
+            iterators.emplace(channel->m_channel_id, channel->m_iterator);
+        }
+        return iterators;
+    }
+
+    std::shared_ptr<StreamIterator> DataRequester::getIterator(double start, double end)
+    {
+        const auto iterators = getIterators(start, end);
+        const auto iterator = m_channel_ids.empty() ? iterators.end() : iterators.find(m_channel_ids.front());
+        if (iterator == iterators.end())
         {
-            m_iterator = std::make_shared<StreamIterator>(m_stream_reader.createChannelIterator(m_channel_id));
-            m_iterator->setDataRequester(this);
+            throw std::runtime_error("Invalid channel ID");
         }
-        return m_iterator;
+        return iterator->second;
     }
 
 }
@@ -7,6 +7,17 @@
 #include "odkapi_error_codes.h"
 #include "odkapi_message_ids.h"
 #include "odkfw_data_requester.h"
+#include "odkuni_assert.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+
+namespace
+{
+    const std::size_t MAX_WORKER_THREADS = 64;
+}
 
 namespace odk
 {
@@ -14,6 +25,11 @@ namespace framework
 {
     ExportInstance::ExportInstance()
         : m_canceled(false)
+        , m_prefetch_windows(0)
+        , m_group_channels(false)
+        , m_worker_threads(1)
+        , m_task_progress_sum(0)
+        , m_reported_task_progress(0)
     {
     }
 
@@ -74,46 +90,69 @@ namespace framework
         {
             export_statistic = m_context.m_properties.m_custom_properties.getBool("STATISTIC");
         }
+        if (m_context.m_properties.m_custom_properties.containsProperty("WORKER_THREADS"))
+        {
+            // the user interface may send the count as signed integer
+            const auto unsigned_threads = m_context.m_properties.m_custom_properties.getUnsigned("WORKER_THREADS");
+            const auto signed_threads = m_context.m_properties.m_custom_properties.getSigned("WORKER_THREADS");
+            const std::uint64_t worker_threads = unsigned_threads != 0 ? unsigned_threads : static_cast<std::uint64_t>(std::max<std::int64_t>(signed_threads, 1));
+            m_worker_threads = static_cast<std::size_t>(std::min<std::uint64_t>(worker_threads, MAX_WORKER_THREADS));
+        }
 
+        // single values are requested differently, so they need a data set of their own
+        std::vector<std::uint64_t> sampled_channels;
+        std::vector<std::uint64_t> single_value_channels;
         for(const auto& channel_id : start_telegram.m_properties.m_channels)
         {
             auto new_input_channel = std::make_shared<InputChannel>(m_host, channel_id);
             new_input_channel->updateDataFormat();
             new_input_channel->updateTimeBase();
+            if (new_input_channel->getDataFormat().m_sample_occurrence == odk::ChannelDataformat::SampleOccurrence::SINGLE_VALUE)
+            {
+                single_value_channels.push_back(channel_id);
+            }
+            else
+            {
+                sampled_channels.push_back(channel_id);
+            }
             m_context.m_channels.emplace(channel_id, std::move(new_input_channel));
+        }
+        configureExport(m_context);
 
-            auto& first_interval = start_telegram.m_properties.m_export_intervals.front();
+        const auto add_requester = [this](const std::vector<std::uint64_t>& channel_ids, bool reduced,
+            std::vector<std::unique_ptr<DataRequester>>& requesters)
+        {
+            if (channel_ids.empty())
+            {
+                return;
+            }
+            if (m_group_channels)
+            {
+                // one data set for all channels, every window is read once for all of them
+                requesters.push_back(std::make_unique<DataRequester>(getHost(), channel_ids, reduced));
+                requesters.back()->setPrefetchWindows(m_prefetch_windows);
+                return;
+            }
+            // the windows of a channel are released as soon as its own iterator has passed them
+            for (const auto channel_id : channel_ids)
+            {
+                requesters.push_back(std::make_unique<DataRequester>(getHost(), channel_id, reduced));
+                requesters.back()->setPrefetchWindows(m_prefetch_windows);
+            }
+        };
 
+        for (const auto* channel_ids : { &sampled_channels, &single_value_channels })
+        {
             if (export_waveform)
             {
-                auto raw_requester = std::make_unique<DataRequester>(getHost(), channel_id);
-                try
-                {
-                    m_context.m_channel_iterators[channel_id] =
-                        raw_requester->getIterator(first_interval.m_begin, first_interval.m_end);
-                }
-                catch (const std::exception&)
-                {
-                    // no valid data
-                }
-                m_data_requester.push_back(std::move(raw_requester));
+                add_requester(*channel_ids, false, m_data_requester);
             }
-
             if (export_statistic)
             {
-                auto reduced_requester = std::make_unique<DataRequester>(getHost(), channel_id, true);
-                try
-                {
-                    m_context.m_reduced_channel_iterators[channel_id] =
-                        reduced_requester->getIterator(first_interval.m_begin, first_interval.m_end);
-                }
-                catch (const std::exception&)
-                {
-                    // no valid data
-                }
-                m_reduced_requester.push_back(std::move(reduced_requester));
+                add_requester(*channel_ids, true, m_reduced_requester);
             }
         }
+        requestInterval(0);
 
         auto exportFunction = [this]()
         {
@@ -140,6 +179,154 @@ namespace framework
         m_worker_thread = std::thread(exportFunction);
     }
 
+    void ExportInstance::requestInterval(std::size_t interval_index)
+    {
+        m_context.m_interval_index = interval_index;
+        const auto& intervals = m_context.m_properties.m_export_intervals;
+        if (interval_index >= intervals.size())
+        {
+            return;
+        }
+
+        const auto& interval = intervals[interval_index];
+        const auto request_data = [&intervals, &interval, interval_index](const std::vector<std::unique_ptr<DataRequester>>& requesters,
+            std::map<uint64_t, std::shared_ptr<StreamIterator>>& iterators)
+        {
+            for (const auto& requester : requesters)
+            {
+                try
+                {
+                    // channels without valid data get no iterator
+                    for (const auto& iterator : requester->getIterators(interval.m_begin, interval.m_end))
+                    {
+                        iterators[iterator.first] = iterator.second;
+                    }
+                }
+                catch (const std::exception&)
+                {
+                    // no valid data
+                }
+                if (interval_index + 1 < intervals.size())
+                {
+                    // prefetched while this interval is exported
+                    requester->setNextInterval(intervals[interval_index + 1].m_begin, intervals[interval_index + 1].m_end);
+                }
+            }
+        };
+        request_data(m_data_requester, m_context.m_channel_iterators);
+        request_data(m_reduced_requester, m_context.m_reduced_channel_iterators);
+    }
+
+    bool ExportInstance::nextExportInterval()
+    {
+        if (m_context.m_interval_index + 1 >= m_context.m_properties.m_export_intervals.size())
+        {
+            return false;
+        }
+        requestInterval(m_context.m_interval_index + 1);
+        return true;
+    }
+
+    void ExportInstance::runParallel(std::size_t task_count, const std::function<void(std::size_t)>& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_task_mutex);
+            m_task_progress.assign(task_count, 0.0);
+            m_task_progress_sum = 0;
+            m_reported_task_progress = 0;
+        }
+
+        std::atomic<std::size_t> next_task(0);
+        std::atomic<bool> failed(false);
+        std::mutex error_mutex;
+        std::exception_ptr first_error;
+        const auto work = [this, task_count, &task, &next_task, &failed, &error_mutex, &first_error]()
+        {
+            while (!failed.load(std::memory_order_acquire) && !isCanceled())
+            {
+                const auto task_index = next_task.fetch_add(1);
+                if (task_index >= task_count)
+                {
+                    return;
+                }
+                try
+                {
+                    task(task_index);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!first_error)
+                    {
+                        first_error = std::current_exception();
+                    }
+                    failed.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        const auto thread_count = std::min(std::max<std::size_t>(m_worker_threads, 1), task_count);
+        for (std::size_t thread_index = 1; thread_index < thread_count; ++thread_index)
+        {
+            try
+            {
+                workers.emplace_back(work);
+            }
+            catch (const std::system_error&)
+            {
+                // continue with the threads that could be started
+                break;
+            }
+        }
+        work();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+
+        if (first_error)
+        {
+            std::rethrow_exception(first_error);
+        }
+        if (isCanceled())
+        {
+            throw std::runtime_error("transaction cancelled");
+        }
+    }
+
+    void ExportInstance::notifyTaskProgress(std::size_t task_index, double progress)
+    {
+        if (isCanceled())
+        {
+            throw std::runtime_error("transaction cancelled");
+        }
+
+        std::lock_guard<std::mutex> lock(m_task_mutex);
+        ODK_ASSERT(task_index < m_task_progress.size());
+        progress = std::max(0.0, std::min(progress, 1.0));
+        m_task_progress_sum += progress - m_task_progress[task_index];
+        m_task_progress[task_index] = progress;
+
+        // the host is not notified for every small step of every task
+        const double interval_progress = m_task_progress_sum / static_cast<double>(m_task_progress.size());
+        if (interval_progress >= m_reported_task_progress + 0.01 || (interval_progress == 1.0 && m_reported_task_progress != 1.0))
+        {
+            m_reported_task_progress = interval_progress;
+            notifyIntervalProgress(interval_progress);
+        }
+    }
+
+    bool ExportInstance::isCanceled() const noexcept
+    {
+        return m_canceled.load(std::memory_order_acquire);
+    }
+
+    void ExportInstance::setWorkerThreads(std::size_t thread_count) noexcept
+    {
+        m_worker_threads = thread_count;
+    }
+
     void ExportInstance::setCanceled()
     {
         m_canceled.store(true, std::memory_order_release);
@@ -161,7 +348,7 @@ namespace framework
 
     void ExportInstance::notifyProgress(uint64_t progress) const
     {
-        if (m_canceled.load(std::memory_order_acquire))
+        if (isCanceled())
         {
             throw std::runtime_error("transaction cancelled");
         }
@@ -171,6 +358,71 @@ namespace framework
         m_host->messageSync(odk::host_msg::EXPORT_PROGRESS, m_telegram.m_transaction_id, p.get(), nullptr);
     }
 
+    void ExportInstance::notifyIntervalProgress(double interval_progress) const
+    {
+        const auto& intervals = m_context.m_properties.m_export_intervals;
+        if (intervals.empty())
+        {
+            notifyProgress(100);
+            return;
+        }
+        interval_progress = std::max(0.0, std::min(interval_progress, 1.0));
+
+        double total_length = 0;
+        double exported_length = 0;
+        for (std::size_t interval_index = 0; interval_index < intervals.size(); ++interval_index)
+        {
+            const double length = std::max(0.0, intervals[interval_index].m_end - intervals[interval_index].m_begin);
+            total_length += length;
+            if (interval_index < m_context.m_interval_index)
+            {
+                exported_length += length;
+            }
+            else if (interval_index == m_context.m_interval_index)
+            {
+                exported_length += interval_progress * length;
+            }
+        }
+        const double progress = total_length > 0
+            ? exported_length / total_length
+            : (static_cast<double>(m_context.m_interval_index) + interval_progress) / static_cast<double>(intervals.size());
+        notifyProgress(static_cast<uint64_t>(100 * progress));
+    }
+
+    void ExportInstance::setPrefetchWindows(std::size_t window_count) noexcept
+    {
+        m_prefetch_windows = window_count;
+    }
+
+    void ExportInstance::setGroupChannels(bool enabled) noexcept
+    {
+        m_group_channels = enabled;
+    }
+
+    void ExportInstance::configureExport(const ValidationContext& context)
+    {
+        ODK_UNUSED(context);
+    }
+
+    bool ExportInstance::haveEqualSampleRates(const ValidationContext& context)
+    {
+        double sample_rate = 0;
+        for (const auto& channel : context.m_channels)
+        {
+            const double channel_rate = channel.second->getSampleRate().m_val;
+            if (!(channel_rate > 0))
+            {
+                continue;
+            }
+            if (sample_rate > 0 && channel_rate != sample_rate)
+            {
+                return false;
+            }
+            sample_rate = channel_rate;
+        }
+        return true;
+    }
+
     void ExportInstance::notifyDone() const
     {
         m_host->messageSync(odk::host_msg::EXPORT_FINISHED, m_telegram.m_transaction_id, nullptr, nullptr);
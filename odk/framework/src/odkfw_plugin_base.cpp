@@ -4,6 +4,12 @@
 #include "odkbase_basic_values.h"
 #include "odkbase_if_host.h"
 #include "odkbase_message_return_value_holder.h"
+#include "odkuni_xpugixml.h"
+
+void odk::framework::PluginBase::installXmlMemoryCache()
+{
+    xpugi::installMemoryCache();
+}
 
 std::uint64_t PLUGIN_API odk::framework::PluginBase::pluginMessage(odk::PluginMessageId id, std::uint64_t key, const odk::IfValue* param, const odk::IfValue** ret)
 {
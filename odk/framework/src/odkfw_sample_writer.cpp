@@ -0,0 +1,172 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkfw_sample_writer.h"
+#include "odkapi_error_codes.h"
+#include "odkapi_message_ids.h"
+#include "odkbase_if_host.h"
+#include "odkuni_assert.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace odk
+{
+namespace framework
+{
+    void SampleWriter::StagingBuffer::append(const void* data, std::size_t size)
+    {
+        if (m_size + size > m_storage.size())
+        {
+            m_storage.resize(std::max(m_size + size, 2 * m_storage.size()));
+        }
+        if (size > 0)
+        {
+            std::memcpy(m_storage.data() + m_size, data, size);
+        }
+        m_size += size;
+    }
+
+    SampleWriter::SampleWriter(odk::IfHost* host)
+        : m_host(host)
+        , m_last_channel_buffer(0)
+    {
+    }
+
+    void SampleWriter::setHost(odk::IfHost* host) noexcept
+    {
+        m_host = host;
+    }
+
+    void SampleWriter::addSample(std::uint32_t local_channel_id, std::uint64_t timestamp, const void* data, std::size_t data_size)
+    {
+        auto& buffer = getChannelBuffer(local_channel_id);
+        if (buffer.m_contiguous_sample_count > 0)
+        {
+            flushContiguousSamples(buffer);
+        }
+
+        buffer.m_samples.append(&timestamp, sizeof(timestamp));
+        buffer.m_samples.append(data, data_size);
+        buffer.m_sample_ends.push_back(buffer.m_samples.m_size);
+    }
+
+    void SampleWriter::addSamples(std::uint32_t local_channel_id, std::uint64_t timestamp, const void* data, std::size_t sample_size, std::size_t sample_count)
+    {
+        if (sample_count == 0)
+        {
+            return;
+        }
+
+        auto& buffer = getChannelBuffer(local_channel_id);
+        if (!buffer.m_sample_ends.empty())
+        {
+            flushSamples(buffer);
+        }
+        if (buffer.m_contiguous_sample_count > 0 && buffer.m_next_timestamp != timestamp)
+        {
+            flushContiguousSamples(buffer);
+        }
+
+        if (buffer.m_contiguous_sample_count == 0)
+        {
+            buffer.m_contiguous_samples.append(&timestamp, sizeof(timestamp));
+        }
+        buffer.m_contiguous_samples.append(data, sample_size * sample_count);
+        buffer.m_contiguous_sample_count += sample_count;
+        buffer.m_next_timestamp = timestamp + sample_count;
+    }
+
+    std::uint64_t SampleWriter::flush()
+    {
+        std::uint64_t result = odk::error_codes::OK;
+        for (auto& buffer : m_channel_buffers)
+        {
+            const auto contiguous_result = flushContiguousSamples(buffer);
+            const auto samples_result = flushSamples(buffer);
+            if (result == odk::error_codes::OK)
+            {
+                result = contiguous_result != odk::error_codes::OK ? contiguous_result : samples_result;
+            }
+        }
+        return result;
+    }
+
+    void SampleWriter::clear() noexcept
+    {
+        for (auto& buffer : m_channel_buffers)
+        {
+            buffer.m_contiguous_samples.m_size = 0;
+            buffer.m_contiguous_sample_count = 0;
+            buffer.m_samples.m_size = 0;
+            buffer.m_sample_ends.clear();
+        }
+    }
+
+    std::size_t SampleWriter::getPendingSampleCount() const noexcept
+    {
+        std::size_t count = 0;
+        for (const auto& buffer : m_channel_buffers)
+        {
+            count += buffer.m_contiguous_sample_count + buffer.m_sample_ends.size();
+        }
+        return count;
+    }
+
+    SampleWriter::ChannelBuffer& SampleWriter::getChannelBuffer(std::uint32_t local_channel_id)
+    {
+        // samples are usually added for the same few channels over and over
+        if (m_last_channel_buffer < m_channel_buffers.size() && m_channel_buffers[m_last_channel_buffer].m_local_channel_id == local_channel_id)
+        {
+            return m_channel_buffers[m_last_channel_buffer];
+        }
+
+        auto buffer = std::lower_bound(m_channel_buffers.begin(), m_channel_buffers.end(), local_channel_id,
+            [](const ChannelBuffer& channel_buffer, std::uint32_t id)
+            {
+                return channel_buffer.m_local_channel_id < id;
+            });
+        if (buffer == m_channel_buffers.end() || buffer->m_local_channel_id != local_channel_id)
+        {
+            buffer = m_channel_buffers.emplace(buffer);
+            buffer->m_local_channel_id = local_channel_id;
+        }
+        m_last_channel_buffer = static_cast<std::size_t>(buffer - m_channel_buffers.begin());
+        return *buffer;
+    }
+
+    std::uint64_t SampleWriter::flushContiguousSamples(ChannelBuffer& buffer)
+    {
+        if (buffer.m_contiguous_sample_count == 0)
+        {
+            return odk::error_codes::OK;
+        }
+
+        ODK_ASSERT(m_host);
+        const auto result = m_host->messageSyncData(odk::host_msg::ADD_CONTIGUOUS_SAMPLES, buffer.m_local_channel_id,
+            buffer.m_contiguous_samples.data(), buffer.m_contiguous_samples.m_size, nullptr);
+        buffer.m_contiguous_samples.m_size = 0;
+        buffer.m_contiguous_sample_count = 0;
+        return result;
+    }
+
+    std::uint64_t SampleWriter::flushSamples(ChannelBuffer& buffer)
+    {
+        std::uint64_t result = odk::error_codes::OK;
+        std::size_t sample_begin = 0;
+        for (const auto sample_end : buffer.m_sample_ends)
+        {
+            ODK_ASSERT(m_host);
+            const auto sample_result = m_host->messageSyncData(odk::host_msg::ADD_SAMPLE, buffer.m_local_channel_id,
+                buffer.m_samples.data() + sample_begin, sample_end - sample_begin, nullptr);
+            if (result == odk::error_codes::OK)
+            {
+                result = sample_result;
+            }
+            sample_begin = sample_end;
+        }
+        buffer.m_samples.m_size = 0;
+        buffer.m_sample_ends.clear();
+        return result;
+    }
+}
+}
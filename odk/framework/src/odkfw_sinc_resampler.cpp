@@ -0,0 +1,179 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkfw_sinc_resampler.h"
+#include "odkuni_assert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+using odk::framework::SincResampler;
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    inline double sinc(double x)
+    {
+        return x == 0 ? 1.0 : std::sin(PI * x) / (PI * x);
+    }
+
+    /// Blackman window for |x| <= 1
+    inline double blackman(double x)
+    {
+        return 0.42 + 0.5 * std::cos(PI * x) + 0.08 * std::cos(2 * PI * x);
+    }
+
+    std::shared_ptr<const std::vector<double>> createKernel(double cutoff, std::size_t half_width)
+    {
+        const std::size_t taps = 2 * half_width;
+        auto kernel = std::make_shared<std::vector<double>>((SincResampler::PHASE_COUNT + 1) * taps);
+        for (std::size_t phase = 0; phase <= SincResampler::PHASE_COUNT; ++phase)
+        {
+            double* const row = &(*kernel)[phase * taps];
+            const double fraction = static_cast<double>(phase) / SincResampler::PHASE_COUNT;
+            double sum = 0;
+            for (std::size_t tap = 0; tap < taps; ++tap)
+            {
+                // distance of the output sample from input sample (first + tap)
+                const double distance = fraction + static_cast<double>(half_width) - 1 - static_cast<double>(tap);
+                const double position = distance / static_cast<double>(half_width);
+                row[tap] = std::abs(position) < 1 ? cutoff * sinc(cutoff * distance) * blackman(position) : 0;
+                sum += row[tap];
+            }
+            // unity gain for constant signals in every phase
+            for (std::size_t tap = 0; tap < taps; ++tap)
+            {
+                row[tap] /= sum;
+            }
+        }
+        return kernel;
+    }
+
+    /**
+     * Returns the kernel of a live resampler with the same parameters or creates a new one.
+     * The cache only observes the kernels, they are freed with the last resampler using them.
+     */
+    std::shared_ptr<const std::vector<double>> sharedKernel(double cutoff, std::size_t half_width)
+    {
+        static std::mutex mutex;
+        static std::map<std::pair<double, std::size_t>, std::weak_ptr<const std::vector<double>>> kernels;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& cached = kernels[std::make_pair(cutoff, half_width)];
+        if (auto kernel = cached.lock())
+        {
+            return kernel;
+        }
+        for (auto it = kernels.begin(); it != kernels.end();)
+        {
+            it = (it->second.expired() && &it->second != &cached) ? kernels.erase(it) : std::next(it);
+        }
+        auto kernel = createKernel(cutoff, half_width);
+        cached = kernel;
+        return kernel;
+    }
+
+    inline double dotProduct(const double* a, const double* b, std::size_t count)
+    {
+        double sum = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+}
+
+const std::size_t SincResampler::DEFAULT_ZERO_CROSSINGS;
+const std::size_t SincResampler::MAX_HALF_WIDTH;
+const std::size_t SincResampler::PHASE_COUNT;
+
+SincResampler::SincResampler(double input_rate, double output_rate, std::size_t zero_crossings)
+    : m_input_rate(input_rate)
+    , m_output_rate(output_rate)
+    , m_step(0)
+    , m_half_width(0)
+    , m_output_index(0)
+    , m_input_offset(0)
+{
+    if (!(input_rate > 0) || !(output_rate > 0) || zero_crossings == 0)
+    {
+        throw std::invalid_argument("SincResampler requires positive sample rates");
+    }
+    m_step = input_rate / output_rate;
+
+    // relative to the input Nyquist frequency
+    const double cutoff = std::min(1.0, output_rate / input_rate);
+    m_half_width = std::min(MAX_HALF_WIDTH, static_cast<std::size_t>(std::ceil(static_cast<double>(zero_crossings) / cutoff)));
+    m_kernel = sharedKernel(cutoff, m_half_width);
+    reset();
+}
+
+void SincResampler::reset()
+{
+    m_output_index = 0;
+    m_input.assign(m_half_width - 1, 0.0);
+    m_input_offset = -static_cast<std::int64_t>(m_half_width - 1);
+}
+
+std::int64_t SincResampler::firstInput(std::uint64_t n) const
+{
+    return static_cast<std::int64_t>(std::floor(static_cast<double>(n) * m_step)) - static_cast<std::int64_t>(m_half_width) + 1;
+}
+
+std::size_t SincResampler::requiredInput(std::size_t num_output) const
+{
+    if (num_output == 0)
+    {
+        return 0;
+    }
+    const std::int64_t end = firstInput(m_output_index + num_output - 1) + static_cast<std::int64_t>(2 * m_half_width);
+    const std::int64_t available = m_input_offset + static_cast<std::int64_t>(m_input.size());
+    return end > available ? static_cast<std::size_t>(end - available) : 0;
+}
+
+void SincResampler::addInput(const double* data, std::size_t num_samples)
+{
+    // drops the samples no kernel will use anymore before the buffer grows
+    const std::int64_t first = firstInput(m_output_index);
+    if (first > m_input_offset && static_cast<std::size_t>(first - m_input_offset) >= m_input.size() / 2)
+    {
+        const std::size_t obsolete = std::min(m_input.size(), static_cast<std::size_t>(first - m_input_offset));
+        m_input.erase(m_input.begin(), m_input.begin() + static_cast<std::ptrdiff_t>(obsolete));
+        m_input_offset += static_cast<std::int64_t>(obsolete);
+    }
+    m_input.insert(m_input.end(), data, data + num_samples);
+}
+
+std::size_t SincResampler::process(double* output, std::size_t max_output)
+{
+    const std::size_t taps = 2 * m_half_width;
+    const std::vector<double>& kernel = *m_kernel;
+    const std::int64_t available = m_input_offset + static_cast<std::int64_t>(m_input.size());
+    std::size_t count = 0;
+    for (; count < max_output; ++count, ++m_output_index)
+    {
+        const double position = static_cast<double>(m_output_index) * m_step;
+        const double index = std::floor(position);
+        const std::int64_t first = static_cast<std::int64_t>(index) - static_cast<std::int64_t>(m_half_width) + 1;
+        if (first + static_cast<std::int64_t>(taps) > available)
+        {
+            break;
+        }
+        // addInput keeps everything from the first input of the next output sample
+        ODK_ASSERT(first >= m_input_offset);
+
+        const double phase = (position - index) * PHASE_COUNT;
+        const std::size_t row = std::min(static_cast<std::size_t>(phase), PHASE_COUNT - 1);
+        const double weight = phase - static_cast<double>(row);
+        const double* const input = &m_input[static_cast<std::size_t>(first - m_input_offset)];
+        const double lower = dotProduct(input, &kernel[row * taps], taps);
+        const double upper = dotProduct(input, &kernel[(row + 1) * taps], taps);
+        output[count] = lower + (upper - lower) * weight;
+    }
+    return count;
+}
@@ -16,7 +16,10 @@
 #include "odkfw_stream_reader.h"
 #include "odkuni_logger.h"
 #include "odkuni_assert.h"
+
+#include <algorithm>
 #include <limits>
+#include <tuple>
 
 namespace odk
 {
@@ -42,19 +45,10 @@ namespace framework
         const std::vector<odk::StreamDescriptor>& stream_descriptor,
         const odk::IfDataBlockList* block_list)
     {
-        odk::DataRegions data_regions;
-
-        for (const auto& sd : stream_descriptor)
-        {
-            for (auto& channel : sd.m_channel_descriptors)
-            {
-                data_regions.m_data_regions.push_back(DataRegion(channel.m_channel_id, odk::Interval<std::uint64_t>(0, std::numeric_limits<std::uint64_t>::max())));
-            }
-        }
-        return createChannelIterators(stream_descriptor,
-                                      block_list,
-                                      odk::Interval<double>(0, std::numeric_limits<double>::max()),
-                                      data_regions);
+        std::map<uint64_t, odk::framework::StreamIterator> iterators;
+        updateChannelIterators(iterators, stream_descriptor, block_list,
+                               odk::Interval<double>(0, std::numeric_limits<double>::max()), nullptr);
+        return iterators;
     }
 
     std::map<uint64_t, odk::framework::StreamIterator> SoftwareChannelInstance::createChannelIterators(
@@ -63,39 +57,104 @@ namespace framework
         const odk::Interval<double>& interval,
         const odk::DataRegions& data_regions)
     {
-
         std::map<uint64_t, odk::framework::StreamIterator> iterators;
+        updateChannelIterators(iterators, stream_descriptor, block_list, interval, &data_regions);
+        return iterators;
+    }
 
-        auto block_list_descriptor_xml = odk::ptr(block_list->getBlockListDescription());
-        BlockListDescriptor list_descriptor;
-        list_descriptor.parse(block_list_descriptor_xml->asStringView());
-
-        odk::framework::StreamReader stream_reader;
+    void SoftwareChannelInstance::updateChannelIterators(
+        std::map<uint64_t, odk::framework::StreamIterator>& iterators,
+        const std::vector<odk::StreamDescriptor>& stream_descriptor,
+        const odk::IfDataBlockList* block_list,
+        const odk::Interval<double>& interval,
+        const odk::DataRegions* data_regions,
+        const std::vector<odk::DataRegion>* invalid_regions)
+    {
+        m_stream_reader.clearBlocks();
 
         const auto block_count = block_list->getBlockCount();
         for (int i = 0; i < block_count; ++i)
         {
             auto block = odk::ptr(block_list->getBlock(i));
             auto block_descriptor_xml = odk::ptr(block->getBlockDescription());
+            m_stream_reader.addDataBlock(block_descriptor_xml->asStringView(), block->data());
+        }
+
+        if (invalid_regions)
+        {
+            m_invalid_regions.assign(invalid_regions->begin(), invalid_regions->end());
+            std::sort(m_invalid_regions.begin(), m_invalid_regions.end(),
+                [](const odk::DataRegion& lhs, const odk::DataRegion& rhs)
+                {
+                    return std::tie(lhs.m_channel_id, lhs.m_region.m_begin) < std::tie(rhs.m_channel_id, rhs.m_region.m_begin);
+                });
+        }
 
-            BlockDescriptor block_descriptor;
-            block_descriptor.parse(block_descriptor_xml->asStringView());
+        for (const auto& sd : stream_descriptor)
+        {
+            if (invalid_regions)
+            {
+                // the valid regions are the gaps between the invalid ones
+                for (const auto& channel : sd.m_channel_descriptors)
+                {
+                    auto region = std::lower_bound(m_invalid_regions.cbegin(), m_invalid_regions.cend(), channel.m_channel_id,
+                        [](const odk::DataRegion& invalid_region, std::uint64_t id)
+                        {
+                            return invalid_region.m_channel_id < id;
+                        });
+                    std::uint64_t valid_begin = 0;
+                    for (; region != m_invalid_regions.cend() && region->m_channel_id == channel.m_channel_id; ++region)
+                    {
+                        if (region->m_region.m_begin > valid_begin)
+                        {
+                            m_stream_reader.addDataRegion(DataRegion(channel.m_channel_id, odk::Interval<std::uint64_t>(valid_begin, region->m_region.m_begin)));
+                        }
+                        valid_begin = std::max(valid_begin, region->m_region.m_end);
+                    }
+                    if (valid_begin < std::numeric_limits<std::uint64_t>::max())
+                    {
+                        m_stream_reader.addDataRegion(DataRegion(channel.m_channel_id, odk::Interval<std::uint64_t>(valid_begin, std::numeric_limits<std::uint64_t>::max())));
+                    }
+                }
+            }
+            else if (!data_regions)
+            {
+                // no region information available: all samples are valid
+                for (const auto& channel : sd.m_channel_descriptors)
+                {
+                    m_stream_reader.addDataRegion(DataRegion(channel.m_channel_id, odk::Interval<std::uint64_t>(0, std::numeric_limits<std::uint64_t>::max())));
+                }
+            }
+        }
 
-            if (!block_descriptor.m_block_channels.empty())
+        if (data_regions && !invalid_regions)
+        {
+            for (const auto& data_region : data_regions->m_data_regions)
             {
-                stream_reader.addDataBlock(std::move(block_descriptor), block->data());
+                m_stream_reader.addDataRegion(data_region);
             }
         }
 
-        for(const auto& data_region : data_regions.m_data_regions)
+        // drop iterators of channels that are no longer part of the data set,
+        // the data set may also have swapped channels without changing its size
+        for (auto it = iterators.begin(); it != iterators.end();)
         {
-            stream_reader.addDataRegion(data_region);
+            const bool requested = std::any_of(stream_descriptor.begin(), stream_descriptor.end(),
+                [&it](const odk::StreamDescriptor& sd)
+                {
+                    return std::any_of(sd.m_channel_descriptors.begin(), sd.m_channel_descriptors.end(),
+                        [&it](const odk::ChannelDescriptor& channel)
+                        {
+                            return channel.m_channel_id == it->first;
+                        });
+                });
+            it = requested ? std::next(it) : iterators.erase(it);
         }
 
-        // for every stream, create a reader on the data blocks and read the data
+        // for every stream, refresh the iterators on the data blocks
         for (const auto& sd : stream_descriptor)
         {
-            stream_reader.setStreamDescriptor(sd);
+            m_stream_reader.setStreamDescriptor(sd);
 
             for (auto& channel : sd.m_channel_descriptors)
             {
@@ -105,11 +164,11 @@ namespace framework
                     channel_interval.m_begin = convertTimeToTickAtOrAfter(interval.m_begin, getInputChannelProxy(channel.m_channel_id)->getTimeBase().m_frequency);
                     channel_interval.m_end = convertTimeToTickAtOrAfter(interval.m_end, getInputChannelProxy(channel.m_channel_id)->getTimeBase().m_frequency);
                 }
-                iterators[channel.m_channel_id] = stream_reader.createChannelIterator(channel.m_channel_id, channel_interval);
+                auto& iterator = iterators[channel.m_channel_id];
+                iterator.reset();
+                m_stream_reader.updateStreamIterator(channel.m_channel_id, iterator, channel_interval);
             }
         }
-
-        return iterators;
     }
 
     SoftwareChannelInstance::InitResult SoftwareChannelInstance::init(const InitParams& params)
@@ -363,63 +422,63 @@ namespace framework
         ODK_UNUSED(token);
 
         std::uint64_t ret = odk::error_codes::OK;
-        odk::AcquisitionTaskProcessTelegram telegram;
+        odk::AcquisitionTaskProcessTelegram& telegram = m_process_telegram;
+        telegram = odk::AcquisitionTaskProcessTelegram();
         if (param)
         {
             telegram.parse(param->asStringView());
         }
 
-        ProcessingContext context;
+        // the context is kept across calls so that the iterators can reuse their storage
+        ProcessingContext& context = m_processing_context;
         const auto master_timebase = getMasterTimestamp(host);
         context.m_master_timestamp = master_timebase;
 
         if (m_dataset_descriptor && telegram.m_start.timestampValid() && telegram.m_end.timestampValid())
         {
-            odk::DataRegions data_regions;
-            {
-                auto xml_msg = host->createValue<odk::IfXMLValue>();
-                if (xml_msg)
-                {
-                    double start = telegram.m_start.m_ticks / telegram.m_start.m_frequency;
-                    double end = telegram.m_end.m_ticks / telegram.m_end.m_frequency;
-                    PluginDataRegionsRequest req(m_dataset_descriptor->m_id);
-                    req.m_data_window = PluginDataRegionsRequest::DataWindow(start, end);
-                    xml_msg->set(req.generate().c_str());
-                }
+            const double start = telegram.m_start.m_ticks / telegram.m_start.m_frequency;
+            const double end = telegram.m_end.m_ticks / telegram.m_end.m_frequency;
 
-                const odk::IfValue* data_regions_result = nullptr;
-                host->messageSync(odk::host_msg::DATA_REGIONS_READ, 0, xml_msg.get(), &data_regions_result);
-
-                const odk::IfXMLValue* data_regions_result_xml = odk::value_cast<odk::IfXMLValue>(data_regions_result);
-                if (data_regions_result)
-                {
-                    if (data_regions_result_xml)
-                    {
-                        data_regions.parse(data_regions_result_xml->asStringView());
-                    }
-                    data_regions_result->release();
-                }
+            // hosts that support it report the invalid regions with the data, saving a DATA_REGIONS_READ per cycle
+            bool single_pass = m_data_read_includes_regions;
+            if (!single_pass)
+            {
+                readDataRegions(host, start, end);
             }
-            auto xml_msg = host->createValue<odk::IfXMLValue>();
-            if (xml_msg)
+
+            PluginDataRequest req(m_dataset_descriptor->m_id, PluginDataRequest::DataWindow(start, end));
+            if (single_pass)
             {
-                double start = telegram.m_start.m_ticks / telegram.m_start.m_frequency;
-                double end = telegram.m_end.m_ticks / telegram.m_end.m_frequency;
-                PluginDataRequest req(m_dataset_descriptor->m_id, PluginDataRequest::DataWindow(start, end));
-                xml_msg->set(req.generate().c_str());
+                req.m_include_regions = true;
             }
+            req.generate(m_request_xml);
 
             const odk::IfValue* response = nullptr;
 
-            if (0 != host->messageSync(odk::host_msg::DATA_READ, 0, xml_msg.get(), &response))
+            if (0 != host->messageSync(odk::host_msg::DATA_READ, 0, updateRequestValue(host), &response))
             {
-                return;
+                if (!single_pass)
+                {
+                    return;
+                }
+                // the host may reject the request for invalid regions, retry without it
+                readDataRegions(host, start, end);
+                req.m_include_regions = boost::none;
+                req.generate(m_request_xml);
+                if (0 != host->messageSync(odk::host_msg::DATA_READ, 0, updateRequestValue(host), &response))
+                {
+                    // failed for another reason, the next cycle tries a single request again
+                    return;
+                }
+                // only the request for invalid regions is rejected, request them separately from now on
+                m_data_read_includes_regions = false;
+                single_pass = false;
             }
 
             if (auto block_list = odk::value_cast<odk::IfDataBlockList>(response))
             {
                 auto block_list_descriptor_xml = odk::ptr(block_list->getBlockListDescription());
-                BlockListDescriptor list_descriptor;
+                BlockListDescriptor& list_descriptor = m_list_descriptor;
                 list_descriptor.parse(block_list_descriptor_xml->asStringView());
 
                 if (list_descriptor.m_windows.empty())
@@ -428,15 +487,29 @@ namespace framework
                     return;
                 }
 
+                if (single_pass && list_descriptor.m_invalid_regions_included)
+                {
+                    m_data_read_regions_confirmed = true;
+                }
+                // hosts may leave out an empty InvalidRegions element, which cannot be told apart from a host
+                // that ignores the request until the element has been seen once
+                const bool regions_included = single_pass && m_data_read_regions_confirmed;
+                if (single_pass && !regions_included)
+                {
+                    readDataRegions(host, start, end);
+                }
+
                 context.m_window.first = list_descriptor.m_windows.front().m_begin;
                 context.m_window.second = list_descriptor.m_windows.back().m_end;
 
-                context.m_channel_iterators = createChannelIterators(m_dataset_descriptor->m_stream_descriptors,
-                                                                     block_list,
-                                                                     odk::Interval<double>(context.m_window.first, context.m_window.second),
-                                                                     data_regions);
+                updateChannelIterators(context.m_channel_iterators,
+                                       m_dataset_descriptor->m_stream_descriptors,
+                                       block_list,
+                                       odk::Interval<double>(context.m_window.first, context.m_window.second),
+                                       &m_data_regions,
+                                       regions_included ? &list_descriptor.m_invalid_regions : nullptr);
 
-                process(context, host);
+                ret = processAndFlush(context, host);
                 response->release();
             }
         }
@@ -444,18 +517,12 @@ namespace framework
         {
             const double max_time = master_timebase.m_ticks / master_timebase.m_frequency;
             double current_time = 0.0;
+            const PluginDataRequest req(m_dataset_descriptor->m_id, PluginDataRequest::DataStream());
             while (current_time < max_time)
             {
-
-                auto xml_msg = host->createValue<odk::IfXMLValue>();
-                if (xml_msg)
-                {
-                    PluginDataRequest req(m_dataset_descriptor->m_id, PluginDataRequest::DataStream());
-                    xml_msg->set(req.generate().c_str());
-                }
-
+                req.generate(m_request_xml);
                 odk::MessageReturnValueHolder<odk::IfDataBlockList> block_list;
-                if (0 != host->messageSync(odk::host_msg::DATA_READ, 0, xml_msg.get(), block_list.data()))
+                if (0 != host->messageSync(odk::host_msg::DATA_READ, 0, updateRequestValue(host), block_list.data()))
                 {
                     throw odk::framework::CallbackError(odk::error_codes::INTERNAL_ERROR);
                 }
@@ -463,7 +530,7 @@ namespace framework
                 if (block_list.valid())
                 {
                     auto block_list_descriptor_xml = odk::ptr(block_list->getBlockListDescription());
-                    BlockListDescriptor list_descriptor;
+                    BlockListDescriptor& list_descriptor = m_list_descriptor;
                     list_descriptor.parse(block_list_descriptor_xml->asStringView());
 
                     if (list_descriptor.m_windows.empty())
@@ -474,21 +541,16 @@ namespace framework
                     context.m_window.first = list_descriptor.m_windows.front().m_begin;
                     context.m_window.second = list_descriptor.m_windows.back().m_end;
 
-                    context.m_channel_iterators = createChannelIterators(m_dataset_descriptor->m_stream_descriptors, block_list.ref());
+                    updateChannelIterators(context.m_channel_iterators,
+                                           m_dataset_descriptor->m_stream_descriptors,
+                                           block_list.ref(),
+                                           odk::Interval<double>(0, std::numeric_limits<double>::max()),
+                                           nullptr);
 
-                    try
-                    {
-                        process(context, host);
-                    }
-                    catch (const std::exception& e)
-                    {
-                        ODKLOG_ERROR("Unhandled exception during 'process': " << e.what());
-                        ret = odk::error_codes::UNHANDLED_EXCEPTION;
-                    }
-                    catch (...)
+                    const auto window_ret = processAndFlush(context, host);
+                    if (ret == odk::error_codes::OK)
                     {
-                        ODKLOG_ERROR("Unhandled exception during 'process'");
-                        ret = odk::error_codes::UNHANDLED_EXCEPTION;
+                        ret = window_ret;
                     }
 
                     current_time = context.m_window.second;
@@ -497,20 +559,12 @@ namespace framework
         }
         else
         {
-            try
+            // keep the entries to reuse their storage once data arrives again
+            for (auto& channel_iterator : context.m_channel_iterators)
             {
-                process(context, host);
-            }
-            catch (const std::exception& e)
-            {
-                ODKLOG_ERROR("Unhandled exception during 'process': " << e.what());
-                ret = odk::error_codes::UNHANDLED_EXCEPTION;
-            }
-            catch (...)
-            {
-                ODKLOG_ERROR("Unhandled exception during 'process'");
-                ret = odk::error_codes::UNHANDLED_EXCEPTION;
+                channel_iterator.second.reset();
             }
+            ret = processAndFlush(context, host);
         }
 
         // free manually retrieved data block lists
@@ -526,6 +580,85 @@ namespace framework
         }
     }
 
+    void SoftwareChannelInstance::readDataRegions(odk::IfHost* host, double start, double end)
+    {
+        m_data_regions.m_data_regions.clear();
+
+        PluginDataRegionsRequest req(m_dataset_descriptor->m_id);
+        req.m_data_window = PluginDataRegionsRequest::DataWindow(start, end);
+        req.generate(m_request_xml);
+
+        const odk::IfValue* data_regions_result = nullptr;
+        host->messageSync(odk::host_msg::DATA_REGIONS_READ, 0, updateRequestValue(host), &data_regions_result);
+
+        const odk::IfXMLValue* data_regions_result_xml = odk::value_cast<odk::IfXMLValue>(data_regions_result);
+        if (data_regions_result)
+        {
+            if (data_regions_result_xml)
+            {
+                m_data_regions.parse(data_regions_result_xml->asStringView());
+            }
+            data_regions_result->release();
+        }
+    }
+
+    const odk::IfXMLValue* SoftwareChannelInstance::updateRequestValue(odk::IfHost* host)
+    {
+        if (!m_request_value)
+        {
+            m_request_value = host->createValue<odk::IfXMLValue>();
+        }
+        if (m_request_value)
+        {
+            m_request_value->set(m_request_xml.c_str());
+        }
+        return m_request_value.get();
+    }
+
+    std::uint64_t SoftwareChannelInstance::processAndFlush(ProcessingContext& context, odk::IfHost* host)
+    {
+        try
+        {
+            process(context, host);
+        }
+        catch (const std::exception& e)
+        {
+            ODKLOG_ERROR("Unhandled exception during 'process': " << e.what());
+            discardOutputSamples();
+            return odk::error_codes::UNHANDLED_EXCEPTION;
+        }
+        catch (...)
+        {
+            ODKLOG_ERROR("Unhandled exception during 'process'");
+            discardOutputSamples();
+            return odk::error_codes::UNHANDLED_EXCEPTION;
+        }
+        return flushOutputSamples();
+    }
+
+    std::uint64_t SoftwareChannelInstance::flushOutputSamples()
+    {
+        std::uint64_t ret = odk::error_codes::OK;
+        for (const auto& channel : m_output_channels)
+        {
+            // the remaining channels are still sent
+            const auto channel_ret = channel->flushSamples();
+            if (ret == odk::error_codes::OK)
+            {
+                ret = channel_ret;
+            }
+        }
+        return ret;
+    }
+
+    void SoftwareChannelInstance::discardOutputSamples() noexcept
+    {
+        for (const auto& channel : m_output_channels)
+        {
+            channel->clearSamples();
+        }
+    }
+
     void SoftwareChannelInstance::onChannelConfigChanged(odk::IfHost* host, std::uint64_t token)
     {
         ODK_UNUSED(host);
@@ -2,15 +2,21 @@
 
 #include "odkfw_stream_iterator.h"
 
+#include <algorithm>
+
 namespace odk
 {
 namespace framework
 {
     StreamIterator::StreamIterator() noexcept
         : m_block_index(-1)
+        , m_total_sample_count(0)
+        , m_sample_offsets_block(-1)
         , m_data_requester(nullptr)
+        , m_advance_pending(false)
         , m_signal_gaps(false)
         , m_skip_gaps(true)
+        , m_sample_layout(SampleLayout::GAP)
     {
     }
 
@@ -39,6 +45,25 @@ namespace framework
         }
     }
 
+    void StreamIterator::finishBlock()
+    {
+        // the data requester may release the block as soon as the iterator leaves it
+        if (m_data_requester)
+        {
+            m_advance_pending = true;
+        }
+        else
+        {
+            getNextBlock();
+        }
+    }
+
+    void StreamIterator::resumeAdvance()
+    {
+        m_advance_pending = false;
+        getNextBlock();
+    }
+
     void StreamIterator::getPreviousBlock()
     {
         bool skip = true;
@@ -54,18 +79,250 @@ namespace framework
         }
     }
 
+    SampleSpan StreamIterator::nextSpan(std::uint64_t max_count)
+    {
+        if (m_advance_pending)
+        {
+            resumeAdvance();
+        }
+        if (!valid())
+        {
+            return {};
+        }
+
+        const auto& block_end = m_blocks_ranges[m_block_index].second;
+        const auto span = m_current_iterator.spanTo(block_end, max_count);
+        m_current_iterator += span.m_count;
+        if (m_current_iterator == block_end)
+        {
+            finishBlock();
+        }
+        return span;
+    }
+
+    bool StreamIterator::seek(std::uint64_t timestamp)
+    {
+        m_advance_pending = false;
+        while (!m_blocks_ranges.empty())
+        {
+            // last block starting at or before timestamp, the sample may also be the first of a successor
+            auto block = std::upper_bound(m_blocks_ranges.begin(), m_blocks_ranges.end(), timestamp,
+                [](std::uint64_t ts, const BlockIteratorRange& range)
+                {
+                    return ts < range.first.timestamp();
+                });
+            auto block_index = static_cast<std::size_t>(block - m_blocks_ranges.begin());
+            if (block_index > 0)
+            {
+                --block_index;
+            }
+
+            for (; block_index < m_blocks_ranges.size(); ++block_index)
+            {
+                if (seekInBlock(block_index, timestamp))
+                {
+                    if (m_skip_gaps && data() == nullptr)
+                    {
+                        getNextBlock();
+                    }
+                    return valid();
+                }
+            }
+
+            // behind all blocks: continue with data provided by the data requester, if any
+            m_block_index = static_cast<int>(m_blocks_ranges.size()) - 1;
+            m_current_iterator = m_blocks_ranges.back().second;
+            getNextBlock();
+            if (!valid() || this->timestamp() >= timestamp)
+            {
+                return valid();
+            }
+        }
+        return false;
+    }
+
+    bool StreamIterator::seekInBlock(std::size_t block_index, std::uint64_t timestamp)
+    {
+        const auto& range = m_blocks_ranges[block_index];
+        BlockIterator position = range.first;
+
+        switch (position.layout())
+        {
+        case SampleLayout::GAP:
+            if (timestamp >= range.second.timestamp())
+            {
+                return false;
+            }
+            if (timestamp > position.timestamp())
+            {
+                position = BlockIterator(timestamp);
+            }
+            break;
+        case SampleLayout::IMPLICIT_TIMESTAMP:
+        {
+            const auto count = position.distanceTo(range.second);
+            const auto offset = timestamp > position.timestamp() ? timestamp - position.timestamp() : 0;
+            if (offset >= count)
+            {
+                return false;
+            }
+            position += offset;
+            break;
+        }
+        case SampleLayout::EXPLICIT_TIMESTAMP:
+        {
+            std::uint64_t first = 0;
+            std::uint64_t count = position.distanceTo(range.second);
+            while (count > 0)
+            {
+                const auto step = count / 2;
+                BlockIterator probe = position;
+                probe += first + step;
+                if (probe.timestamp() < timestamp)
+                {
+                    first += step + 1;
+                    count -= step + 1;
+                }
+                else
+                {
+                    count = step;
+                }
+            }
+            position += first;
+            if (position == range.second)
+            {
+                return false;
+            }
+            break;
+        }
+        case SampleLayout::EXPLICIT_TIMESTAMP_DYNAMIC_SIZE:
+            while (position != range.second && position.timestamp() < timestamp)
+            {
+                ++position;
+            }
+            if (position == range.second)
+            {
+                return false;
+            }
+            break;
+        }
+
+        m_block_index = static_cast<int>(block_index);
+        m_current_iterator = position;
+        return true;
+    }
+
+    StreamIterator StreamIterator::lowerBound(std::uint64_t timestamp) const
+    {
+        StreamIterator iterator(*this);
+        // the data requester only updates the iterator it belongs to
+        iterator.m_data_requester = nullptr;
+        iterator.seek(timestamp);
+        return iterator;
+    }
+
+    namespace
+    {
+        bool rangeBeginsBefore(const StreamIterator::BlockIteratorRange& lhs, const StreamIterator::BlockIteratorRange& rhs) noexcept
+        {
+            return lhs.first.timestamp() < rhs.first.timestamp();
+        }
+    }
+
     void StreamIterator::addRange(const BlockIterator& begin, const BlockIterator& end)
     {
-        auto predecessor = m_blocks_ranges.rbegin();
-        while(predecessor != m_blocks_ranges.rend())
+        addRange(begin, end, begin.distanceTo(end));
+    }
+
+    void StreamIterator::addRange(const BlockIterator& begin, const BlockIterator& end, std::uint64_t sample_count)
+    {
+        if (m_blocks_ranges.empty() || m_blocks_ranges.back().first.timestamp() <= begin.timestamp())
+        {
+            m_blocks_ranges.emplace_back(begin, end);
+        }
+        else
+        {
+            const BlockIteratorRange range(begin, end);
+            m_blocks_ranges.insert(std::upper_bound(m_blocks_ranges.begin(), m_blocks_ranges.end(), range, rangeBeginsBefore), range);
+        }
+        m_total_sample_count += sample_count;
+        invalidateSampleOffsets();
+        rewind();
+    }
+
+    void StreamIterator::appendRange(const BlockIterator& begin, const BlockIterator& end)
+    {
+        appendRange(begin, end, begin.distanceTo(end));
+    }
+
+    void StreamIterator::appendRange(const BlockIterator& begin, const BlockIterator& end, std::uint64_t sample_count)
+    {
+        // counting samples with dynamic size is what sample_count avoids, even in debug builds
+        ODK_ASSERT(begin.layout() == SampleLayout::EXPLICIT_TIMESTAMP_DYNAMIC_SIZE || begin.distanceTo(end) == sample_count);
+        m_blocks_ranges.emplace_back(begin, end);
+        m_total_sample_count += sample_count;
+    }
+
+    void StreamIterator::appendGapRange(std::uint64_t begin, std::uint64_t end)
+    {
+        m_gap_ranges.emplace_back(BlockIterator(begin), BlockIterator(end));
+    }
+
+    void StreamIterator::sortRanges()
+    {
+        if (!std::is_sorted(m_blocks_ranges.begin(), m_blocks_ranges.end(), rangeBeginsBefore))
+        {
+            std::stable_sort(m_blocks_ranges.begin(), m_blocks_ranges.end(), rangeBeginsBefore);
+        }
+        if (!std::is_sorted(m_gap_ranges.begin(), m_gap_ranges.end(), rangeBeginsBefore))
+        {
+            std::stable_sort(m_gap_ranges.begin(), m_gap_ranges.end(), rangeBeginsBefore);
+        }
+        if (!m_skip_gaps)
+        {
+            mergeGapRanges();
+        }
+        invalidateSampleOffsets();
+        rewind();
+    }
+
+    void StreamIterator::mergeGapRanges()
+    {
+        if (m_gap_ranges.empty())
+        {
+            return;
+        }
+
+        // merge from the back so that no temporary storage is needed
+        const auto range_count = m_blocks_ranges.size();
+        m_blocks_ranges.resize(range_count + m_gap_ranges.size());
+        auto data_range = m_blocks_ranges.begin() + static_cast<std::ptrdiff_t>(range_count);
+        auto gap_range = m_gap_ranges.end();
+        auto target = m_blocks_ranges.end();
+        while (gap_range != m_gap_ranges.begin())
         {
-            if(predecessor->first.timestamp() < begin.timestamp())
+            if (data_range != m_blocks_ranges.begin() && rangeBeginsBefore(*(gap_range - 1), *(data_range - 1)))
             {
-                break;
+                *(--target) = *(--data_range);
+            }
+            else
+            {
+                *(--target) = *(--gap_range);
             }
-            ++predecessor;
         }
-        m_blocks_ranges.emplace(predecessor.base(), begin, end);
+        m_gap_ranges.clear();
+        invalidateSampleOffsets();
+    }
+
+    void StreamIterator::rewind()
+    {
+        m_advance_pending = false;
+        if (m_blocks_ranges.empty())
+        {
+            m_block_index = -1;
+            m_current_iterator = {};
+            return;
+        }
         m_block_index = 0;
         m_current_iterator = m_blocks_ranges.front().first;
         if (m_skip_gaps && data() == nullptr)
@@ -74,13 +331,57 @@ namespace framework
         }
     }
 
+    void StreamIterator::stepBackDynamicSize()
+    {
+        const auto& range = m_blocks_ranges[m_block_index];
+        const auto block_begin = static_cast<const std::uint8_t*>(range.first.data());
+        if (m_sample_offsets_block != m_block_index)
+        {
+            m_sample_offsets.clear();
+            for (BlockIterator position = range.first; position != range.second; ++position)
+            {
+                m_sample_offsets.push_back(static_cast<std::uint64_t>(static_cast<const std::uint8_t*>(position.data()) - block_begin));
+            }
+            m_sample_offsets_block = m_block_index;
+        }
+
+        const auto offset = static_cast<std::uint64_t>(static_cast<const std::uint8_t*>(m_current_iterator.data()) - block_begin);
+        const auto next_sample = std::lower_bound(m_sample_offsets.begin(), m_sample_offsets.end(), offset);
+        ODK_ASSERT(next_sample != m_sample_offsets.begin());
+        const auto previous_offset = *(next_sample - 1);
+        m_current_iterator.stepBack(static_cast<std::size_t>(offset - previous_offset) - m_current_iterator.dataStride());
+    }
+
+    void StreamIterator::invalidateSampleOffsets() noexcept
+    {
+        m_sample_offsets_block = -1;
+    }
+
     void StreamIterator::clearRanges() noexcept
     {
         m_blocks_ranges.clear();
+        m_gap_ranges.clear();
+        m_total_sample_count = 0;
+        invalidateSampleOffsets();
         m_block_index = -1;
+        m_advance_pending = false;
         m_current_iterator = {};
     }
 
+    void StreamIterator::reset() noexcept
+    {
+        clearRanges();
+        m_data_requester = nullptr;
+        m_signal_gaps = false;
+        m_skip_gaps = true;
+        m_sample_layout = SampleLayout::GAP;
+    }
+
+    void StreamIterator::setSampleLayout(SampleLayout layout) noexcept
+    {
+        m_sample_layout = layout;
+    }
+
     void StreamIterator::setSignalGaps(bool enabled) noexcept
     {
         m_signal_gaps = enabled;
@@ -89,31 +390,16 @@ namespace framework
     void StreamIterator::setSkipGaps(bool enabled)
     {
         m_skip_gaps = enabled;
-
-        if(!m_blocks_ranges.empty())
+        if (!m_skip_gaps)
         {
-            m_block_index = 0;
-            m_current_iterator = m_blocks_ranges.front().first;
-            if (m_skip_gaps && data() == nullptr)
-            {
-                getNextBlock();
-            }
+            mergeGapRanges();
         }
+        rewind();
     }
 
     void StreamIterator::setDataRequester(IfIteratorUpdater *requester) noexcept
     {
         m_data_requester = requester;
     }
-
-    std::uint64_t StreamIterator::getTotalSampleCount() const noexcept
-    {
-        std::uint64_t sample_count = 0;
-        for(const auto& block_range : m_blocks_ranges)
-        {
-            sample_count += block_range.first.distanceTo(block_range.second);
-        }
-        return sample_count;
-    }
 }
 }
@@ -3,6 +3,7 @@
 #include "odkapi_data_set_descriptor_xml.h"
 #include "odkuni_assert.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace odk
@@ -10,42 +11,97 @@ namespace odk
 namespace framework
 {
     StreamReader::StreamReader(const StreamDescriptor& stream_descriptor)
-        : m_stream_descriptor(stream_descriptor)
     {
+        setStreamDescriptor(stream_descriptor);
     }
 
     void StreamReader::setStreamDescriptor(const StreamDescriptor& stream_descriptor)
     {
         m_stream_descriptor = stream_descriptor;
+
+        const auto& channels = m_stream_descriptor.m_channel_descriptors;
+        m_channel_descriptor_index.clear();
+        for (std::size_t index = 0; index < channels.size(); ++index)
+        {
+            m_channel_descriptor_index.emplace_back(channels[index].m_channel_id, index);
+        }
+        // ordering by index as well keeps the first descriptor of duplicate channel ids in front
+        std::sort(m_channel_descriptor_index.begin(), m_channel_descriptor_index.end());
+    }
+
+    namespace
+    {
+        bool regionLess(const odk::DataRegion& lhs, const odk::DataRegion& rhs) noexcept
+        {
+            if (lhs.m_channel_id != rhs.m_channel_id)
+            {
+                return lhs.m_channel_id < rhs.m_channel_id;
+            }
+            return lhs.m_region < rhs.m_region;
+        }
+    }
+
+    BlockDescriptor& StreamReader::nextBlockSlot()
+    {
+        if (m_block_count == m_blocks.size())
+        {
+            m_blocks.emplace_back(BlockDescriptor(), nullptr);
+        }
+        return std::get<0>(m_blocks[m_block_count]);
     }
 
     void StreamReader::addDataBlock(const BlockDescriptor& block_descriptor, const void* data)
     {
-        m_blocks.emplace(block_descriptor.m_stream_id, std::make_tuple(block_descriptor, data));
+        nextBlockSlot() = block_descriptor;
+        std::get<1>(m_blocks[m_block_count++]) = data;
+        m_channel_index_valid = false;
     }
 
     void StreamReader::addDataBlock(BlockDescriptor&& block_descriptor, const void* data)
     {
-        m_blocks.emplace(block_descriptor.m_stream_id, std::make_tuple(std::move(block_descriptor), data));
+        nextBlockSlot() = std::move(block_descriptor);
+        std::get<1>(m_blocks[m_block_count++]) = data;
+        m_channel_index_valid = false;
+    }
+
+    bool StreamReader::addDataBlock(const boost::string_view& block_descriptor_xml, const void* data)
+    {
+        // decode in place so that the channel list of the slot is reused
+        auto& block_descriptor = nextBlockSlot();
+        if (!block_descriptor.parse(block_descriptor_xml) || block_descriptor.m_block_channels.empty())
+        {
+            return false;
+        }
+        std::get<1>(m_blocks[m_block_count++]) = data;
+        m_channel_index_valid = false;
+        return true;
     }
 
     void StreamReader::addDataRegion(const odk::DataRegion& region)
     {
-        m_data_regions[region.m_channel_id].emplace(region.m_region);
+        auto pos = std::upper_bound(m_data_regions.begin(), m_data_regions.end(), region, regionLess);
+        if (pos != m_data_regions.begin())
+        {
+            const auto& predecessor = *(pos - 1);
+            if (predecessor.m_channel_id == region.m_channel_id && predecessor.m_region == region.m_region)
+            {
+                return;
+            }
+        }
+        m_data_regions.insert(pos, region);
     }
 
     const ChannelDescriptor* StreamReader::getChannelDescriptor(const std::uint64_t channel_id) const
     {
-        auto channel_descriptor = std::find_if(
-            m_stream_descriptor.m_channel_descriptors.begin(), m_stream_descriptor.m_channel_descriptors.end(),
-            [channel_id](const ChannelDescriptor& desc)
+        auto entry = std::lower_bound(m_channel_descriptor_index.begin(), m_channel_descriptor_index.end(), channel_id,
+            [](const std::pair<std::uint64_t, std::size_t>& lhs, std::uint64_t id)
             {
-                return desc.m_channel_id == channel_id;
+                return lhs.first < id;
             });
 
-        if (channel_descriptor != m_stream_descriptor.m_channel_descriptors.end())
+        if (entry != m_channel_descriptor_index.end() && entry->first == channel_id)
         {
-            return &(*channel_descriptor);
+            return &m_stream_descriptor.m_channel_descriptors[entry->second];
         }
         else
         {
@@ -53,6 +109,81 @@ namespace framework
         }
     }
 
+    std::uint32_t StreamReader::findOrInsertChannelKey(const ChannelKey& key) const
+    {
+        auto pos = std::lower_bound(m_channel_keys.begin(), m_channel_keys.end(), key);
+        if (pos == m_channel_keys.end() || *pos != key)
+        {
+            pos = m_channel_keys.insert(pos, key);
+        }
+        return static_cast<std::uint32_t>(pos - m_channel_keys.begin());
+    }
+
+    void StreamReader::ensureChannelIndex() const
+    {
+        if (m_channel_index_valid)
+        {
+            return;
+        }
+
+        // Assign every block channel to its key. Consecutive blocks usually list the same channels
+        // in the same order, so the successor of the previous key is tried before searching.
+        bool keys_inserted = true;
+        while (keys_inserted)
+        {
+            keys_inserted = false;
+            const auto key_count = m_channel_keys.size();
+            m_entry_keys.clear();
+            std::uint32_t hint = 0;
+            for (std::size_t block = 0; block < m_block_count; ++block)
+            {
+                const BlockDescriptor& block_descriptor = std::get<0>(m_blocks[block]);
+                for (const auto& bcd : block_descriptor.m_block_channels)
+                {
+                    const ChannelKey key(block_descriptor.m_stream_id, bcd.m_channel_id);
+                    if (hint >= m_channel_keys.size() || m_channel_keys[hint] != key)
+                    {
+                        hint = findOrInsertChannelKey(key);
+                    }
+                    m_entry_keys.push_back(hint++);
+                }
+            }
+            // inserting keys invalidates the indices assigned so far
+            keys_inserted = m_channel_keys.size() != key_count;
+        }
+
+        // counting sort by key, keeps the block order within each key
+        m_channel_offsets.assign(m_channel_keys.size() + 1, 0);
+        for (auto key : m_entry_keys)
+        {
+            ++m_channel_offsets[key + 1];
+        }
+        for (std::size_t key = 1; key < m_channel_offsets.size(); ++key)
+        {
+            m_channel_offsets[key] += m_channel_offsets[key - 1];
+        }
+
+        m_channel_index.resize(m_entry_keys.size());
+        std::size_t entry = 0;
+        for (std::size_t block = 0; block < m_block_count; ++block)
+        {
+            const auto channel_count = std::get<0>(m_blocks[block]).m_block_channels.size();
+            for (std::size_t block_channel = 0; block_channel < channel_count; ++block_channel)
+            {
+                // m_channel_offsets[key] is used as insert position and ends up at the end of the group
+                auto& position = m_channel_offsets[m_entry_keys[entry++]];
+                m_channel_index[position++] = {static_cast<std::uint32_t>(block), static_cast<std::uint32_t>(block_channel)};
+            }
+        }
+        // shift back so that m_channel_offsets[key] is the begin of the group again
+        for (std::size_t key = m_channel_offsets.size() - 1; key > 0; --key)
+        {
+            m_channel_offsets[key] = m_channel_offsets[key - 1];
+        }
+        m_channel_offsets[0] = 0;
+        m_channel_index_valid = true;
+    }
+
     bool StreamReader::hasChannel(const std::uint64_t channel_id) const
     {
         return getChannelDescriptor(channel_id) != nullptr;
@@ -72,7 +203,6 @@ namespace framework
 
     void StreamReader::updateStreamIterator(std::uint64_t channel_id, StreamIterator& iterator, const odk::Interval<std::uint64_t>& interval) const
     {
-        std::uint64_t sample_count = 0;
         iterator.clearRanges();
 
         auto channel_descriptor = getChannelDescriptor(channel_id);
@@ -81,109 +211,125 @@ namespace framework
             throw std::runtime_error("Invalid channel ID");
         }
 
-        std::multimap<std::uint64_t, BlockDescriptorData>::const_iterator blocks_begin;
-        std::multimap<std::uint64_t, BlockDescriptorData>::const_iterator blocks_end;
-        std::tie(blocks_begin, blocks_end) = m_blocks.equal_range(m_stream_descriptor.m_stream_id);
+        ensureChannelIndex();
+        const ChannelKey key(m_stream_descriptor.m_stream_id, channel_id);
+        const auto key_pos = std::lower_bound(m_channel_keys.begin(), m_channel_keys.end(), key);
+        auto entries_begin = m_channel_index.cend();
+        auto entries_end = m_channel_index.cend();
+        if (key_pos != m_channel_keys.end() && *key_pos == key)
+        {
+            const auto key_index = static_cast<std::size_t>(key_pos - m_channel_keys.begin());
+            entries_begin = m_channel_index.cbegin() + static_cast<std::ptrdiff_t>(m_channel_offsets[key_index]);
+            entries_end = m_channel_index.cbegin() + static_cast<std::ptrdiff_t>(m_channel_offsets[key_index + 1]);
+        }
+
+        // the sample layout is the same for all blocks of the channel
+        ODK_ASSERT_EQUAL(channel_descriptor->m_stride % 8, 0);
+        const std::size_t data_stride_bytes = channel_descriptor->m_stride / 8;
 
-        for (auto it_block = blocks_begin; it_block != blocks_end; ++it_block)
+        SampleLayout layout = SampleLayout::IMPLICIT_TIMESTAMP;
+        std::size_t timestamp_pos_bytes = 0;
+        std::size_t sample_size_bytes = 0;
+        if (channel_descriptor->m_timestamp_position)
         {
-            const BlockDescriptor& block_descriptor = std::get<0>(it_block->second);
-            const void* block_data = std::get<1>(it_block->second);
+            ODK_ASSERT_EQUAL(*channel_descriptor->m_timestamp_position % 8, 0);
+            timestamp_pos_bytes = *channel_descriptor->m_timestamp_position / 8;
+            layout = SampleLayout::EXPLICIT_TIMESTAMP;
 
-            for (const auto& bcd : block_descriptor.m_block_channels)
+            if (channel_descriptor->m_sample_size_position)
             {
-                if (bcd.m_channel_id == channel_id && bcd.m_count > 0)
-                {                    
-                    ODK_ASSERT_EQUAL(bcd.m_offset % 8, 0);
+                ODK_ASSERT_EQUAL(*channel_descriptor->m_sample_size_position % 8, 0);
+                sample_size_bytes = *channel_descriptor->m_sample_size_position / 8;
+                layout = SampleLayout::EXPLICIT_TIMESTAMP_DYNAMIC_SIZE;
+            }
+        }
+        iterator.setSampleLayout(layout);
 
-                    auto offset_bytes = bcd.m_offset / 8;
+        for (auto entry = entries_begin; entry != entries_end; ++entry)
+        {
+            const BlockDescriptor& block_descriptor = std::get<0>(m_blocks[entry->m_block]);
+            const void* block_data = std::get<1>(m_blocks[entry->m_block]);
+            const auto& bcd = block_descriptor.m_block_channels[entry->m_block_channel];
 
-                    const std::uint8_t* channel_data = reinterpret_cast<const std::uint8_t*>(block_data) + offset_bytes;
+            if (bcd.m_count == 0)
+            {
+                continue;
+            }
 
-                    ODK_ASSERT_EQUAL(channel_descriptor->m_stride % 8, 0);
+            ODK_ASSERT_EQUAL(bcd.m_offset % 8, 0);
+            const std::uint8_t* channel_data = reinterpret_cast<const std::uint8_t*>(block_data) + bcd.m_offset / 8;
+            const std::uint8_t* channel_data_end = channel_data + data_stride_bytes * bcd.m_count;
 
-                    const std::size_t data_stride_bytes = channel_descriptor->m_stride / 8;
-                    if (channel_descriptor->m_timestamp_position)
-                    {
-                        ODK_ASSERT_EQUAL(*channel_descriptor->m_timestamp_position % 8, 0);
-
-                        const auto timestamp_pos_bytes = *channel_descriptor->m_timestamp_position / 8;
-
-                        if (channel_descriptor->m_sample_size_position)
-                        {
-                            ODK_ASSERT_EQUAL(*channel_descriptor->m_sample_size_position % 8, 0);
-
-                            const auto sample_size_bytes = *channel_descriptor->m_sample_size_position / 8;
-                            // Explicit Timestamp field and sample size field
-                            BlockIterator it_block_begin(channel_data, data_stride_bytes, reinterpret_cast<const uint64_t*>(channel_data + timestamp_pos_bytes), 
-                                data_stride_bytes, reinterpret_cast<const uint32_t*>(channel_data + sample_size_bytes), data_stride_bytes);
-
-                            const std::uint8_t* data_end = channel_data + block_descriptor.m_data_size;
-                            
-                            const std::uint64_t* ts_end = reinterpret_cast<const uint64_t*>(data_end + timestamp_pos_bytes);
-                            const std::uint32_t* size_end = reinterpret_cast<const uint32_t*>(data_end + sample_size_bytes);
-
-                            BlockIterator it_block_end(data_end, data_stride_bytes, ts_end, data_stride_bytes, size_end, data_stride_bytes);
-                            iterator.addRange(it_block_begin, it_block_end);
-                        }
-                        else
-                        {
-                            // Explicit Timestamp field
-                            BlockIterator it_block_begin(channel_data, data_stride_bytes, reinterpret_cast<const uint64_t*>(channel_data + timestamp_pos_bytes), data_stride_bytes);
-                            BlockIterator it_block_end(channel_data + data_stride_bytes * bcd.m_count, data_stride_bytes, reinterpret_cast<const std::uint64_t*>(channel_data + data_stride_bytes * bcd.m_count + timestamp_pos_bytes), data_stride_bytes);
-                            iterator.addRange(it_block_begin, it_block_end);
-                        }
-                    }
-                    else
-                    {
-                        // Implicit timestamps, incremented every sample
-                        BlockIterator it_block_begin(channel_data, data_stride_bytes, bcd.m_first_sample_index);
-                        BlockIterator it_block_end(channel_data + data_stride_bytes * bcd.m_count, data_stride_bytes, bcd.m_first_sample_index + bcd.m_count);
-                        iterator.addRange(it_block_begin, it_block_end);
-                    }
-                    sample_count += bcd.m_count;
-                }
+            switch (layout)
+            {
+            case SampleLayout::IMPLICIT_TIMESTAMP:
+                // Implicit timestamps, incremented every sample
+                iterator.appendRange(BlockIterator(channel_data, data_stride_bytes, bcd.m_first_sample_index),
+                                  BlockIterator(channel_data_end, data_stride_bytes, bcd.m_first_sample_index + bcd.m_count),
+                                  bcd.m_count);
+                break;
+            case SampleLayout::EXPLICIT_TIMESTAMP:
+                // Explicit Timestamp field
+                iterator.appendRange(BlockIterator(channel_data, data_stride_bytes, reinterpret_cast<const std::uint64_t*>(channel_data + timestamp_pos_bytes), data_stride_bytes),
+                                  BlockIterator(channel_data_end, data_stride_bytes, reinterpret_cast<const std::uint64_t*>(channel_data_end + timestamp_pos_bytes), data_stride_bytes),
+                                  bcd.m_count);
+                break;
+            case SampleLayout::EXPLICIT_TIMESTAMP_DYNAMIC_SIZE:
+            {
+                // Explicit Timestamp field and sample size field
+                const std::uint8_t* data_end = channel_data + block_descriptor.m_data_size;
+                iterator.appendRange(
+                    BlockIterator(channel_data, data_stride_bytes, reinterpret_cast<const std::uint64_t*>(channel_data + timestamp_pos_bytes), data_stride_bytes,
+                        reinterpret_cast<const std::uint32_t*>(channel_data + sample_size_bytes), data_stride_bytes),
+                    BlockIterator(data_end, data_stride_bytes, reinterpret_cast<const std::uint64_t*>(data_end + timestamp_pos_bytes), data_stride_bytes,
+                        reinterpret_cast<const std::uint32_t*>(data_end + sample_size_bytes), data_stride_bytes),
+                    bcd.m_count);
+                break;
+            }
+            case SampleLayout::GAP:
+                break;
             }
         }
 
-        auto regions = m_data_regions.find(channel_id);
+        auto regions_begin = std::lower_bound(m_data_regions.begin(), m_data_regions.end(), channel_id,
+            [](const odk::DataRegion& region, std::uint64_t id)
+            {
+                return region.m_channel_id < id;
+            });
 
         std::uint64_t invalid_region_start = interval.m_begin;
         std::uint64_t invalid_region_end = interval.m_end;
 
-        if(regions != m_data_regions.end())
+        for (auto region = regions_begin; region != m_data_regions.end() && region->m_channel_id == channel_id; ++region)
         {
-            for(const auto& valid_region : regions->second)
-            {
-                invalid_region_end = valid_region.m_begin;
+            const auto& valid_region = region->m_region;
+            // valid regions may extend beyond the interval, gaps are only reported inside of it
+            invalid_region_start = std::max(invalid_region_start, interval.m_begin);
+            invalid_region_end = std::min(valid_region.m_begin, interval.m_end);
 
-                if(invalid_region_end > invalid_region_start)
-                {
-                    BlockIterator it_block_begin(invalid_region_start);
-                    BlockIterator it_block_end(invalid_region_end);
-                    iterator.addRange(it_block_begin, it_block_end);
-                }
-
-                invalid_region_start = valid_region.m_end;
+            if(invalid_region_end > invalid_region_start)
+            {
+                iterator.appendGapRange(invalid_region_start, invalid_region_end);
             }
+
+            invalid_region_start = valid_region.m_end;
         }
+        invalid_region_start = std::max(invalid_region_start, interval.m_begin);
 
         invalid_region_end = interval.m_end;
 
         if (invalid_region_end > invalid_region_start)
         {
-            BlockIterator it_block_begin(invalid_region_start);
-            BlockIterator it_block_end(invalid_region_end);
-            iterator.addRange(it_block_begin, it_block_end);
+            iterator.appendGapRange(invalid_region_start, invalid_region_end);
         }
 
-        ODK_UNUSED(sample_count);
-        ODK_ASSERT_EQUAL(iterator.getTotalSampleCount(), sample_count);
+        iterator.sortRanges();
     }
 
-    void StreamReader::clearBlocks()
+    void StreamReader::clearBlocks() noexcept
     {
-        m_blocks.clear();
+        m_block_count = 0;
+        m_channel_index_valid = false;
         m_data_regions.clear();
     }
 
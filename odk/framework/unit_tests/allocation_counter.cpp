@@ -0,0 +1,78 @@
+// Copyright DEWETRON GmbH 2026
+#include "allocation_counter.h"
+
+#include <pugixml.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<std::size_t> g_allocation_count(0);
+
+    void* countedAllocation(std::size_t size)
+    {
+        g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+        if (void* ptr = std::malloc(size ? size : 1))
+        {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* countedPugiAllocation(std::size_t size)
+    {
+        g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size);
+    }
+
+    /// pugixml does not use operator new, a DOM built on the way has to be counted as well
+    struct PugiAllocationHook
+    {
+        PugiAllocationHook()
+        {
+            pugi::set_memory_management_functions(countedPugiAllocation, std::free);
+        }
+    } g_pugi_allocation_hook;
+}
+
+void* operator new(std::size_t size)
+{
+    return countedAllocation(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return countedAllocation(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+AllocationCounter::AllocationCounter() noexcept
+    : m_start(g_allocation_count.load(std::memory_order_relaxed))
+{
+}
+
+std::size_t AllocationCounter::count() const noexcept
+{
+    return g_allocation_count.load(std::memory_order_relaxed) - m_start;
+}
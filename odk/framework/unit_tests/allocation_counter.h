@@ -0,0 +1,19 @@
+// Copyright DEWETRON GmbH 2026
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Counts calls to the global operator new and to the pugixml allocator of the test executable
+ */
+class AllocationCounter
+{
+public:
+    AllocationCounter() noexcept;
+
+    /// number of allocations since construction
+    std::size_t count() const noexcept;
+
+private:
+    std::size_t m_start;
+};
@@ -2,6 +2,11 @@
 
 #include "odkapi_block_descriptor_xml.h"
 #include "odkfw_block_iterator.h"
+#include "odkfw_typed_block_iterator.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -65,4 +70,93 @@ BOOST_AUTO_TEST_CASE(timepointer_block_iterator_test)
     BOOST_CHECK_EQUAL(it.distanceTo(it1), 1);
 }
 
+BOOST_AUTO_TEST_CASE(typed_sync_block_iterator_test)
+{
+    const double data[] = {3.1415, 2.718, 1.618};
+
+    BlockIterator it(data, sizeof(double), 123);
+    BOOST_CHECK(it.layout() == SampleLayout::IMPLICIT_TIMESTAMP);
+    BOOST_CHECK(BlockIterator(5).layout() == SampleLayout::GAP);
+
+    SyncBlockIterator typed_it(it);
+    const SyncBlockIterator typed_end(BlockIterator(data + 3, sizeof(double), 126));
+    for (int i = 0; i < 3; ++i)
+    {
+        BOOST_REQUIRE(typed_it != typed_end);
+        BOOST_CHECK_EQUAL(typed_it.data(), it.data());
+        BOOST_CHECK_EQUAL(typed_it.timestamp(), it.timestamp());
+        BOOST_CHECK_EQUAL(typed_it.value<double>(), data[i]);
+        ++typed_it;
+        ++it;
+    }
+    BOOST_CHECK(typed_it == typed_end);
+}
+
+BOOST_AUTO_TEST_CASE(typed_async_block_iterator_test)
+{
+    const double data[] = {3.1415, 2.718, 1.618};
+    const std::uint64_t timestamps[] = {1, 5, 7};
+
+    BlockIterator it(data, sizeof(double), timestamps, sizeof(std::uint64_t));
+    BOOST_CHECK(it.layout() == SampleLayout::EXPLICIT_TIMESTAMP);
+
+    AsyncBlockIterator typed_it(it);
+    for (int i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK_EQUAL(typed_it.data(), it.data());
+        BOOST_CHECK_EQUAL(typed_it.timestamp(), timestamps[i]);
+        BOOST_CHECK_EQUAL(typed_it.value<double>(), data[i]);
+        ++typed_it;
+        ++it;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(typed_async_dynamic_block_iterator_test)
+{
+    // every sample: timestamp, size, padding, payload of dynamic size
+    const std::size_t header_size = 16;
+    std::vector<std::uint8_t> buffer;
+    const auto append_sample = [&buffer](std::uint64_t timestamp, std::vector<double> payload)
+    {
+        const std::uint32_t size = static_cast<std::uint32_t>(payload.size() * sizeof(double));
+        const auto pos = buffer.size();
+        buffer.resize(pos + header_size + size);
+        std::memcpy(buffer.data() + pos, &timestamp, sizeof(timestamp));
+        std::memcpy(buffer.data() + pos + 8, &size, sizeof(size));
+        std::memcpy(buffer.data() + pos + header_size, payload.data(), size);
+    };
+    append_sample(10, {1.5});
+    append_sample(20, {2.5, 3.5});
+    append_sample(30, {4.5});
+
+    const auto payload = buffer.data() + header_size;
+    BlockIterator it(payload, header_size,
+        reinterpret_cast<const std::uint64_t*>(buffer.data()), header_size,
+        reinterpret_cast<const std::uint32_t*>(buffer.data() + 8), header_size);
+    BOOST_CHECK(it.layout() == SampleLayout::EXPLICIT_TIMESTAMP_DYNAMIC_SIZE);
+
+    AsyncDynamicBlockIterator typed_it(it);
+    const std::uint64_t expected_timestamps[] = {10, 20, 30};
+    const std::size_t expected_sizes[] = {8, 16, 8};
+    for (int i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK_EQUAL(typed_it.data(), it.data());
+        BOOST_CHECK_EQUAL(typed_it.timestamp(), expected_timestamps[i]);
+        BOOST_CHECK_EQUAL(typed_it.size(), expected_sizes[i]);
+        ++typed_it;
+        ++it;
+    }
+    BOOST_CHECK_EQUAL(typed_it.data(), buffer.data() + buffer.size() + header_size);
+
+    BOOST_CHECK_THROW(--it, std::runtime_error);
+    it.stepBack(8);
+    BOOST_CHECK_EQUAL(it.timestamp(), 30);
+    it.stepBack(16);
+    BOOST_CHECK_EQUAL(it.timestamp(), 20);
+    BOOST_CHECK_EQUAL(it.size(), 16);
+    it.stepBack(8);
+    BOOST_CHECK_EQUAL(it.timestamp(), 10);
+    BOOST_CHECK_EQUAL(*static_cast<const double*>(it.data()), 1.5);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
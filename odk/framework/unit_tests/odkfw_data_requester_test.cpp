@@ -0,0 +1,807 @@
+// Copyright DEWETRON GmbH 2026
+#include "odkfw_data_requester.h"
+#include "odkapi_block_descriptor_xml.h"
+#include "odkapi_channel_dataformat_xml.h"
+#include "odkapi_data_set_xml.h"
+#include "odkapi_error_codes.h"
+#include "odkapi_timebase_xml.h"
+#include "test_host.h"
+#include "values.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    const std::uint64_t CHANNEL_ID = 3;
+    const std::uint64_t DATA_SET_ID = 17;
+    const double SAMPLE_RATE = 1000;
+    /// 100 samples of a double channel at SAMPLE_RATE per window
+    const std::uint64_t WINDOW_BYTES = 800;
+
+    class CountedBlockListValue : public DataBlockListValue
+    {
+    public:
+        CountedBlockListValue(std::atomic<int>& live_count)
+            : DataBlockListValue("<BlockListDescriptor/>")
+            , m_live_count(live_count)
+        {
+            ++m_live_count;
+        }
+
+        ~CountedBlockListValue()
+        {
+            for (const auto& samples : m_poisoned_samples)
+            {
+                std::fill(samples.first, samples.first + samples.second, POISON_VALUE);
+            }
+            --m_live_count;
+        }
+
+        /// overwrites count samples with POISON_VALUE when the block list is released
+        void poisonOnRelease(double* samples, std::size_t count)
+        {
+            m_poisoned_samples.emplace_back(samples, count);
+        }
+
+        static constexpr double POISON_VALUE = -1.0;
+
+    private:
+        std::atomic<int>& m_live_count;
+        std::vector<std::pair<double*, std::size_t>> m_poisoned_samples;
+    };
+
+    constexpr double CountedBlockListValue::POISON_VALUE;
+
+    /// value of sample 0 of the channel CHANNEL_ID + n is n * CHANNEL_VALUE_OFFSET
+    const double CHANNEL_VALUE_OFFSET = 1000000;
+
+    /**
+     * Host with recorded double channels CHANNEL_ID, CHANNEL_ID + 1, ... whose sample values are their sample indices
+     * plus a channel offset. Channel CHANNEL_ID + n is recorded in [m_first_sample + n * channel_delay, m_end_sample),
+     * windows outside of that are answered without blocks for the channel. No data is recorded in [m_gap_begin, m_gap_end)
+     * and DATA_REGIONS_READ is answered with the valid regions around it if m_reply_regions is set.
+     * If m_poison_released is set, samples are overwritten when the block list holding them is released.
+     * DATA_READ is answered on the thread of the requester, so no test assertions are used in messageSync.
+     */
+    class RecordingHost : public TestHost
+    {
+    public:
+        RecordingHost(std::uint64_t first_sample, std::uint64_t end_sample, std::uint64_t channel_count = 1, std::uint64_t channel_delay = 0)
+            : m_first_sample(first_sample)
+            , m_end_sample(end_sample)
+            , m_channel_delay(channel_delay)
+            , m_samples(channel_count, std::vector<double>(end_sample))
+        {
+            for (std::uint64_t channel = 0; channel < channel_count; ++channel)
+            {
+                for (std::uint64_t sample = 0; sample < end_sample; ++sample)
+                {
+                    m_samples[channel][sample] = static_cast<double>(channel) * CHANNEL_VALUE_OFFSET + static_cast<double>(sample);
+                }
+            }
+        }
+
+        odk::IfValue* PLUGIN_API createValue(odk::IfValue::Type type) const override
+        {
+            if (type == odk::IfValue::Type::TYPE_UINT)
+            {
+                return new UIntValue(0);
+            }
+            return TestHost::createValue(type);
+        }
+
+        std::uint64_t PLUGIN_API messageSync(odk::MessageId msg_id, std::uint64_t key, const odk::IfValue* param, const odk::IfValue** ret) override
+        {
+            ODK_UNUSED(key);
+            if (ret)
+            {
+                *ret = nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            switch (msg_id)
+            {
+            case odk::host_msg::DATA_GROUP_ADD:
+            {
+                auto xml_param = dynamic_cast<const odk::IfXMLValue*>(param);
+                odk::PluginDataSet request;
+                if (!xml_param || !request.parse(xml_param->getValue()))
+                {
+                    m_unexpected_message = true;
+                    return odk::error_codes::INVALID_INPUT_PARAMETER;
+                }
+                ++m_data_set_count;
+
+                odk::DataSetDescriptor descriptor;
+                descriptor.m_id = DATA_SET_ID;
+                odk::StreamDescriptor stream_descriptor;
+                stream_descriptor.m_stream_id = 1;
+                for (const auto channel_id : request.m_channels)
+                {
+                    // unknown channels are not part of the data set
+                    if (channel_id >= CHANNEL_ID && channel_id < CHANNEL_ID + m_samples.size())
+                    {
+                        odk::ChannelDescriptor channel_descriptor;
+                        channel_descriptor.m_channel_id = channel_id;
+                        channel_descriptor.m_dimension = 1;
+                        channel_descriptor.m_stride = 64;
+                        channel_descriptor.m_size = 64;
+                        channel_descriptor.m_type = odk::SampleType::DOUBLE;
+                        stream_descriptor.m_channel_descriptors.push_back(channel_descriptor);
+                    }
+                }
+                descriptor.m_stream_descriptors.push_back(stream_descriptor);
+                m_data_set = stream_descriptor.m_channel_descriptors;
+                *ret = new XmlValue(descriptor.generate());
+                return odk::error_codes::OK;
+            }
+
+            case odk::host_msg::DATA_READ:
+            {
+                auto xml_param = dynamic_cast<const odk::IfXMLValue*>(param);
+                odk::PluginDataRequest request;
+                if (m_removed || !xml_param || !request.parse(xml_param->getValue()) || !request.m_data_window)
+                {
+                    m_unexpected_message = true;
+                    return odk::error_codes::INVALID_INPUT_PARAMETER;
+                }
+                m_windows.emplace_back(request.m_data_window->m_start, request.m_data_window->m_stop);
+
+                auto block_list = new CountedBlockListValue(m_live_block_lists);
+                const auto add_block = [this, block_list](std::uint64_t channel_id, std::uint64_t begin, std::uint64_t end)
+                {
+                    if (begin >= end)
+                    {
+                        return;
+                    }
+                    odk::BlockDescriptor bd;
+                    bd.m_stream_id = 1;
+                    bd.m_data_size = (end - begin) * sizeof(double);
+                    odk::BlockChannelDescriptor bcd;
+                    bcd.m_channel_id = channel_id;
+                    bcd.m_offset = 0;
+                    bcd.m_count = end - begin;
+                    bcd.m_first_sample_index = begin;
+                    bcd.m_timestamp = begin;
+                    bcd.m_duration = end - begin;
+                    bd.m_block_channels.push_back(bcd);
+                    const auto samples = m_samples[channel_id - CHANNEL_ID].data() + begin;
+                    if (m_poison_released)
+                    {
+                        block_list->poisonOnRelease(samples, static_cast<std::size_t>(end - begin));
+                    }
+                    block_list->addBlock(new DataBlockValue(bd.generate(), samples, static_cast<int>(bd.m_data_size)));
+                };
+                for (const auto& channel_descriptor : m_data_set)
+                {
+                    const auto channel = channel_descriptor.m_channel_id - CHANNEL_ID;
+                    const auto window_begin = std::max(toSample(request.m_data_window->m_start), m_first_sample + channel * m_channel_delay);
+                    const auto window_end = std::min(toSample(request.m_data_window->m_stop), m_end_sample);
+                    add_block(channel_descriptor.m_channel_id, window_begin, std::min(window_end, m_gap_begin));
+                    add_block(channel_descriptor.m_channel_id, std::max(window_begin, m_gap_end), window_end);
+                }
+                *ret = block_list;
+                return odk::error_codes::OK;
+            }
+
+            case odk::host_msg::DATA_REGIONS_READ:
+            {
+                ++m_region_reads;
+                if (!m_reply_regions)
+                {
+                    return odk::error_codes::OK;
+                }
+                odk::DataRegions data_regions;
+                for (const auto& channel_descriptor : m_data_set)
+                {
+                    const auto channel = channel_descriptor.m_channel_id - CHANNEL_ID;
+                    const auto first_sample = m_first_sample + channel * m_channel_delay;
+                    for (const auto& region : { odk::Interval<std::uint64_t>(first_sample, std::min(m_gap_begin, m_end_sample)),
+                                                odk::Interval<std::uint64_t>(std::max(m_gap_end, first_sample), m_end_sample) })
+                    {
+                        if (region.m_begin < region.m_end)
+                        {
+                            data_regions.m_data_regions.emplace_back(channel_descriptor.m_channel_id, region);
+                        }
+                    }
+                }
+                *ret = new XmlValue(data_regions.generate());
+                return odk::error_codes::OK;
+            }
+
+            case odk::host_msg::DATA_GROUP_REMOVE:
+                m_removed = true;
+                return odk::error_codes::OK;
+
+            default:
+                m_unexpected_message = true;
+                return odk::error_codes::NOT_IMPLEMENTED;
+            }
+        }
+
+        const odk::IfValue* PLUGIN_API query(const char* context, const char* item, const odk::IfValue* param) override
+        {
+            if (boost::algorithm::starts_with(context, "#Oxygen#Channels#") && boost::algorithm::equals(item, "DataFormat"))
+            {
+                odk::ChannelDataformat data_format;
+                data_format.m_sample_dimension = 1;
+                data_format.m_sample_format = odk::ChannelDataformat::SampleFormat::DOUBLE;
+                data_format.m_sample_value_type = odk::ChannelDataformat::SampleValueType::SAMPLE_VALUE_SCALAR;
+                data_format.m_sample_occurrence = odk::ChannelDataformat::SampleOccurrence::SYNC;
+                data_format.m_sample_reduced_format = odk::ChannelDataformat::SampleReducedFormat::UNKNOWN;
+                return new XmlValue(data_format.generate());
+            }
+            if (boost::algorithm::starts_with(context, "#Oxygen#Channels#") && boost::algorithm::equals(item, "Timebase"))
+            {
+                const odk::Timebase timebase(SAMPLE_RATE);
+                return new XmlValue(timebase.generate());
+            }
+            return TestHost::query(context, item, param);
+        }
+
+        std::size_t readCount()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_windows.size();
+        }
+
+        /// waits up to a few seconds for the requester to issue count DATA_READs
+        bool waitForReads(std::size_t count)
+        {
+            for (int attempt = 0; attempt < 500 && readCount() < count; ++attempt)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return readCount() >= count;
+        }
+
+        std::size_t windowCount(double start)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return static_cast<std::size_t>(std::count_if(m_windows.begin(), m_windows.end(),
+                [start](const std::pair<double, double>& window)
+                {
+                    return window.first == start;
+                }));
+        }
+
+        /// waits up to a few seconds for the requester to issue a DATA_READ starting at start
+        bool waitForWindow(double start)
+        {
+            for (int attempt = 0; attempt < 500 && windowCount(start) == 0; ++attempt)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            return windowCount(start) != 0;
+        }
+
+        static std::uint64_t toSample(double time)
+        {
+            return static_cast<std::uint64_t>(std::llround(time * SAMPLE_RATE));
+        }
+
+        const std::uint64_t m_first_sample;
+        const std::uint64_t m_end_sample;
+        const std::uint64_t m_channel_delay;
+        std::uint64_t m_gap_begin = std::numeric_limits<std::uint64_t>::max();
+        std::uint64_t m_gap_end = std::numeric_limits<std::uint64_t>::max();
+        bool m_reply_regions = false;
+        bool m_poison_released = false;
+        int m_region_reads = 0;
+        std::vector<std::vector<double>> m_samples;
+        /// channels of the last data set
+        std::vector<odk::ChannelDescriptor> m_data_set;
+        int m_data_set_count = 0;
+        std::mutex m_mutex;
+        std::vector<std::pair<double, double>> m_windows;
+        std::atomic<int> m_live_block_lists{0};
+        bool m_removed = false;
+        bool m_unexpected_message = false;
+    };
+
+    std::vector<double> readAll(odk::framework::StreamIterator& iterator)
+    {
+        std::vector<double> values;
+        while (iterator.valid())
+        {
+            values.push_back(iterator.value<double>());
+            ++iterator;
+        }
+        return values;
+    }
+
+    struct Range
+    {
+        std::uint64_t m_begin;
+        std::uint64_t m_end;
+        bool m_gap;
+    };
+
+    /// reads the remaining spans of the iterator and merges adjacent spans of the same kind
+    std::vector<Range> readRanges(odk::framework::StreamIterator& iterator)
+    {
+        std::vector<Range> ranges;
+        for (auto span = iterator.nextSpan(); !span.empty(); span = iterator.nextSpan())
+        {
+            const bool gap = span.m_data == nullptr;
+            if (!ranges.empty() && ranges.back().m_gap == gap && ranges.back().m_end == span.m_timestamp)
+            {
+                ranges.back().m_end += span.m_count;
+            }
+            else
+            {
+                ranges.push_back({ span.m_timestamp, span.m_timestamp + span.m_count, gap });
+            }
+        }
+        return ranges;
+    }
+
+    std::vector<double> expectedValues(std::uint64_t begin, std::uint64_t end, std::uint64_t channel = 0)
+    {
+        std::vector<double> values;
+        for (auto sample = begin; sample < end; ++sample)
+        {
+            values.push_back(static_cast<double>(channel) * CHANNEL_VALUE_OFFSET + static_cast<double>(sample));
+        }
+        return values;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(data_requester_test_suite)
+
+BOOST_AUTO_TEST_CASE(PrefetchedDataMatchesSynchronousData)
+{
+    for (std::size_t prefetch_windows : { 0, 1, 3 })
+    {
+        BOOST_TEST_CONTEXT("prefetch windows " << prefetch_windows)
+        {
+            // the windows before 0.25s and after 0.75s are empty and skipped
+            RecordingHost host(250, 750);
+            {
+                odk::framework::DataRequester requester(&host, CHANNEL_ID);
+                requester.setPrefetchWindows(prefetch_windows);
+                requester.setWindowByteBudget(WINDOW_BYTES);
+                auto iterator = requester.getIterator(0.0, 1.0);
+                BOOST_REQUIRE(iterator);
+                const auto values = readAll(*iterator);
+                const auto expected = expectedValues(250, 750);
+                BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+            }
+
+            BOOST_CHECK(host.m_removed);
+            BOOST_CHECK(!host.m_unexpected_message);
+            BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+            // every window is requested once and in order
+            BOOST_REQUIRE(!host.m_windows.empty());
+            BOOST_CHECK_EQUAL(host.m_windows.front().first, 0.0);
+            BOOST_CHECK_EQUAL(host.m_windows.back().second, 1.0);
+            for (std::size_t window = 1; window < host.m_windows.size(); ++window)
+            {
+                BOOST_CHECK_EQUAL(host.m_windows[window].first, host.m_windows[window - 1].second);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(PrefetchStaysWindowCountAhead)
+{
+    RecordingHost host(0, 2000);
+    {
+        odk::framework::DataRequester requester(&host, CHANNEL_ID);
+        requester.setPrefetchWindows(2);
+        requester.setWindowByteBudget(WINDOW_BYTES);
+        auto iterator = requester.getIterator(0.0, 2.0);
+
+        // the first window is in use, the next two are requested in the background
+        BOOST_REQUIRE(host.waitForReads(3));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        BOOST_CHECK_EQUAL(host.readCount(), 3);
+        // the block list of the window in use stays alive next to the prefetched ones
+        BOOST_CHECK_EQUAL(host.m_live_block_lists, 3);
+        BOOST_CHECK_EQUAL(iterator->value<double>(), 0.0);
+
+        // moving into the second window releases the first one and makes room for the fourth
+        for (int sample = 0; sample < 100; ++sample)
+        {
+            ++(*iterator);
+        }
+        BOOST_CHECK_EQUAL(iterator->value<double>(), 100.0);
+        BOOST_REQUIRE(host.waitForReads(4));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        BOOST_CHECK_EQUAL(host.readCount(), 4);
+        BOOST_CHECK_EQUAL(host.m_live_block_lists, 3);
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+    BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+}
+
+BOOST_AUTO_TEST_CASE(PrefetchRestartsForNewInterval)
+{
+    RecordingHost host(0, 2000);
+    {
+        odk::framework::DataRequester requester(&host, CHANNEL_ID);
+        requester.setPrefetchWindows(3);
+        requester.setWindowByteBudget(WINDOW_BYTES);
+        auto iterator = requester.getIterator(0.0, 1.0);
+        BOOST_CHECK_EQUAL(iterator->value<double>(), 0.0);
+
+        // windows prefetched for the first interval are dropped
+        iterator = requester.getIterator(1.5, 1.8);
+        const auto values = readAll(*iterator);
+        const auto expected = expectedValues(1500, 1800);
+        BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+    BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SpansStayReadableUntilNextCall)
+{
+    RecordingHost host(0, 1000);
+    host.m_poison_released = true;
+    {
+        odk::framework::DataRequester requester(&host, CHANNEL_ID);
+        requester.setWindowByteBudget(WINDOW_BYTES);
+        auto iterator = requester.getIterator(0.0, 1.0);
+
+        // each span ends a window, it is read after nextSpan returned
+        std::vector<double> values;
+        for (auto span = iterator->nextSpan(); !span.empty(); span = iterator->nextSpan())
+        {
+            BOOST_REQUIRE(span.m_data);
+            for (std::uint64_t sample = 0; sample < span.m_count; ++sample)
+            {
+                values.push_back(span.value<double>(sample));
+            }
+            // parked at the end of the window until the next call
+            BOOST_CHECK(iterator->valid());
+            BOOST_CHECK(!iterator->data());
+        }
+        const auto expected = expectedValues(0, 1000);
+        BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+        BOOST_CHECK(!iterator->valid());
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+    BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+}
+
+BOOST_AUTO_TEST_CASE(RangesStayReadableUntilNextCall)
+{
+    RecordingHost host(0, 1000);
+    host.m_poison_released = true;
+    {
+        odk::framework::DataRequester requester(&host, CHANNEL_ID);
+        requester.setWindowByteBudget(WINDOW_BYTES);
+        auto iterator = requester.getIterator(0.0, 1.0);
+
+        odk::framework::SyncBlockIterator begin;
+        odk::framework::SyncBlockIterator end;
+        std::vector<double> values;
+        while (iterator->nextRange(begin, end))
+        {
+            for (; begin != end; ++begin)
+            {
+                values.push_back(begin.value<double>());
+            }
+        }
+        const auto expected = expectedValues(0, 1000);
+        BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+        BOOST_CHECK(!iterator->valid());
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+    BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+}
+
+BOOST_AUTO_TEST_CASE(IncrementMovesParkedIteratorToNextWindow)
+{
+    RecordingHost host(0, 300);
+    host.m_poison_released = true;
+    {
+        odk::framework::DataRequester requester(&host, CHANNEL_ID);
+        requester.setWindowByteBudget(WINDOW_BYTES);
+        auto iterator = requester.getIterator(0.0, 0.3);
+
+        auto span = iterator->nextSpan();
+        BOOST_REQUIRE_EQUAL(span.m_count, 100);
+        BOOST_CHECK_EQUAL(span.value<double>(99), 99.0);
+        ++(*iterator);
+        BOOST_CHECK_EQUAL(iterator->value<double>(), 100.0);
+
+        // stepping back out of the parked position stays in the window
+        span = iterator->nextSpan(100);
+        BOOST_REQUIRE_EQUAL(span.m_count, 100);
+        --(*iterator);
+        BOOST_CHECK_EQUAL(iterator->value<double>(), 199.0);
+        const auto values = readAll(*iterator);
+        const auto expected = expectedValues(199, 300);
+        BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+    BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+}
+
+BOOST_AUTO_TEST_CASE(LowerBoundSearchesLoadedWindow)
+{
+    RecordingHost host(0, 1000);
+    {
+        odk::framework::DataRequester requester(&host, CHANNEL_ID);
+        requester.setWindowByteBudget(WINDOW_BYTES);
+        auto iterator = requester.getIterator(0.0, 1.0);
+        BOOST_CHECK_EQUAL(host.readCount(), 1);
+
+        const auto inside = iterator->lowerBound(42);
+        BOOST_REQUIRE(inside.valid());
+        BOOST_CHECK_EQUAL(inside.value<double>(), 42.0);
+
+        // behind the loaded window: the copy does not request data
+        const auto behind = iterator->lowerBound(500);
+        BOOST_CHECK(!behind.valid());
+        BOOST_CHECK_EQUAL(host.readCount(), 1);
+
+        // the iterator itself is not moved and still continues with the requester
+        BOOST_CHECK_EQUAL(iterator->value<double>(), 0.0);
+        BOOST_REQUIRE(iterator->seek(500));
+        BOOST_CHECK_EQUAL(iterator->value<double>(), 500.0);
+        const auto values = readAll(*iterator);
+        const auto expected = expectedValues(500, 1000);
+        BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+    BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+}
+
+BOOST_AUTO_TEST_CASE(WindowLengthFollowsByteBudget)
+{
+    RecordingHost host(0, 10000);
+    {
+        odk::framework::DataRequester requester(&host, CHANNEL_ID);
+        // derived from the sample rate before the first request
+        BOOST_CHECK_CLOSE(requester.getStatistics().m_window_length, odk::framework::DataRequester::DEFAULT_WINDOW_BYTES / 8000.0, 1e-6);
+
+        requester.setWindowByteBudget(4000);
+        BOOST_CHECK_CLOSE(requester.getStatistics().m_window_length, 0.5, 1e-6);
+
+        auto iterator = requester.getIterator(0.0, 10.0);
+        const auto values = readAll(*iterator);
+        BOOST_CHECK_EQUAL(values.size(), 10000);
+
+        const auto statistics = requester.getStatistics();
+        BOOST_CHECK_EQUAL(statistics.m_requests, host.readCount());
+        BOOST_CHECK_EQUAL(statistics.m_requests, 20);
+        BOOST_CHECK_EQUAL(statistics.m_empty_requests, 0);
+        BOOST_CHECK_EQUAL(statistics.m_blocks, 20);
+        BOOST_CHECK_EQUAL(statistics.m_bytes, 10000 * sizeof(double));
+        BOOST_CHECK_CLOSE(statistics.m_window_length, 0.5, 1e-6);
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+}
+
+BOOST_AUTO_TEST_CASE(WindowsGrowAcrossMissingData)
+{
+    for (std::size_t prefetch_windows : { 0, 2 })
+    {
+        BOOST_TEST_CONTEXT("prefetch windows " << prefetch_windows)
+        {
+            // one second of data in the middle of 100 seconds
+            RecordingHost host(50000, 51000);
+            {
+                odk::framework::DataRequester requester(&host, CHANNEL_ID);
+                requester.setPrefetchWindows(prefetch_windows);
+                requester.setWindowByteBudget(WINDOW_BYTES);
+                auto iterator = requester.getIterator(0.0, 100.0);
+                const auto values = readAll(*iterator);
+                const auto expected = expectedValues(50000, 51000);
+                BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+
+                // 1000 windows of 0.1 seconds without adaption
+                const auto statistics = requester.getStatistics();
+                BOOST_CHECK_EQUAL(statistics.m_requests, host.readCount());
+                BOOST_CHECK_LT(statistics.m_requests, 50);
+                BOOST_CHECK_EQUAL(statistics.m_bytes, 1000 * sizeof(double));
+                BOOST_CHECK_EQUAL(statistics.m_empty_requests + statistics.m_blocks, statistics.m_requests);
+            }
+            BOOST_CHECK(!host.m_unexpected_message);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ChannelsShareOneDataSet)
+{
+    for (std::size_t prefetch_windows : { 0, 2 })
+    {
+        BOOST_TEST_CONTEXT("prefetch windows " << prefetch_windows)
+        {
+            // channel n starts n * 0.3 seconds later, the unknown channel 99 is left out
+            RecordingHost host(0, 2000, 3, 300);
+            {
+                odk::framework::DataRequester requester(&host, { CHANNEL_ID, CHANNEL_ID + 1, 99, CHANNEL_ID + 2 });
+                requester.setPrefetchWindows(prefetch_windows);
+                // 100 samples of each of the three channels
+                requester.setWindowByteBudget(3 * WINDOW_BYTES);
+                auto iterators = requester.getIterators(0.0, 2.0);
+                BOOST_REQUIRE_EQUAL(iterators.size(), 3);
+                BOOST_CHECK_EQUAL(host.m_data_set_count, 1);
+
+                // advance the channels alongside each other, by timestamp
+                std::vector<std::vector<double>> values(3);
+                for (;;)
+                {
+                    std::uint64_t next_channel = 3;
+                    for (std::uint64_t channel = 0; channel < 3; ++channel)
+                    {
+                        const auto& iterator = *iterators[CHANNEL_ID + channel];
+                        if (iterator.valid() && (next_channel == 3 || iterator.timestamp() < iterators[CHANNEL_ID + next_channel]->timestamp()))
+                        {
+                            next_channel = channel;
+                        }
+                    }
+                    if (next_channel == 3)
+                    {
+                        break;
+                    }
+                    auto& iterator = *iterators[CHANNEL_ID + next_channel];
+                    values[next_channel].push_back(iterator.value<double>());
+                    ++iterator;
+                    // the windows between the slowest and the fastest channel and the prefetched ones
+                    BOOST_CHECK_LE(host.m_live_block_lists, 5 + static_cast<int>(prefetch_windows));
+                }
+
+                for (std::uint64_t channel = 0; channel < 3; ++channel)
+                {
+                    const auto expected = expectedValues(channel * 300, 2000, channel);
+                    BOOST_CHECK_EQUAL_COLLECTIONS(values[channel].begin(), values[channel].end(), expected.begin(), expected.end());
+                }
+                // every window is read once for all channels
+                BOOST_CHECK_EQUAL(requester.getStatistics().m_requests, host.readCount());
+                BOOST_CHECK_LT(host.readCount(), 30);
+            }
+            BOOST_CHECK(host.m_removed);
+            BOOST_CHECK(!host.m_unexpected_message);
+            BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ChannelsReadOneAfterAnother)
+{
+    RecordingHost host(0, 1000, 2, 500);
+    {
+        odk::framework::DataRequester requester(&host, { CHANNEL_ID, CHANNEL_ID + 1 });
+        requester.setPrefetchWindows(1);
+        requester.setWindowByteBudget(WINDOW_BYTES);
+        auto iterators = requester.getIterators(0.0, 1.0);
+
+        // the windows stay available until the second channel has passed them
+        const auto first_values = readAll(*iterators[CHANNEL_ID]);
+        const auto second_values = readAll(*iterators[CHANNEL_ID + 1]);
+        const auto first_expected = expectedValues(0, 1000, 0);
+        const auto second_expected = expectedValues(500, 1000, 1);
+        BOOST_CHECK_EQUAL_COLLECTIONS(first_values.begin(), first_values.end(), first_expected.begin(), first_expected.end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(second_values.begin(), second_values.end(), second_expected.begin(), second_expected.end());
+
+        // a single channel requester reports a missing channel
+        odk::framework::DataRequester missing_requester(&host, 99);
+        BOOST_CHECK_THROW(missing_requester.getIterator(0.0, 1.0), std::runtime_error);
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+    BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsAreReadOncePerInterval)
+{
+    for (std::size_t prefetch_windows : { 0, 2 })
+    {
+        BOOST_TEST_CONTEXT("prefetch windows " << prefetch_windows)
+        {
+            RecordingHost host(0, 1000);
+            host.m_gap_begin = 300;
+            host.m_gap_end = 500;
+            host.m_reply_regions = true;
+            {
+                odk::framework::DataRequester requester(&host, CHANNEL_ID);
+                requester.setPrefetchWindows(prefetch_windows);
+                requester.setWindowByteBudget(WINDOW_BYTES);
+
+                // gaps are skipped by default
+                auto iterator = requester.getIterator(0.0, 1.2);
+                auto values = readAll(*iterator);
+                auto expected = expectedValues(0, 300);
+                const auto expected_end = expectedValues(500, 1000);
+                expected.insert(expected.end(), expected_end.begin(), expected_end.end());
+                BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+                BOOST_CHECK_EQUAL(host.m_region_reads, 1);
+                BOOST_CHECK_GT(host.readCount(), 1);
+
+                // the missing data and the end of the interval without data are reported as gaps
+                iterator = requester.getIterator(0.2, 1.2);
+                iterator->setSkipGaps(false);
+                const auto ranges = readRanges(*iterator);
+                BOOST_REQUIRE_EQUAL(ranges.size(), 4);
+                const Range expected_ranges[] = { { 200, 300, false }, { 300, 500, true }, { 500, 1000, false }, { 1000, 1200, true } };
+                for (std::size_t range = 0; range < ranges.size(); ++range)
+                {
+                    BOOST_CHECK_EQUAL(ranges[range].m_begin, expected_ranges[range].m_begin);
+                    BOOST_CHECK_EQUAL(ranges[range].m_end, expected_ranges[range].m_end);
+                    BOOST_CHECK_EQUAL(ranges[range].m_gap, expected_ranges[range].m_gap);
+                }
+                BOOST_CHECK_EQUAL(host.m_region_reads, 2);
+            }
+            BOOST_CHECK(!host.m_unexpected_message);
+            BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(DataWithoutRegionsHasNoGaps)
+{
+    RecordingHost host(0, 500);
+    {
+        odk::framework::DataRequester requester(&host, CHANNEL_ID);
+        requester.setWindowByteBudget(WINDOW_BYTES);
+        auto iterator = requester.getIterator(0.0, 0.5);
+        iterator->setSkipGaps(false);
+        const auto ranges = readRanges(*iterator);
+        BOOST_REQUIRE_EQUAL(ranges.size(), 1);
+        BOOST_CHECK_EQUAL(ranges[0].m_begin, 0);
+        BOOST_CHECK_EQUAL(ranges[0].m_end, 500);
+        BOOST_CHECK(!ranges[0].m_gap);
+        BOOST_CHECK_EQUAL(host.m_region_reads, 1);
+    }
+    BOOST_CHECK(!host.m_unexpected_message);
+}
+
+BOOST_AUTO_TEST_CASE(NextIntervalIsPrefetched)
+{
+    for (std::size_t prefetch_windows : { 0, 2 })
+    {
+        BOOST_TEST_CONTEXT("prefetch windows " << prefetch_windows)
+        {
+            RecordingHost host(0, 3000);
+            {
+                odk::framework::DataRequester requester(&host, CHANNEL_ID);
+                requester.setPrefetchWindows(prefetch_windows);
+                requester.setWindowByteBudget(WINDOW_BYTES);
+
+                auto iterator = requester.getIterator(0.0, 0.3);
+                requester.setNextInterval(1.0, 1.3);
+                auto values = readAll(*iterator);
+                auto expected = expectedValues(0, 300);
+                BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+                if (prefetch_windows > 0)
+                {
+                    // requested while the first interval was read
+                    BOOST_CHECK(host.waitForWindow(1.0));
+                }
+
+                iterator = requester.getIterator(1.0, 1.3);
+                requester.setNextInterval(2.0, 2.3);
+                values = readAll(*iterator);
+                expected = expectedValues(1000, 1300);
+                BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+                BOOST_CHECK_EQUAL(host.windowCount(1.0), 1);
+
+                // windows prefetched for an interval that is not requested are dropped
+                iterator = requester.getIterator(2.5, 2.7);
+                values = readAll(*iterator);
+                expected = expectedValues(2500, 2700);
+                BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+                BOOST_CHECK_EQUAL(host.m_region_reads, 3);
+            }
+            BOOST_CHECK(!host.m_unexpected_message);
+            BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
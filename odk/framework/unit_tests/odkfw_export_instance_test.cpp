@@ -1,6 +1,9 @@
 // Copyright DEWETRON GmbH 2021
 #include "odkfw_export_instance.h"
 #include "odkfw_export_plugin.h"
+#include "odkapi_block_descriptor_xml.h"
+#include "odkapi_data_set_descriptor_xml.h"
+#include "odkapi_data_set_xml.h"
 #include "odkapi_export_xml.h"
 #include "test_host.h"
 #include "values.h"
@@ -8,6 +11,17 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
 namespace
 {
     class FixtureHost : public TestHost
@@ -142,6 +156,664 @@ namespace
     };
 }
 
+namespace
+{
+    /**
+     * Records the notifications of an export, they are sent from the export threads
+     * so no test assertions are used in messageSync
+     */
+    class ExportHost : public FixtureHost
+    {
+    public:
+        odk::IfValue* PLUGIN_API createValue(odk::IfValue::Type type) const override
+        {
+            if (type == odk::IfValue::Type::TYPE_UINT)
+            {
+                return new UIntValue(0);
+            }
+            return TestHost::createValue(type);
+        }
+
+        std::uint64_t PLUGIN_API messageSync(odk::MessageId msg_id, std::uint64_t key, const odk::IfValue* param, const odk::IfValue** ret) override
+        {
+            ODK_UNUSED(key);
+            if (ret)
+            {
+                *ret = nullptr;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            switch (msg_id)
+            {
+            case odk::host_msg::EXPORT_PROGRESS:
+                if (auto progress = dynamic_cast<const odk::IfUIntValue*>(param))
+                {
+                    m_progress.push_back(progress->getValue());
+                }
+                break;
+            case odk::host_msg::EXPORT_FINISHED:
+                ++m_finished;
+                break;
+            case odk::host_msg::EXPORT_FAILED:
+                ++m_failed;
+                break;
+            default:
+                // registration and data requests without data
+                break;
+            }
+            return odk::error_codes::OK;
+        }
+
+        std::mutex m_mutex;
+        std::vector<std::uint64_t> m_progress;
+        int m_finished = 0;
+        int m_failed = 0;
+    };
+
+    const std::size_t TASK_COUNT = 8;
+
+    /**
+     * Runs TASK_COUNT tasks in parallel, tasks wait for a cancellation if s_wait_for_cancel is set
+     */
+    class ParallelInstance : public odk::framework::ExportInstance
+    {
+    public:
+        static odk::RegisterExport getExportInfo()
+        {
+            odk::RegisterExport info;
+            info.m_format_id = "ParallelFormat";
+            info.m_file_extension = "bin";
+            return info;
+        }
+
+        void validate(const ValidationContext&, odk::ValidateExportResponse& response) const override
+        {
+            response.m_success = true;
+        }
+
+        bool exportData(const ProcessingContext&) override
+        {
+            runParallel(TASK_COUNT, [this](std::size_t task_index)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(s_mutex);
+                    s_threads.insert(std::this_thread::get_id());
+                    s_tasks.push_back(task_index);
+                }
+                for (int step = 1; step <= 4; ++step)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                    notifyTaskProgress(task_index, step / 4.0);
+                }
+                while (s_wait_for_cancel && !isCanceled())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            });
+            return true;
+        }
+
+        void cancel() override
+        {
+        }
+
+        static std::mutex s_mutex;
+        static std::set<std::thread::id> s_threads;
+        static std::vector<std::size_t> s_tasks;
+        static std::atomic<bool> s_wait_for_cancel;
+    };
+
+    std::mutex ParallelInstance::s_mutex;
+    std::set<std::thread::id> ParallelInstance::s_threads;
+    std::vector<std::size_t> ParallelInstance::s_tasks;
+    std::atomic<bool> ParallelInstance::s_wait_for_cancel(false);
+
+    class ParallelFixture
+    {
+    public:
+        ParallelFixture()
+        {
+            ParallelInstance::s_threads.clear();
+            ParallelInstance::s_tasks.clear();
+            ParallelInstance::s_wait_for_cancel = false;
+            static_cast<odk::IfPlugin*>(&plugin)->setPluginHost(&host);
+            const odk::IfValue* init_result = nullptr;
+            static_cast<odk::IfPlugin*>(&plugin)->pluginMessage(odk::plugin_msg::INIT, 0, nullptr, &init_result);
+        }
+
+        ~ParallelFixture()
+        {
+            const odk::IfValue* deinit_result = nullptr;
+            static_cast<odk::IfPlugin*>(&plugin)->pluginMessage(odk::plugin_msg::DEINIT, 0, nullptr, &deinit_result);
+        }
+
+        void startExport(std::uint64_t worker_threads)
+        {
+            odk::StartExport start_telegram;
+            start_telegram.m_transaction_id = TRANSACTION_ID;
+            start_telegram.m_properties.m_format_id = "ParallelFormat";
+            start_telegram.m_properties.m_filename = "filename.bin";
+            start_telegram.m_properties.m_export_intervals.emplace_back(0, 1);
+            start_telegram.m_properties.m_channels.push_back(1);
+            start_telegram.m_properties.m_custom_properties.setUnsigned("WORKER_THREADS", worker_threads);
+
+            auto start_xml = static_cast<odk::IfXMLValue*>(host.createValue(odk::IfXMLValue::type_index));
+            start_xml->set(start_telegram.generate().c_str());
+            const odk::IfValue* start_result = nullptr;
+            const auto ret = static_cast<odk::IfPlugin*>(&plugin)->pluginMessage(odk::plugin_msg::EXPORT_START, 0, start_xml, &start_result);
+            start_xml->release();
+            BOOST_CHECK_EQUAL(ret, odk::error_codes::OK);
+        }
+
+        void sendMessage(odk::PluginMessageId msg_id)
+        {
+            const odk::IfValue* result = nullptr;
+            static_cast<odk::IfPlugin*>(&plugin)->pluginMessage(msg_id, TRANSACTION_ID, nullptr, &result);
+        }
+
+        static const std::uint64_t TRANSACTION_ID = 5;
+
+        ExportHost host;
+        odk::framework::ExportPlugin<ParallelInstance> plugin;
+    };
+}
+
+namespace
+{
+    const std::uint64_t DATA_CHANNEL_COUNT = 3;
+    const double DATA_SAMPLE_RATE = 1000000;
+
+    /**
+     * Block list that owns the samples of its blocks and counts the lists alive
+     */
+    class OwningBlockListValue : public DataBlockListValue
+    {
+    public:
+        OwningBlockListValue(std::atomic<int>& live_count, std::atomic<int>& max_live_count)
+            : DataBlockListValue("<BlockListDescriptor/>")
+            , m_live_count(live_count)
+        {
+            const int live = ++m_live_count;
+            int max_live = max_live_count.load();
+            while (live > max_live && !max_live_count.compare_exchange_weak(max_live, live))
+            {
+            }
+        }
+
+        ~OwningBlockListValue()
+        {
+            --m_live_count;
+        }
+
+        void addSamples(std::uint64_t channel_id, std::uint64_t begin, std::uint64_t end)
+        {
+            m_samples.emplace_back();
+            auto& samples = m_samples.back();
+            for (auto sample = begin; sample < end; ++sample)
+            {
+                samples.push_back(static_cast<double>(sample));
+            }
+
+            odk::BlockDescriptor bd;
+            bd.m_stream_id = channel_id;
+            bd.m_data_size = samples.size() * sizeof(double);
+            odk::BlockChannelDescriptor bcd;
+            bcd.m_channel_id = channel_id;
+            bcd.m_offset = 0;
+            bcd.m_count = end - begin;
+            bcd.m_first_sample_index = begin;
+            bcd.m_timestamp = begin;
+            bcd.m_duration = end - begin;
+            bd.m_block_channels.push_back(bcd);
+            addBlock(new DataBlockValue(bd.generate(), samples.data(), static_cast<int>(bd.m_data_size)));
+        }
+
+    private:
+        std::atomic<int>& m_live_count;
+        std::vector<std::vector<double>> m_samples;
+    };
+
+    /**
+     * Export host with DATA_CHANNEL_COUNT recorded double channels whose sample values are their sample indices
+     * Every channel is a stream of its own, data sets and block lists alive are counted.
+     * The channels are sampled at DATA_SAMPLE_RATE unless m_sample_rates sets another rate.
+     */
+    class DataExportHost : public ExportHost
+    {
+    public:
+        std::uint64_t PLUGIN_API messageSync(odk::MessageId msg_id, std::uint64_t key, const odk::IfValue* param, const odk::IfValue** ret) override
+        {
+            switch (msg_id)
+            {
+            case odk::host_msg::DATA_GROUP_ADD:
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto xml_param = dynamic_cast<const odk::IfXMLValue*>(param);
+                odk::PluginDataSet request;
+                if (!xml_param || !request.parse(xml_param->getValue()))
+                {
+                    return odk::error_codes::INVALID_INPUT_PARAMETER;
+                }
+                odk::DataSetDescriptor descriptor;
+                descriptor.m_id = m_data_sets.size() + 1;
+                for (const auto channel_id : request.m_channels)
+                {
+                    odk::StreamDescriptor stream_descriptor;
+                    stream_descriptor.m_stream_id = channel_id;
+                    odk::ChannelDescriptor channel_descriptor;
+                    channel_descriptor.m_channel_id = channel_id;
+                    channel_descriptor.m_dimension = 1;
+                    channel_descriptor.m_stride = 64;
+                    channel_descriptor.m_size = 64;
+                    channel_descriptor.m_type = odk::SampleType::DOUBLE;
+                    stream_descriptor.m_channel_descriptors.push_back(channel_descriptor);
+                    descriptor.m_stream_descriptors.push_back(stream_descriptor);
+                }
+                m_data_sets[descriptor.m_id] = request.m_channels;
+                *ret = new XmlValue(descriptor.generate());
+                return odk::error_codes::OK;
+            }
+
+            case odk::host_msg::DATA_READ:
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto xml_param = dynamic_cast<const odk::IfXMLValue*>(param);
+                odk::PluginDataRequest request;
+                if (!xml_param || !request.parse(xml_param->getValue()) || !request.m_data_window || m_data_sets.count(request.m_id) == 0)
+                {
+                    return odk::error_codes::INVALID_INPUT_PARAMETER;
+                }
+                ++m_reads;
+                auto block_list = new OwningBlockListValue(m_live_block_lists, m_max_live_block_lists);
+                for (const auto channel_id : m_data_sets[request.m_id])
+                {
+                    const auto begin = toSample(request.m_data_window->m_start, sampleRate(channel_id));
+                    const auto end = std::min(toSample(request.m_data_window->m_stop, sampleRate(channel_id)), sampleCount(channel_id));
+                    if (begin < end)
+                    {
+                        block_list->addSamples(channel_id, begin, end);
+                    }
+                }
+                *ret = block_list;
+                return odk::error_codes::OK;
+            }
+
+            case odk::host_msg::DATA_REGIONS_READ:
+            case odk::host_msg::DATA_GROUP_REMOVE:
+                if (ret)
+                {
+                    *ret = nullptr;
+                }
+                return odk::error_codes::OK;
+
+            default:
+                return ExportHost::messageSync(msg_id, key, param, ret);
+            }
+        }
+
+        const odk::IfValue* PLUGIN_API query(const char* context, const char* item, const odk::IfValue* param) override
+        {
+            if (boost::algorithm::starts_with(context, "#Oxygen#Channels#"))
+            {
+                const std::uint64_t channel_id = std::strtoull(context + std::strlen("#Oxygen#Channels#"), nullptr, 10);
+                if (boost::algorithm::equals(item, "DataFormat"))
+                {
+                    odk::ChannelDataformat data_format;
+                    data_format.m_sample_dimension = 1;
+                    data_format.m_sample_format = odk::ChannelDataformat::SampleFormat::DOUBLE;
+                    data_format.m_sample_value_type = odk::ChannelDataformat::SampleValueType::SAMPLE_VALUE_SCALAR;
+                    data_format.m_sample_occurrence = odk::ChannelDataformat::SampleOccurrence::SYNC;
+                    data_format.m_sample_reduced_format = odk::ChannelDataformat::SampleReducedFormat::UNKNOWN;
+                    return new XmlValue(data_format.generate());
+                }
+                if (boost::algorithm::equals(item, "Timebase"))
+                {
+                    const odk::Timebase timebase(sampleRate(channel_id));
+                    return new XmlValue(timebase.generate());
+                }
+                if (boost::algorithm::equals(item, "SampleRate"))
+                {
+                    return new ScalarValue(sampleRate(channel_id), "Hz");
+                }
+            }
+            return TestHost::query(context, item, param);
+        }
+
+        static std::uint64_t toSample(double time, double sample_rate = DATA_SAMPLE_RATE)
+        {
+            return static_cast<std::uint64_t>(std::llround(time * sample_rate));
+        }
+
+        double sampleRate(std::uint64_t channel_id) const
+        {
+            const auto sample_rate = m_sample_rates.find(channel_id);
+            return sample_rate != m_sample_rates.end() ? sample_rate->second : DATA_SAMPLE_RATE;
+        }
+
+        /// samples recorded in the first second
+        std::uint64_t sampleCount(std::uint64_t channel_id) const
+        {
+            return toSample(1.0, sampleRate(channel_id));
+        }
+
+        std::map<std::uint64_t, double> m_sample_rates;
+        std::map<std::uint64_t, std::vector<std::uint64_t>> m_data_sets;
+        int m_reads = 0;
+        std::atomic<int> m_live_block_lists{0};
+        std::atomic<int> m_max_live_block_lists{0};
+    };
+
+    /**
+     * Reads the channels one after another, in one task per channel if s_task_per_channel is set
+     * With s_read_frames set all channels are read alongside each other, one sample of every channel per frame,
+     * as the WAV export does without resampling.
+     */
+    class ChannelReaderInstance : public odk::framework::ExportInstance
+    {
+    public:
+        ChannelReaderInstance()
+        {
+            setGroupChannels(s_group_channels);
+        }
+
+        static odk::RegisterExport getExportInfo()
+        {
+            odk::RegisterExport info;
+            info.m_format_id = "ChannelReaderFormat";
+            info.m_file_extension = "bin";
+            return info;
+        }
+
+        void validate(const ValidationContext&, odk::ValidateExportResponse& response) const override
+        {
+            response.m_success = true;
+        }
+
+        void configureExport(const ValidationContext& context) override
+        {
+            if (s_group_equal_rates)
+            {
+                setGroupChannels(haveEqualSampleRates(context));
+            }
+        }
+
+        bool exportData(const ProcessingContext& context) override
+        {
+            const std::vector<std::pair<std::uint64_t, std::shared_ptr<odk::framework::StreamIterator>>> channels(
+                context.m_channel_iterators.begin(), context.m_channel_iterators.end());
+            if (s_read_frames)
+            {
+                readFrames(channels);
+                return true;
+            }
+            const auto read_channel = [&channels](std::size_t channel_index)
+            {
+                auto& iterator = *channels[channel_index].second;
+                std::uint64_t count = 0;
+                bool in_order = true;
+                for (auto span = iterator.nextSpan(); !span.empty(); span = iterator.nextSpan())
+                {
+                    in_order = in_order && span.m_data && span.value<double>(0) == static_cast<double>(count);
+                    count += span.m_count;
+                }
+                std::lock_guard<std::mutex> lock(s_mutex);
+                s_sample_counts[channels[channel_index].first] = in_order ? count : 0;
+            };
+
+            if (s_task_per_channel)
+            {
+                runParallel(channels.size(), read_channel);
+            }
+            else
+            {
+                for (std::size_t channel_index = 0; channel_index < channels.size(); ++channel_index)
+                {
+                    read_channel(channel_index);
+                }
+            }
+            return true;
+        }
+
+        void cancel() override
+        {
+        }
+
+        static void readFrames(const std::vector<std::pair<std::uint64_t, std::shared_ptr<odk::framework::StreamIterator>>>& channels)
+        {
+            std::vector<std::uint64_t> counts(channels.size(), 0);
+            std::vector<bool> in_order(channels.size(), true);
+            for (bool valid = true; valid;)
+            {
+                valid = false;
+                for (std::size_t channel_index = 0; channel_index < channels.size(); ++channel_index)
+                {
+                    auto& iterator = *channels[channel_index].second;
+                    if (iterator.valid())
+                    {
+                        in_order[channel_index] = in_order[channel_index] && iterator.value<double>() == static_cast<double>(counts[channel_index]);
+                        ++counts[channel_index];
+                        ++iterator;
+                        valid = true;
+                    }
+                }
+            }
+            std::lock_guard<std::mutex> lock(s_mutex);
+            for (std::size_t channel_index = 0; channel_index < channels.size(); ++channel_index)
+            {
+                s_sample_counts[channels[channel_index].first] = in_order[channel_index] ? counts[channel_index] : 0;
+            }
+        }
+
+        static bool s_group_channels;
+        /// groups the channels in configureExport if they share one sample rate
+        static bool s_group_equal_rates;
+        static bool s_task_per_channel;
+        static bool s_read_frames;
+        static std::mutex s_mutex;
+        /// samples read per channel, 0 if they were not read in order
+        static std::map<std::uint64_t, std::uint64_t> s_sample_counts;
+    };
+
+    bool ChannelReaderInstance::s_group_channels = false;
+    bool ChannelReaderInstance::s_group_equal_rates = false;
+    bool ChannelReaderInstance::s_task_per_channel = false;
+    bool ChannelReaderInstance::s_read_frames = false;
+    std::mutex ChannelReaderInstance::s_mutex;
+    std::map<std::uint64_t, std::uint64_t> ChannelReaderInstance::s_sample_counts;
+
+    class ChannelReaderFixture
+    {
+    public:
+        ChannelReaderFixture()
+        {
+            ChannelReaderInstance::s_group_channels = false;
+            ChannelReaderInstance::s_group_equal_rates = false;
+            ChannelReaderInstance::s_task_per_channel = false;
+            ChannelReaderInstance::s_read_frames = false;
+            ChannelReaderInstance::s_sample_counts.clear();
+            static_cast<odk::IfPlugin*>(&plugin)->setPluginHost(&host);
+            const odk::IfValue* init_result = nullptr;
+            static_cast<odk::IfPlugin*>(&plugin)->pluginMessage(odk::plugin_msg::INIT, 0, nullptr, &init_result);
+        }
+
+        ~ChannelReaderFixture()
+        {
+            const odk::IfValue* deinit_result = nullptr;
+            static_cast<odk::IfPlugin*>(&plugin)->pluginMessage(odk::plugin_msg::DEINIT, 0, nullptr, &deinit_result);
+        }
+
+        /// exports one second of all channels and waits for the export to finish
+        void runExport(std::uint64_t worker_threads)
+        {
+            odk::StartExport start_telegram;
+            start_telegram.m_transaction_id = TRANSACTION_ID;
+            start_telegram.m_properties.m_format_id = "ChannelReaderFormat";
+            start_telegram.m_properties.m_filename = "filename.bin";
+            start_telegram.m_properties.m_export_intervals.emplace_back(0, 1);
+            for (std::uint64_t channel_id = 1; channel_id <= DATA_CHANNEL_COUNT; ++channel_id)
+            {
+                start_telegram.m_properties.m_channels.push_back(channel_id);
+            }
+            start_telegram.m_properties.m_custom_properties.setUnsigned("WORKER_THREADS", worker_threads);
+
+            auto start_xml = static_cast<odk::IfXMLValue*>(host.createValue(odk::IfXMLValue::type_index));
+            start_xml->set(start_telegram.generate().c_str());
+            const odk::IfValue* result = nullptr;
+            const auto ret = static_cast<odk::IfPlugin*>(&plugin)->pluginMessage(odk::plugin_msg::EXPORT_START, 0, start_xml, &result);
+            start_xml->release();
+            BOOST_CHECK_EQUAL(ret, odk::error_codes::OK);
+            static_cast<odk::IfPlugin*>(&plugin)->pluginMessage(odk::plugin_msg::EXPORT_FINALIZE, TRANSACTION_ID, nullptr, &result);
+
+            BOOST_CHECK_EQUAL(host.m_finished, 1);
+            BOOST_CHECK_EQUAL(host.m_live_block_lists, 0);
+            BOOST_REQUIRE_EQUAL(ChannelReaderInstance::s_sample_counts.size(), DATA_CHANNEL_COUNT);
+            for (const auto& sample_count : ChannelReaderInstance::s_sample_counts)
+            {
+                BOOST_CHECK_EQUAL(sample_count.second, host.sampleCount(sample_count.first));
+            }
+        }
+
+        static const std::uint64_t TRANSACTION_ID = 7;
+
+        DataExportHost host;
+        odk::framework::ExportPlugin<ChannelReaderInstance> plugin;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(export_channel_reader_test_suite, ChannelReaderFixture)
+
+BOOST_AUTO_TEST_CASE(ChannelsHaveDataSetsOfTheirOwnByDefault)
+{
+    runExport(1);
+
+    BOOST_CHECK_EQUAL(host.m_data_sets.size(), DATA_CHANNEL_COUNT);
+    // reading one channel after another keeps the window in use and the next one of each channel at most
+    BOOST_CHECK_GT(host.m_reads, static_cast<int>(4 * DATA_CHANNEL_COUNT));
+    BOOST_CHECK_LE(host.m_max_live_block_lists, static_cast<int>(2 * DATA_CHANNEL_COUNT));
+}
+
+BOOST_AUTO_TEST_CASE(TaskPerChannelKeepsWindowsBounded)
+{
+    ChannelReaderInstance::s_task_per_channel = true;
+    runExport(DATA_CHANNEL_COUNT);
+
+    BOOST_CHECK_EQUAL(host.m_data_sets.size(), DATA_CHANNEL_COUNT);
+    // a slow task does not hold back the windows of the other channels
+    BOOST_CHECK_LE(host.m_max_live_block_lists, static_cast<int>(2 * DATA_CHANNEL_COUNT));
+
+    // a single worker runs the tasks one after another
+    ChannelReaderInstance::s_sample_counts.clear();
+    host.m_finished = 0;
+    host.m_max_live_block_lists = 0;
+    runExport(1);
+    BOOST_CHECK_LE(host.m_max_live_block_lists, static_cast<int>(2 * DATA_CHANNEL_COUNT));
+}
+
+BOOST_AUTO_TEST_CASE(GroupedChannelsShareOneDataSet)
+{
+    ChannelReaderInstance::s_group_channels = true;
+    runExport(1);
+
+    BOOST_CHECK_EQUAL(host.m_data_sets.size(), 1);
+    BOOST_CHECK_GT(host.m_reads, 4);
+    // the windows stay loaded until the last channel has passed them
+    BOOST_CHECK_GT(host.m_max_live_block_lists, static_cast<int>(2 * DATA_CHANNEL_COUNT));
+}
+
+BOOST_AUTO_TEST_CASE(FramesOfEqualRatesShareOneDataSet)
+{
+    ChannelReaderInstance::s_group_equal_rates = true;
+    ChannelReaderInstance::s_read_frames = true;
+    runExport(1);
+
+    BOOST_CHECK_EQUAL(host.m_data_sets.size(), 1);
+    // the iterators stay at the same time
+    BOOST_CHECK_LE(host.m_max_live_block_lists, 2);
+}
+
+BOOST_AUTO_TEST_CASE(FramesOfMixedRatesKeepWindowsBounded)
+{
+    // the slow channel runs ahead in time when every channel advances one sample per frame
+    host.m_sample_rates[2] = DATA_SAMPLE_RATE / 10;
+    ChannelReaderInstance::s_group_equal_rates = true;
+    ChannelReaderInstance::s_read_frames = true;
+    runExport(1);
+
+    BOOST_CHECK_EQUAL(host.m_data_sets.size(), DATA_CHANNEL_COUNT);
+    BOOST_CHECK_LE(host.m_max_live_block_lists, static_cast<int>(2 * DATA_CHANNEL_COUNT));
+
+    // one data set for all of them keeps the windows the slow channel has passed
+    ChannelReaderInstance::s_group_equal_rates = false;
+    ChannelReaderInstance::s_group_channels = true;
+    ChannelReaderInstance::s_sample_counts.clear();
+    host.m_finished = 0;
+    host.m_max_live_block_lists = 0;
+    runExport(1);
+    BOOST_CHECK_GT(host.m_max_live_block_lists, static_cast<int>(2 * DATA_CHANNEL_COUNT));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_FIXTURE_TEST_SUITE(export_worker_pool_test_suite, ParallelFixture)
+
+BOOST_AUTO_TEST_CASE(TasksRunOnWorkerThreads)
+{
+    startExport(4);
+    sendMessage(odk::plugin_msg::EXPORT_FINALIZE);
+
+    BOOST_CHECK_EQUAL(host.m_finished, 1);
+    BOOST_CHECK_EQUAL(host.m_failed, 0);
+
+    auto tasks = ParallelInstance::s_tasks;
+    std::sort(tasks.begin(), tasks.end());
+    BOOST_REQUIRE_EQUAL(tasks.size(), TASK_COUNT);
+    for (std::size_t task = 0; task < TASK_COUNT; ++task)
+    {
+        BOOST_CHECK_EQUAL(tasks[task], task);
+    }
+    BOOST_CHECK_GT(ParallelInstance::s_threads.size(), 1);
+    BOOST_CHECK_LE(ParallelInstance::s_threads.size(), 4);
+
+    // aggregated over all tasks
+    BOOST_REQUIRE(!host.m_progress.empty());
+    BOOST_CHECK(std::is_sorted(host.m_progress.begin(), host.m_progress.end()));
+    BOOST_CHECK_EQUAL(host.m_progress.back(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(TasksRunOnExportThreadByDefault)
+{
+    startExport(1);
+    sendMessage(odk::plugin_msg::EXPORT_FINALIZE);
+
+    BOOST_CHECK_EQUAL(host.m_finished, 1);
+    BOOST_CHECK_EQUAL(ParallelInstance::s_tasks.size(), TASK_COUNT);
+    BOOST_CHECK_EQUAL(ParallelInstance::s_threads.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(CancelStopsAllWorkers)
+{
+    ParallelInstance::s_wait_for_cancel = true;
+    startExport(2);
+    for (int attempt = 0; attempt < 500; ++attempt)
+    {
+        {
+            std::lock_guard<std::mutex> lock(ParallelInstance::s_mutex);
+            if (ParallelInstance::s_tasks.size() == 2)
+            {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    sendMessage(odk::plugin_msg::EXPORT_CANCEL);
+
+    // the running tasks return, the remaining ones are not started
+    BOOST_CHECK_EQUAL(ParallelInstance::s_tasks.size(), 2);
+    BOOST_CHECK_EQUAL(host.m_finished, 0);
+    BOOST_CHECK_EQUAL(host.m_failed, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_FIXTURE_TEST_SUITE(export_instance_test_suite, Fixture)
 
 BOOST_AUTO_TEST_CASE(IntialState)
@@ -0,0 +1,222 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkfw_channels.h"
+#include "odkfw_sample_writer.h"
+#include "odkapi_error_codes.h"
+#include "odkapi_message_ids.h"
+
+#include "allocation_counter.h"
+#include "test_host.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstring>
+#include <vector>
+
+using namespace odk::framework;
+
+namespace
+{
+    struct SentMessage
+    {
+        odk::MessageId m_msg_id;
+        std::uint64_t m_channel_id;
+        std::uint64_t m_timestamp;
+        std::vector<double> m_values;
+    };
+
+    class RecordingHost : public TestHost
+    {
+    public:
+        std::uint64_t PLUGIN_API messageSyncData(odk::MessageId msg_id, std::uint64_t key, const void* param, std::uint64_t param_size, const odk::IfValue** ret) override
+        {
+            ODK_UNUSED(ret);
+            BOOST_REQUIRE(msg_id == odk::host_msg::ADD_SAMPLE || msg_id == odk::host_msg::ADD_CONTIGUOUS_SAMPLES);
+            BOOST_REQUIRE_GE(param_size, sizeof(std::uint64_t));
+            if (m_record)
+            {
+                SentMessage message;
+                message.m_msg_id = msg_id;
+                message.m_channel_id = key;
+                std::memcpy(&message.m_timestamp, param, sizeof(std::uint64_t));
+                message.m_values.resize((param_size - sizeof(std::uint64_t)) / sizeof(double));
+                std::memcpy(message.m_values.data(), static_cast<const std::uint8_t*>(param) + sizeof(std::uint64_t), message.m_values.size() * sizeof(double));
+                m_messages.push_back(message);
+            }
+            return m_result;
+        }
+
+        bool m_record = true;
+        std::uint64_t m_result = odk::error_codes::OK;
+        std::vector<SentMessage> m_messages;
+    };
+}
+
+BOOST_AUTO_TEST_SUITE(sample_writer_test_suite)
+
+BOOST_AUTO_TEST_CASE(ContiguousSamplesAreMerged)
+{
+    RecordingHost host;
+    SampleWriter writer(&host);
+
+    const double values[] = { 1, 2, 3, 4, 5 };
+    writer.addSamples(7, 100, values, 2);
+    writer.addSamples(3, 10, values, 1);
+    writer.addSamples(7, 102, values + 2, 3);
+    writer.addSamples(3, 11, values + 1, 1);
+    BOOST_CHECK_EQUAL(writer.getPendingSampleCount(), 7);
+    BOOST_CHECK(host.m_messages.empty());
+
+    BOOST_CHECK_EQUAL(writer.flush(), odk::error_codes::OK);
+    BOOST_CHECK_EQUAL(writer.getPendingSampleCount(), 0);
+    BOOST_REQUIRE_EQUAL(host.m_messages.size(), 2);
+
+    BOOST_CHECK(host.m_messages[0].m_msg_id == odk::host_msg::ADD_CONTIGUOUS_SAMPLES);
+    BOOST_CHECK_EQUAL(host.m_messages[0].m_channel_id, 3);
+    BOOST_CHECK_EQUAL(host.m_messages[0].m_timestamp, 10);
+    BOOST_CHECK_EQUAL_COLLECTIONS(host.m_messages[0].m_values.begin(), host.m_messages[0].m_values.end(), values, values + 2);
+
+    BOOST_CHECK_EQUAL(host.m_messages[1].m_channel_id, 7);
+    BOOST_CHECK_EQUAL(host.m_messages[1].m_timestamp, 100);
+    BOOST_CHECK_EQUAL_COLLECTIONS(host.m_messages[1].m_values.begin(), host.m_messages[1].m_values.end(), values, values + 5);
+
+    // nothing left to send
+    BOOST_CHECK_EQUAL(writer.flush(), odk::error_codes::OK);
+    BOOST_CHECK_EQUAL(host.m_messages.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(DiscontinuousSamplesAreSentSeparately)
+{
+    RecordingHost host;
+    SampleWriter writer(&host);
+
+    const double values[] = { 1, 2, 3 };
+    writer.addSamples(1, 0, values, 2);
+    writer.addSamples(1, 5, values + 2, 1);
+    // the first run is sent as soon as it cannot be continued
+    BOOST_REQUIRE_EQUAL(host.m_messages.size(), 1);
+    BOOST_CHECK_EQUAL(host.m_messages[0].m_timestamp, 0);
+    BOOST_CHECK_EQUAL(host.m_messages[0].m_values.size(), 2);
+
+    writer.flush();
+    BOOST_REQUIRE_EQUAL(host.m_messages.size(), 2);
+    BOOST_CHECK_EQUAL(host.m_messages[1].m_timestamp, 5);
+    BOOST_CHECK_EQUAL(host.m_messages[1].m_values.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(SingleSamplesKeepTheirTimestamps)
+{
+    RecordingHost host;
+    SampleWriter writer(&host);
+
+    writer.addSample(2, 40, 4.5);
+    writer.addSample(2, 17, 1.5);
+    writer.addSample(2, 99, 9.5);
+    writer.flush();
+
+    BOOST_REQUIRE_EQUAL(host.m_messages.size(), 3);
+    const std::uint64_t expected_timestamps[] = { 40, 17, 99 };
+    const double expected_values[] = { 4.5, 1.5, 9.5 };
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK(host.m_messages[i].m_msg_id == odk::host_msg::ADD_SAMPLE);
+        BOOST_CHECK_EQUAL(host.m_messages[i].m_channel_id, 2);
+        BOOST_CHECK_EQUAL(host.m_messages[i].m_timestamp, expected_timestamps[i]);
+        BOOST_REQUIRE_EQUAL(host.m_messages[i].m_values.size(), 1);
+        BOOST_CHECK_EQUAL(host.m_messages[i].m_values[0], expected_values[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ClearDiscardsSamples)
+{
+    RecordingHost host;
+    SampleWriter writer(&host);
+
+    writer.addSample(2, 40, 4.5);
+    const double value = 1.0;
+    writer.addSamples(3, 0, &value, 1);
+    BOOST_CHECK_EQUAL(writer.getPendingSampleCount(), 2);
+    writer.clear();
+    BOOST_CHECK_EQUAL(writer.getPendingSampleCount(), 0);
+    writer.flush();
+    BOOST_CHECK(host.m_messages.empty());
+}
+
+BOOST_AUTO_TEST_CASE(FlushWithoutAllocation)
+{
+    RecordingHost host;
+    host.m_record = false;
+    SampleWriter writer(&host);
+
+    const auto process = [&writer]()
+    {
+        for (std::uint64_t sample = 0; sample < 100; ++sample)
+        {
+            const double value = static_cast<double>(sample);
+            const float bin = static_cast<float>(sample);
+            writer.addSamples(1, sample, &value, 1);
+            writer.addSamples(2, sample, &bin, 1);
+            writer.addSample(3, sample * 3, value);
+        }
+        writer.flush();
+    };
+
+    // the first call allocates the staging buffers
+    process();
+
+    AllocationCounter allocations;
+    for (int cycle = 0; cycle < 3; ++cycle)
+    {
+        process();
+    }
+    BOOST_CHECK_EQUAL(allocations.count(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(PluginChannelStagesSamples)
+{
+    RecordingHost host;
+    PluginChannel channel(12, nullptr, &host);
+
+    for (std::uint64_t sample = 0; sample < 1000; ++sample)
+    {
+        channel.addSample(sample * 7, static_cast<double>(sample));
+    }
+    BOOST_CHECK(host.m_messages.empty());
+
+    BOOST_CHECK_EQUAL(channel.flushSamples(), odk::error_codes::OK);
+    BOOST_REQUIRE_EQUAL(host.m_messages.size(), 1000);
+    BOOST_CHECK(host.m_messages[999].m_msg_id == odk::host_msg::ADD_SAMPLE);
+    BOOST_CHECK_EQUAL(host.m_messages[999].m_channel_id, 12);
+    BOOST_CHECK_EQUAL(host.m_messages[999].m_timestamp, 999 * 7);
+
+    const double values[] = { 1, 2, 3 };
+    channel.addSamples(5000, values, 1);
+    channel.addSamples(5001, values + 1, 2);
+    BOOST_CHECK_EQUAL(host.m_messages.size(), 1000);
+    channel.flushSamples();
+    BOOST_REQUIRE_EQUAL(host.m_messages.size(), 1001);
+    BOOST_CHECK(host.m_messages[1000].m_msg_id == odk::host_msg::ADD_CONTIGUOUS_SAMPLES);
+    BOOST_CHECK_EQUAL(host.m_messages[1000].m_timestamp, 5000);
+    BOOST_CHECK_EQUAL(host.m_messages[1000].m_values.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(PluginChannelReportsAndClearsSamples)
+{
+    RecordingHost host;
+    PluginChannel channel(12, nullptr, &host);
+
+    const double values[] = { 1, 2, 3 };
+    channel.addSamples(100, values, 3);
+    host.m_result = odk::error_codes::INTERNAL_ERROR;
+    BOOST_CHECK_EQUAL(channel.flushSamples(), odk::error_codes::INTERNAL_ERROR);
+
+    // cleared samples are not sent by the next flush
+    host.m_result = odk::error_codes::OK;
+    host.m_messages.clear();
+    channel.addSamples(200, values, 3);
+    channel.clearSamples();
+    BOOST_CHECK_EQUAL(channel.flushSamples(), odk::error_codes::OK);
+    BOOST_CHECK(host.m_messages.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,162 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkfw_sinc_resampler.h"
+
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    std::vector<double> sine(double frequency, double sample_rate, std::size_t count)
+    {
+        std::vector<double> samples(count);
+        for (std::size_t n = 0; n < count; ++n)
+        {
+            samples[n] = std::sin(2 * PI * frequency * static_cast<double>(n) / sample_rate);
+        }
+        return samples;
+    }
+
+    /// resamples the whole input, the output beyond the end of the input is not computed
+    std::vector<double> resample(odk::framework::SincResampler& resampler, const std::vector<double>& input)
+    {
+        resampler.addInput(input.data(), input.size());
+        std::vector<double> output(static_cast<std::size_t>(static_cast<double>(input.size()) * resampler.getOutputRate() / resampler.getInputRate()) + 1);
+        output.resize(resampler.process(output.data(), output.size()));
+        return output;
+    }
+
+    double maxAbs(const std::vector<double>& values, std::size_t begin, std::size_t end)
+    {
+        double result = 0;
+        for (std::size_t n = begin; n < end; ++n)
+        {
+            result = std::max(result, std::abs(values[n]));
+        }
+        return result;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(sinc_resampler_test_suite)
+
+BOOST_AUTO_TEST_CASE(SameRateKeepsSamples)
+{
+    odk::framework::SincResampler resampler(1000, 1000);
+    const auto input = sine(123, 1000, 1000);
+    const auto output = resample(resampler, input);
+
+    BOOST_REQUIRE_EQUAL(output.size(), input.size() - resampler.getHalfWidth());
+    for (std::size_t n = 0; n < output.size(); ++n)
+    {
+        BOOST_REQUIRE_SMALL(output[n] - input[n], 1e-9);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(UpsamplingFollowsSignal)
+{
+    const double input_rate = 10000;
+    const double output_rate = 44100;
+    odk::framework::SincResampler resampler(input_rate, output_rate);
+    const auto output = resample(resampler, sine(500, input_rate, 10000));
+    const auto expected = sine(500, output_rate, output.size());
+
+    // the zeros in front of the stream affect the first samples
+    const std::size_t settled = static_cast<std::size_t>(resampler.getHalfWidth() * output_rate / input_rate);
+    BOOST_REQUIRE_GT(output.size(), 40000);
+    double error = 0;
+    for (std::size_t n = settled; n < output.size(); ++n)
+    {
+        error = std::max(error, std::abs(output[n] - expected[n]));
+    }
+    BOOST_CHECK_SMALL(error, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE(DownsamplingSuppressesAliasing)
+{
+    const double input_rate = 48000;
+    const double output_rate = 8000;
+    const std::size_t count = 48000;
+
+    // below the output Nyquist frequency
+    odk::framework::SincResampler pass(input_rate, output_rate);
+    const auto passed = resample(pass, sine(1000, input_rate, count));
+    const std::size_t settled = pass.getHalfWidth();
+    BOOST_CHECK_CLOSE(maxAbs(passed, settled, passed.size()), 1.0, 1.0);
+
+    // would alias to 2 kHz without the lowered cutoff
+    odk::framework::SincResampler stop(input_rate, output_rate);
+    const auto stopped = resample(stop, sine(10000, input_rate, count));
+    BOOST_CHECK_SMALL(maxAbs(stopped, settled, stopped.size()), 0.01);
+}
+
+BOOST_AUTO_TEST_CASE(BlockwiseProcessingMatchesSingleBlock)
+{
+    const double input_rate = 1000;
+    const double output_rate = 768;
+    const auto input = sine(77, input_rate, 20000);
+
+    odk::framework::SincResampler single(input_rate, output_rate);
+    const auto expected = resample(single, input);
+
+    odk::framework::SincResampler blockwise(input_rate, output_rate);
+    std::vector<double> output;
+    std::size_t consumed = 0;
+    for (std::size_t block = 1; output.size() < expected.size(); block = block % 700 + 37)
+    {
+        const std::size_t num_output = std::min(block, expected.size() - output.size());
+        const std::size_t required = blockwise.requiredInput(num_output);
+        BOOST_REQUIRE_LE(consumed + required, input.size());
+        blockwise.addInput(input.data() + consumed, required);
+        consumed += required;
+
+        std::vector<double> samples(num_output);
+        BOOST_REQUIRE_EQUAL(blockwise.process(samples.data(), num_output), num_output);
+        BOOST_CHECK_EQUAL(blockwise.requiredInput(0), 0);
+        output.insert(output.end(), samples.begin(), samples.end());
+    }
+    BOOST_CHECK_EQUAL(blockwise.getOutputCount(), expected.size());
+    BOOST_CHECK(output == expected);
+
+    blockwise.reset();
+    BOOST_CHECK_EQUAL(blockwise.getOutputCount(), 0);
+    BOOST_CHECK(resample(blockwise, input) == expected);
+}
+
+BOOST_AUTO_TEST_CASE(KernelIsShared)
+{
+    odk::framework::SincResampler first(48000, 44100);
+    odk::framework::SincResampler second(48000, 44100);
+    // the kernel only depends on the ratio of the rates
+    odk::framework::SincResampler doubled(96000, 88200);
+    odk::framework::SincResampler other(48000, 32000);
+
+    BOOST_CHECK_EQUAL(first.getKernel().data(), second.getKernel().data());
+    BOOST_CHECK_EQUAL(first.getKernel().data(), doubled.getKernel().data());
+    BOOST_CHECK_NE(first.getKernel().data(), other.getKernel().data());
+    BOOST_CHECK_EQUAL(first.getKernel().size(), (odk::framework::SincResampler::PHASE_COUNT + 1) * 2 * first.getHalfWidth());
+
+    const auto input = sine(1000, 48000, 4000);
+    BOOST_CHECK(resample(first, input) == resample(second, input));
+}
+
+BOOST_AUTO_TEST_CASE(HalfWidthIsLimited)
+{
+    const std::size_t max_half_width = odk::framework::SincResampler::MAX_HALF_WIDTH;
+    BOOST_CHECK_EQUAL(odk::framework::SincResampler(16000, 1000).getHalfWidth(), 256);
+    BOOST_CHECK_EQUAL(odk::framework::SincResampler(32000, 1000).getHalfWidth(), max_half_width);
+    // decimation by more than MAX_HALF_WIDTH / zero_crossings shortens the kernel
+    BOOST_CHECK_EQUAL(odk::framework::SincResampler(100000, 1000).getHalfWidth(), max_half_width);
+    BOOST_CHECK_EQUAL(odk::framework::SincResampler(100000, 1000, 4).getHalfWidth(), 400);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidRates)
+{
+    BOOST_CHECK_THROW(odk::framework::SincResampler(0, 100), std::invalid_argument);
+    BOOST_CHECK_THROW(odk::framework::SincResampler(100, -1), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,15 +1,27 @@
 // Copyright DEWETRON GmbH 2021
 #include "odkfw_software_channel_instance.h"
 #include "odkfw_software_channel_plugin.h"
+#include "odkfw_properties.h"
 #include "odkapi_acquisition_task_xml.h"
+#include "odkapi_block_descriptor_xml.h"
+#include "odkapi_data_set_descriptor_xml.h"
+#include "odkapi_data_set_xml.h"
+#include "odkapi_oxygen_queries.h"
 #include "odkapi_software_channel_xml.h"
 #include "odkapi_update_channels_xml.h"
+#include "allocation_counter.h"
 #include "test_host.h"
 #include "values.h"
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
 namespace
 {
     class FixtureHost : public TestHost
@@ -96,6 +108,8 @@ namespace
     public:
         TestInstance() = default;
 
+        using SoftwareChannelInstance::updateChannelIterators;
+
         static odk::RegisterSoftwareChannel getSoftwareChannelInfo()
         {
             odk::RegisterSoftwareChannel info;
@@ -188,3 +202,554 @@ BOOST_AUTO_TEST_CASE(CreateChannel)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+namespace
+{
+    /// two double channels (ids 1 and 2) interleaved in stream 7
+    std::vector<odk::StreamDescriptor> createStreamDescriptors()
+    {
+        odk::StreamDescriptor sd;
+        sd.m_stream_id = 7;
+        for (std::uint64_t channel_id = 1; channel_id <= 2; ++channel_id)
+        {
+            odk::ChannelDescriptor cd;
+            cd.m_channel_id = channel_id;
+            cd.m_dimension = 1;
+            cd.m_stride = 2 * 64;
+            cd.m_size = 64;
+            cd.m_type = odk::SampleType::DOUBLE;
+            sd.m_channel_descriptors.push_back(cd);
+        }
+        return { sd };
+    }
+
+    /// two blocks with samples 100..101 and 102..103 of both channels
+    DataBlockListValue* createBlockList(double (&data1)[4], double (&data2)[4], std::string description = "<BlockListDescriptor/>")
+    {
+        auto block_list = new DataBlockListValue(std::move(description));
+        std::uint64_t first_sample = 100;
+        for (double* data : { data1, data2 })
+        {
+            odk::BlockDescriptor bd;
+            bd.m_stream_id = 7;
+            bd.m_data_size = sizeof(data1);
+            for (std::uint64_t channel_id = 1; channel_id <= 2; ++channel_id)
+            {
+                odk::BlockChannelDescriptor bcd;
+                bcd.m_channel_id = channel_id;
+                bcd.m_offset = static_cast<std::uint32_t>((channel_id - 1) * 64);
+                bcd.m_count = 2;
+                bcd.m_first_sample_index = first_sample;
+                bcd.m_timestamp = first_sample;
+                bcd.m_duration = 2;
+                bd.m_block_channels.push_back(bcd);
+            }
+            block_list->addBlock(new DataBlockValue(bd.generate(), data, sizeof(data1)));
+            first_sample += 2;
+        }
+        return block_list;
+    }
+
+    /// timestamp, count and gap flag of all spans of the iterator
+    std::vector<std::tuple<std::uint64_t, std::uint64_t, bool>> collectSpans(odk::framework::StreamIterator& iterator)
+    {
+        std::vector<std::tuple<std::uint64_t, std::uint64_t, bool>> spans;
+        for (auto span = iterator.nextSpan(); !span.empty(); span = iterator.nextSpan())
+        {
+            spans.emplace_back(span.m_timestamp, span.m_count, span.m_data == nullptr);
+        }
+        return spans;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(software_channel_instance_iterator_test_suite)
+
+BOOST_AUTO_TEST_CASE(RefreshIteratorsWithoutAllocation)
+{
+    const auto stream_descriptors = createStreamDescriptors();
+
+    double data1[4] = { 1, 10, 2, 20 };
+    double data2[4] = { 3, 30, 4, 40 };
+    auto block_list = createBlockList(data1, data2);
+
+    TestInstance instance;
+    std::map<uint64_t, odk::framework::StreamIterator> iterators;
+    const odk::Interval<double> everything(0, std::numeric_limits<double>::max());
+
+    // the first refresh allocates the storage that is reused afterwards
+    {
+        AllocationCounter allocations;
+        instance.updateChannelIterators(iterators, stream_descriptors, block_list, everything, nullptr);
+        BOOST_CHECK_GT(allocations.count(), 0);
+    }
+
+    AllocationCounter allocations;
+    for (int cycle = 0; cycle < 3; ++cycle)
+    {
+        instance.updateChannelIterators(iterators, stream_descriptors, block_list, everything, nullptr);
+    }
+    BOOST_CHECK_EQUAL(allocations.count(), 0);
+
+    BOOST_REQUIRE_EQUAL(iterators.size(), 2);
+    for (auto& channel_iterator : iterators)
+    {
+        auto& iterator = channel_iterator.second;
+        BOOST_CHECK_EQUAL(iterator.getTotalSampleCount(), 4);
+        std::vector<double> values;
+        for (; iterator.valid(); ++iterator)
+        {
+            values.push_back(iterator.value<double>());
+        }
+        const std::vector<double> expected = channel_iterator.first == 1
+            ? std::vector<double>{ 1, 2, 3, 4 }
+            : std::vector<double>{ 10, 20, 30, 40 };
+        BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+    }
+
+    // iterators of channels that left the data set are dropped
+    iterators[42];
+    instance.updateChannelIterators(iterators, stream_descriptors, block_list, everything, nullptr);
+    BOOST_CHECK_EQUAL(iterators.count(42), 0);
+
+    block_list->release();
+}
+
+BOOST_AUTO_TEST_CASE(SwappedChannelDropsIterator)
+{
+    auto stream_descriptors = createStreamDescriptors();
+
+    double data1[4] = { 1, 10, 2, 20 };
+    double data2[4] = { 3, 30, 4, 40 };
+    auto block_list = createBlockList(data1, data2);
+
+    TestInstance instance;
+    std::map<uint64_t, odk::framework::StreamIterator> iterators;
+    const odk::Interval<double> everything(0, std::numeric_limits<double>::max());
+    instance.updateChannelIterators(iterators, stream_descriptors, block_list, everything, nullptr);
+    BOOST_CHECK_EQUAL(iterators.size(), 2);
+    BOOST_CHECK_EQUAL(iterators.count(2), 1);
+
+    // same number of channels, but channel 2 was replaced by channel 3
+    stream_descriptors.front().m_channel_descriptors.back().m_channel_id = 3;
+    instance.updateChannelIterators(iterators, stream_descriptors, block_list, everything, nullptr);
+    BOOST_CHECK_EQUAL(iterators.size(), 2);
+    BOOST_CHECK_EQUAL(iterators.count(1), 1);
+    BOOST_CHECK_EQUAL(iterators.count(2), 0);
+    BOOST_CHECK_EQUAL(iterators.count(3), 1);
+
+    block_list->release();
+}
+
+BOOST_AUTO_TEST_CASE(InvalidRegionsMatchValidRegions)
+{
+    const auto stream_descriptors = createStreamDescriptors();
+
+    double data1[4] = { 1, 10, 2, 20 };
+    double data2[4] = { 3, 30, 4, 40 };
+    auto block_list = createBlockList(data1, data2);
+
+    TestInstance instance;
+    const odk::Interval<double> everything(0, std::numeric_limits<double>::max());
+    const auto max_tick = std::numeric_limits<std::uint64_t>::max();
+
+    // channel 1 is invalid in [101, 103), channel 2 is valid
+    const std::vector<odk::DataRegion> invalid_regions = {
+        odk::DataRegion(1, odk::Interval<std::uint64_t>(102, 103)),
+        odk::DataRegion(1, odk::Interval<std::uint64_t>(101, 102)),
+    };
+    odk::DataRegions data_regions;
+    data_regions.m_data_regions = {
+        odk::DataRegion(1, odk::Interval<std::uint64_t>(0, 101)),
+        odk::DataRegion(1, odk::Interval<std::uint64_t>(103, max_tick)),
+        odk::DataRegion(2, odk::Interval<std::uint64_t>(0, max_tick)),
+    };
+
+    std::map<uint64_t, odk::framework::StreamIterator> from_invalid;
+    instance.updateChannelIterators(from_invalid, stream_descriptors, block_list, everything, nullptr, &invalid_regions);
+    std::map<uint64_t, odk::framework::StreamIterator> from_valid;
+    instance.updateChannelIterators(from_valid, stream_descriptors, block_list, everything, &data_regions);
+
+    for (std::uint64_t channel_id = 1; channel_id <= 2; ++channel_id)
+    {
+        from_invalid[channel_id].setSkipGaps(false);
+        from_valid[channel_id].setSkipGaps(false);
+        const auto spans = collectSpans(from_invalid[channel_id]);
+        const auto expected = collectSpans(from_valid[channel_id]);
+        BOOST_CHECK(spans == expected);
+        BOOST_CHECK_EQUAL(std::count_if(spans.begin(), spans.end(),
+            [](const std::tuple<std::uint64_t, std::uint64_t, bool>& span) { return std::get<2>(span); }), channel_id == 1 ? 1 : 0);
+    }
+
+    block_list->release();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace
+{
+    /**
+     * Serves the data requests of a software channel instance,
+     * every cycle is answered with the same values to keep the host from allocating
+     */
+    class ProcessHost : public FixtureHost
+    {
+    public:
+        ProcessHost()
+            : m_analysis_mode(new BooleanValue(false))
+            , m_master_timestamp(new XmlValue(odk::Timestamp(104, 10000).generate()))
+            , m_data_set(nullptr)
+            , m_block_list(nullptr)
+        {
+            odk::DataSetDescriptor data_set;
+            data_set.m_id = 5;
+            data_set.m_stream_descriptors = createStreamDescriptors();
+            m_data_set = new XmlValue(data_set.generate());
+
+            odk::BlockListDescriptor list_descriptor;
+            list_descriptor.m_block_count = 2;
+            list_descriptor.m_windows.emplace_back(0.01, 0.0104);
+            list_descriptor.m_invalid_regions_included = true;
+            m_block_list = createBlockList(m_data1, m_data2, list_descriptor.generate());
+        }
+
+        ~ProcessHost()
+        {
+            m_analysis_mode->release();
+            m_master_timestamp->release();
+            m_data_set->release();
+            m_block_list->release();
+        }
+
+        odk::IfValue* PLUGIN_API createValue(odk::IfValue::Type type) const override
+        {
+            if (type == odk::IfValue::Type::TYPE_UINT)
+            {
+                return new UIntValue(0);
+            }
+            return TestHost::createValue(type);
+        }
+
+        std::uint64_t PLUGIN_API messageSync(odk::MessageId msg_id, std::uint64_t key, const odk::IfValue* param, const odk::IfValue** ret) override
+        {
+            switch (msg_id)
+            {
+            case odk::host_msg::ACQUISITION_TASK_ADD:
+            {
+                const odk::IfXMLValue* xml_param = dynamic_cast<const odk::IfXMLValue*>(param);
+                BOOST_REQUIRE(xml_param);
+                odk::AddAcquisitionTaskTelegram telegram;
+                BOOST_REQUIRE(telegram.parse(xml_param->getValue()));
+                m_task_key = telegram.m_id;
+                m_task_added = true;
+                return odk::error_codes::OK;
+            }
+
+            case odk::host_msg::DATA_GROUP_ADD:
+                m_data_set->addRef();
+                *ret = m_data_set;
+                return odk::error_codes::OK;
+
+            case odk::host_msg::DATA_GROUP_REMOVE:
+                return odk::error_codes::OK;
+
+            // no test assertions from here on, they run while allocations are counted
+            case odk::host_msg::DATA_READ:
+            {
+                ++m_data_reads;
+                const auto request = odk::value_cast<odk::IfXMLValue>(param);
+                const bool regions_requested = request && std::strstr(request->getValue(), "include_regions") != nullptr;
+                m_regions_requested += regions_requested;
+                *ret = nullptr;
+                if (m_failing_data_reads > 0)
+                {
+                    --m_failing_data_reads;
+                    return odk::error_codes::INTERNAL_ERROR;
+                }
+                if (regions_requested && m_reject_included_regions)
+                {
+                    return odk::error_codes::INVALID_INPUT_PARAMETER;
+                }
+                m_block_list->addRef();
+                *ret = m_block_list;
+                return odk::error_codes::OK;
+            }
+
+            case odk::host_msg::DATA_REGIONS_READ:
+                ++m_data_regions_reads;
+                *ret = nullptr;
+                return odk::error_codes::OK;
+
+            default:
+                return FixtureHost::messageSync(msg_id, key, param, ret);
+            }
+        }
+
+        const odk::IfValue* PLUGIN_API query(const char* context, const char* item, const odk::IfValue* param) override
+        {
+            if (std::strcmp(context, odk::queries::Oxygen) == 0)
+            {
+                if (std::strcmp(item, odk::queries::Oxygen_AnalysisModeActive) == 0)
+                {
+                    m_analysis_mode->addRef();
+                    return m_analysis_mode;
+                }
+                if (std::strcmp(item, odk::queries::Oxygen_MasterTimebaseValue) == 0)
+                {
+                    m_master_timestamp->addRef();
+                    return m_master_timestamp;
+                }
+            }
+            if (boost::algorithm::starts_with(context, "#Oxygen#Channels#"))
+            {
+                const int channel_id = std::atoi(context + std::strlen("#Oxygen#Channels#"));
+                BOOST_REQUIRE_GE(channel_id, 1);
+                BOOST_REQUIRE_LE(channel_id, 2);
+
+                if (boost::algorithm::equals(item, "DataFormat"))
+                {
+                    odk::ChannelDataformat data_format;
+                    data_format.m_sample_dimension = 1;
+                    data_format.m_sample_format = odk::ChannelDataformat::SampleFormat::DOUBLE;
+                    data_format.m_sample_value_type = odk::ChannelDataformat::SampleValueType::SAMPLE_VALUE_SCALAR;
+                    data_format.m_sample_occurrence = odk::ChannelDataformat::SampleOccurrence::SYNC;
+                    data_format.m_sample_reduced_format = odk::ChannelDataformat::SampleReducedFormat::UNKNOWN;
+                    return new XmlValue(data_format.generate());
+                }
+                if (boost::algorithm::equals(item, "Usable"))
+                {
+                    return new BooleanValue(true);
+                }
+            }
+            return FixtureHost::query(context, item, param);
+        }
+
+        std::uint64_t m_task_key = 0;
+        bool m_task_added = false;
+        std::size_t m_data_reads = 0;
+        std::size_t m_data_regions_reads = 0;
+        /// number of DATA_READ requests asking for the invalid regions
+        std::size_t m_regions_requested = 0;
+        /// answers DATA_READ requests asking for the invalid regions with an error, like hosts that do not support them
+        bool m_reject_included_regions = false;
+        /// number of following DATA_READ requests that fail regardless of their content
+        std::size_t m_failing_data_reads = 0;
+
+    private:
+        double m_data1[4] = { 1, 10, 2, 20 };
+        double m_data2[4] = { 3, 30, 4, 40 };
+        BooleanValue* m_analysis_mode;
+        XmlValue* m_master_timestamp;
+        XmlValue* m_data_set;
+        DataBlockListValue* m_block_list;
+    };
+
+    /**
+     * Reads the selected channels, the windows are requested by the process telegrams
+     */
+    class ProcessInstance : public odk::framework::SoftwareChannelInstance
+    {
+    public:
+        ProcessInstance()
+            : m_input_channels(std::make_shared<odk::framework::EditableChannelIDListProperty>())
+        {
+        }
+
+        static odk::RegisterSoftwareChannel getSoftwareChannelInfo()
+        {
+            return TestInstance::getSoftwareChannelInfo();
+        }
+
+        InitResult init(const InitParams& params) override
+        {
+            odk::ChannelIDList channel_ids;
+            for (const auto& input_channel : params.m_input_channels)
+            {
+                channel_ids.m_values.push_back(input_channel.m_channel_id);
+            }
+            m_input_channels->setValue(channel_ids);
+            return { true };
+        }
+
+        void create(odk::IfHost* host) override
+        {
+            ODK_UNUSED(host);
+            setDataRequestType(DataRequestType::NONE);
+            getRootChannel()->addProperty("InputChannels", m_input_channels);
+        }
+
+        bool configure(const odk::UpdateChannelsTelegram& request,
+            std::map<uint32_t, uint32_t>& channel_id_map) final
+        {
+            ODK_UNUSED(request);
+            ODK_UNUSED(channel_id_map);
+            return true;
+        }
+
+        bool update() final
+        {
+            return true;
+        }
+
+        void process(ProcessingContext& context, odk::IfHost* host) final
+        {
+            ODK_UNUSED(host);
+            s_iterator_count = context.m_channel_iterators.size();
+            s_sample_count = 0;
+            for (auto& channel_iterator : context.m_channel_iterators)
+            {
+                s_sample_count += channel_iterator.second.getTotalSampleCount();
+            }
+        }
+
+        static std::size_t s_iterator_count;
+        static std::uint64_t s_sample_count;
+
+    private:
+        std::shared_ptr<odk::framework::EditableChannelIDListProperty> m_input_channels;
+    };
+
+    std::size_t ProcessInstance::s_iterator_count = 0;
+    std::uint64_t ProcessInstance::s_sample_count = 0;
+
+    class ProcessFixture
+    {
+    public:
+        ProcessFixture()
+        {
+            ProcessInstance::s_iterator_count = 0;
+            ProcessInstance::s_sample_count = 0;
+
+            auto& if_plugin = static_cast<odk::IfPlugin&>(plugin);
+            if_plugin.setPluginHost(&host);
+            BOOST_REQUIRE_EQUAL(if_plugin.pluginMessage(odk::plugin_msg::INIT, 0, nullptr, nullptr), odk::error_codes::OK);
+
+            odk::CreateSoftwareChannel csc;
+            csc.m_service_name = "TestServiceName";
+            for (std::uint64_t channel_id = 1; channel_id <= 2; ++channel_id)
+            {
+                odk::InputChannelData channel;
+                channel.channel_id = channel_id;
+                channel.data_format.m_sample_dimension = 1;
+                channel.data_format.m_sample_format = odk::ChannelDataformat::SampleFormat::DOUBLE;
+                channel.data_format.m_sample_value_type = odk::ChannelDataformat::SampleValueType::SAMPLE_VALUE_SCALAR;
+                channel.data_format.m_sample_occurrence = odk::ChannelDataformat::SampleOccurrence::SYNC;
+                channel.data_format.m_sample_reduced_format = odk::ChannelDataformat::SampleReducedFormat::UNKNOWN;
+                csc.m_all_selected_channels_data.push_back(channel);
+            }
+            XmlValue create_xml(csc.generate());
+            const odk::IfValue* result = nullptr;
+            BOOST_REQUIRE_EQUAL(if_plugin.pluginMessage(odk::plugin_msg::SOFTWARE_CHANNEL_CREATE, 123, &create_xml, &result), odk::error_codes::OK);
+            BOOST_REQUIRE(result);
+            result->release();
+
+            BOOST_REQUIRE(host.m_task_added);
+            BOOST_REQUIRE_EQUAL(if_plugin.pluginMessage(odk::plugin_msg::ACQUISITION_TASK_START_PROCESSING, host.m_task_key, nullptr, nullptr), odk::error_codes::OK);
+        }
+
+        ~ProcessFixture()
+        {
+            auto& if_plugin = static_cast<odk::IfPlugin&>(plugin);
+            BOOST_CHECK_EQUAL(if_plugin.pluginMessage(odk::plugin_msg::ACQUISITION_TASK_STOP_PROCESSING, host.m_task_key, nullptr, nullptr), odk::error_codes::OK);
+            BOOST_CHECK_EQUAL(if_plugin.pluginMessage(odk::plugin_msg::DEINIT, 0, nullptr, nullptr), odk::error_codes::OK);
+        }
+
+        std::uint64_t process(const odk::IfXMLValue& telegram)
+        {
+            return static_cast<odk::IfPlugin&>(plugin).pluginMessage(odk::plugin_msg::ACQUISITION_TASK_PROCESS, host.m_task_key, &telegram, nullptr);
+        }
+
+        ProcessHost host;
+        odk::framework::SoftwareChannelPlugin<ProcessInstance> plugin;
+    };
+
+    std::string createProcessTelegram(std::uint64_t start, std::uint64_t end)
+    {
+        odk::AcquisitionTaskProcessTelegram telegram;
+        telegram.m_start = odk::Timestamp(start, 10000);
+        telegram.m_end = odk::Timestamp(end, 10000);
+        return telegram.generate();
+    }
+}
+
+BOOST_FIXTURE_TEST_SUITE(software_channel_instance_process_test_suite, ProcessFixture)
+
+BOOST_AUTO_TEST_CASE(ProcessWithoutAllocation)
+{
+    const XmlValue data_cycle(createProcessTelegram(100, 104));
+    // cycles without timestamps have no data
+    const XmlValue idle_cycle(odk::AcquisitionTaskProcessTelegram().generate());
+
+    // the first cycles allocate the storage that is reused afterwards
+    BOOST_REQUIRE_EQUAL(process(data_cycle), odk::error_codes::OK);
+    BOOST_CHECK_EQUAL(ProcessInstance::s_iterator_count, 2);
+    BOOST_CHECK_EQUAL(ProcessInstance::s_sample_count, 8);
+    BOOST_REQUIRE_EQUAL(process(idle_cycle), odk::error_codes::OK);
+
+    std::size_t failed_cycles = 0;
+    std::uint64_t idle_sample_count = 0;
+    AllocationCounter allocations;
+    for (int cycle = 0; cycle < 3; ++cycle)
+    {
+        failed_cycles += process(data_cycle) != odk::error_codes::OK;
+        failed_cycles += process(idle_cycle) != odk::error_codes::OK;
+        idle_sample_count += ProcessInstance::s_sample_count;
+    }
+    BOOST_CHECK_EQUAL(allocations.count(), 0);
+    BOOST_CHECK_EQUAL(failed_cycles, 0);
+
+    // idle cycles keep the iterators of the channels without samples
+    BOOST_CHECK_EQUAL(ProcessInstance::s_iterator_count, 2);
+    BOOST_CHECK_EQUAL(idle_sample_count, 0);
+
+    BOOST_REQUIRE_EQUAL(process(data_cycle), odk::error_codes::OK);
+    BOOST_CHECK_EQUAL(ProcessInstance::s_sample_count, 8);
+
+    // the invalid regions are reported with the data
+    BOOST_CHECK_EQUAL(host.m_data_reads, 5);
+    BOOST_CHECK_EQUAL(host.m_regions_requested, 5);
+    BOOST_CHECK_EQUAL(host.m_data_regions_reads, 0);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsAreReadSeparatelyIfTheHostRejectsThem)
+{
+    const XmlValue data_cycle(createProcessTelegram(100, 104));
+    host.m_reject_included_regions = true;
+
+    // the rejected request is repeated without the invalid regions, they are read separately
+    BOOST_REQUIRE_EQUAL(process(data_cycle), odk::error_codes::OK);
+    BOOST_CHECK_EQUAL(ProcessInstance::s_sample_count, 8);
+    BOOST_CHECK_EQUAL(host.m_data_reads, 2);
+    BOOST_CHECK_EQUAL(host.m_regions_requested, 1);
+    BOOST_CHECK_EQUAL(host.m_data_regions_reads, 1);
+
+    // the following cycles do not ask for them anymore
+    BOOST_REQUIRE_EQUAL(process(data_cycle), odk::error_codes::OK);
+    BOOST_CHECK_EQUAL(ProcessInstance::s_sample_count, 8);
+    BOOST_CHECK_EQUAL(host.m_data_reads, 3);
+    BOOST_CHECK_EQUAL(host.m_regions_requested, 1);
+    BOOST_CHECK_EQUAL(host.m_data_regions_reads, 2);
+}
+
+BOOST_AUTO_TEST_CASE(FailedDataReadKeepsSingleRequest)
+{
+    const XmlValue data_cycle(createProcessTelegram(100, 104));
+    host.m_failing_data_reads = 2;
+
+    // the retry without the invalid regions fails as well, the cycle has no data
+    BOOST_REQUIRE_EQUAL(process(data_cycle), odk::error_codes::OK);
+    BOOST_CHECK_EQUAL(ProcessInstance::s_iterator_count, 0);
+    BOOST_CHECK_EQUAL(host.m_data_reads, 2);
+    BOOST_CHECK_EQUAL(host.m_regions_requested, 1);
+
+    // the next cycles still read the data and the invalid regions with a single request
+    for (int cycle = 0; cycle < 2; ++cycle)
+    {
+        BOOST_REQUIRE_EQUAL(process(data_cycle), odk::error_codes::OK);
+        BOOST_CHECK_EQUAL(ProcessInstance::s_sample_count, 8);
+    }
+    BOOST_CHECK_EQUAL(host.m_data_reads, 4);
+    BOOST_CHECK_EQUAL(host.m_regions_requested, 3);
+    BOOST_CHECK_EQUAL(host.m_data_regions_reads, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
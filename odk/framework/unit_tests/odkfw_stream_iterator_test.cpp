@@ -5,6 +5,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <cstring>
+
 using namespace odk::framework;
 
 BOOST_AUTO_TEST_SUITE(stream_iterator)
@@ -274,4 +277,325 @@ BOOST_AUTO_TEST_CASE(stream_iterator_async_variable_size_test)
     BOOST_CHECK(!it.valid());
 }
 
+BOOST_AUTO_TEST_CASE(stream_iterator_span_test)
+{
+    StreamIterator it;
+    it.setSkipGaps(false);
+    BOOST_CHECK(it.nextSpan().empty());
+
+    std::vector<double> data = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    addSyncDataRange(it, data, 10);
+    addSyncDataRange(it, data, 20);
+    it.addRange(BlockIterator(30), BlockIterator(35));
+
+    auto span = it.nextSpan(4);
+    BOOST_CHECK_EQUAL(span.m_data, data.data());
+    BOOST_CHECK_EQUAL(span.m_stride, sizeof(double));
+    BOOST_CHECK_EQUAL(span.m_count, 4);
+    BOOST_CHECK_EQUAL(span.m_timestamp, 10);
+    BOOST_CHECK_EQUAL(span.value<double>(3), 3);
+    BOOST_CHECK_EQUAL(span.timestamp(3), 13);
+    BOOST_CHECK_EQUAL(it.timestamp(), 14);
+
+    // the rest of the first block, spans do not cross block boundaries
+    span = it.nextSpan();
+    BOOST_CHECK_EQUAL(span.m_count, 6);
+    BOOST_CHECK_EQUAL(span.m_timestamp, 14);
+    BOOST_CHECK_EQUAL(span.value<double>(0), 4);
+
+    span = it.nextSpan();
+    BOOST_CHECK_EQUAL(span.m_count, 10);
+    BOOST_CHECK_EQUAL(span.m_timestamp, 20);
+    BOOST_CHECK_EQUAL(span.value<double>(9), 9);
+
+    span = it.nextSpan();
+    BOOST_CHECK_EQUAL(span.m_data, nullptr);
+    BOOST_CHECK_EQUAL(span.m_count, 5);
+    BOOST_CHECK_EQUAL(span.m_timestamp, 30);
+
+    BOOST_CHECK(!it.valid());
+    BOOST_CHECK(it.nextSpan().empty());
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_span_skip_gaps_test)
+{
+    StreamIterator it;
+
+    std::vector<double> data = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    addSyncDataRange(it, data, 10);
+    it.addRange(BlockIterator(20), BlockIterator(30));
+    addSyncDataRange(it, data, 30);
+
+    std::uint64_t sample_count = 0;
+    for (auto span = it.nextSpan(); !span.empty(); span = it.nextSpan())
+    {
+        BOOST_REQUIRE(span.m_data);
+        for (std::uint64_t i = 0; i < span.m_count; ++i)
+        {
+            BOOST_CHECK_EQUAL(span.value<double>(i), (span.timestamp(i) - 10) % 10);
+        }
+        sample_count += span.m_count;
+    }
+    BOOST_CHECK_EQUAL(sample_count, 20);
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_async_span_test)
+{
+    StreamIterator it;
+
+    std::vector<double> data = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    std::vector<std::uint64_t> timestamps = { 0, 10, 20, 30, 40, 50, 60, 70, 80, 90 };
+    addAsyncDataRange(it, data, timestamps);
+
+    auto span = it.nextSpan(3);
+    BOOST_CHECK_EQUAL(span.m_count, 3);
+    BOOST_CHECK_EQUAL(span.m_timestamp, 0);
+    BOOST_CHECK_EQUAL(span.timestamp(2), 20);
+    BOOST_CHECK_EQUAL(it.timestamp(), 30);
+
+    span = it.nextSpan();
+    BOOST_CHECK_EQUAL(span.m_count, 7);
+    BOOST_CHECK_EQUAL(span.timestamp(6), 90);
+    BOOST_CHECK_EQUAL(span.value<double>(6), 9);
+    BOOST_CHECK(!it.valid());
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_typed_range_test)
+{
+    StreamIterator it;
+    it.setSkipGaps(false);
+
+    std::vector<double> data = { 0, 1, 2, 3, 4 };
+    addSyncDataRange(it, data, 10);
+    it.addRange(BlockIterator(15), BlockIterator(20));
+    addSyncDataRange(it, data, 20);
+
+    SyncBlockIterator begin;
+    SyncBlockIterator end;
+    std::vector<double> values;
+    while (it.nextRange(begin, end))
+    {
+        for (; begin != end; ++begin)
+        {
+            values.push_back(begin.value<double>() + static_cast<double>(begin.timestamp()));
+        }
+    }
+    const std::vector<double> expected = { 10, 12, 14, 16, 18, 20, 22, 24, 26, 28 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+    BOOST_CHECK(!it.valid());
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_seek_sync_test)
+{
+    StreamIterator it;
+    BOOST_CHECK(!it.seek(0));
+
+    std::vector<double> data = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    addSyncDataRange(it, data, 10);
+    it.addRange(BlockIterator(20), BlockIterator(30));
+    addSyncDataRange(it, data, 30);
+
+    BOOST_CHECK(it.seek(17));
+    BOOST_CHECK_EQUAL(it.timestamp(), 17);
+    BOOST_CHECK_EQUAL(it.value<double>(), 7);
+
+    // timestamps before the first sample
+    BOOST_CHECK(it.seek(3));
+    BOOST_CHECK_EQUAL(it.timestamp(), 10);
+
+    // gaps are skipped
+    BOOST_CHECK(it.seek(25));
+    BOOST_CHECK_EQUAL(it.timestamp(), 30);
+    BOOST_CHECK_EQUAL(it.value<double>(), 0);
+
+    BOOST_CHECK(it.seek(39));
+    BOOST_CHECK_EQUAL(it.value<double>(), 9);
+    ++it;
+    BOOST_CHECK(!it.valid());
+
+    // seeking backwards after running past the end
+    BOOST_CHECK(it.seek(12));
+    BOOST_CHECK_EQUAL(it.value<double>(), 2);
+
+    BOOST_CHECK(!it.seek(40));
+    BOOST_CHECK(!it.valid());
+
+    it.setSkipGaps(false);
+    BOOST_CHECK(it.seek(25));
+    BOOST_CHECK_EQUAL(it.timestamp(), 25);
+    BOOST_CHECK_EQUAL(it.data(), nullptr);
+    for (int i = 25; i < 30; ++i)
+    {
+        ++it;
+    }
+    BOOST_CHECK_EQUAL(it.timestamp(), 30);
+    BOOST_CHECK_EQUAL(it.value<double>(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_seek_async_test)
+{
+    StreamIterator it;
+
+    std::vector<double> data = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    std::vector<std::uint64_t> timestamps = { 0, 10, 20, 30, 40, 50, 60, 70, 80, 90 };
+    std::vector<std::uint64_t> timestamps2 = { 100, 101, 101, 101, 120, 130, 140, 150, 160, 170 };
+    addAsyncDataRange(it, data, timestamps);
+    addAsyncDataRange(it, data, timestamps2);
+
+    for (std::uint64_t ts = 0; ts <= 90; ++ts)
+    {
+        BOOST_REQUIRE(it.seek(ts));
+        BOOST_CHECK_EQUAL(it.value<double>(), (ts + 9) / 10);
+    }
+
+    BOOST_CHECK(it.seek(95));
+    BOOST_CHECK_EQUAL(it.timestamp(), 100);
+
+    // first of several samples with the same timestamp
+    BOOST_CHECK(it.seek(101));
+    BOOST_CHECK_EQUAL(it.value<double>(), 1);
+
+    BOOST_CHECK(it.seek(102));
+    BOOST_CHECK_EQUAL(it.timestamp(), 120);
+
+    BOOST_CHECK(!it.seek(171));
+
+    const auto lower = it.lowerBound(55);
+    BOOST_CHECK(!it.valid());
+    BOOST_CHECK_EQUAL(lower.timestamp(), 60);
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_seek_variable_size_test)
+{
+    StreamIterator it;
+
+    std::vector<double> data = { 0, 1, 991, 2, 992, 993, 3, 4};
+    std::vector<std::uint64_t> timestamps = { 0, 10, 991, 20, 992, 993, 30, 40};
+    std::vector<std::uint32_t> sizes = { 8, 999, 16, 998, 997, 996, 24, 995, 994, 993, 992, 991, 8, 990, 8, 989};
+    addAsyncVariableDataRange(it, data, timestamps, sizes);
+
+    BOOST_CHECK(it.seek(15));
+    BOOST_CHECK_EQUAL(it.timestamp(), 20);
+    BOOST_CHECK_EQUAL(it.value<double>(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_sort_ranges_test)
+{
+    StreamIterator it;
+
+    std::vector<double> data = { 0, 1, 2, 3, 4 };
+    for (std::uint64_t start : { 20, 10, 30 })
+    {
+        it.appendRange(BlockIterator(data.data(), sizeof(double), start),
+                       BlockIterator(data.data() + data.size(), sizeof(double), start + data.size()));
+    }
+    it.appendGapRange(15, 20);
+    it.appendGapRange(25, 30);
+    it.sortRanges();
+
+    // gaps are skipped without being part of the iterated ranges
+    std::vector<std::uint64_t> timestamps;
+    for (; it.valid(); ++it)
+    {
+        timestamps.push_back(it.timestamp());
+    }
+    BOOST_CHECK_EQUAL(timestamps.size(), 15);
+    BOOST_CHECK(std::is_sorted(timestamps.begin(), timestamps.end()));
+    BOOST_CHECK_EQUAL(timestamps.front(), 10);
+    BOOST_CHECK_EQUAL(timestamps.back(), 34);
+
+    // gaps are materialised on demand
+    it.setSkipGaps(false);
+    std::vector<std::uint64_t> gap_timestamps;
+    std::uint64_t expected_timestamp = 10;
+    for (; it.valid(); ++it)
+    {
+        BOOST_CHECK_EQUAL(it.timestamp(), expected_timestamp++);
+        if (!it.data())
+        {
+            gap_timestamps.push_back(it.timestamp());
+        }
+    }
+    BOOST_CHECK_EQUAL(expected_timestamp, 35);
+    const std::vector<std::uint64_t> expected_gaps = { 15, 16, 17, 18, 19, 25, 26, 27, 28, 29 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(gap_timestamps.begin(), gap_timestamps.end(), expected_gaps.begin(), expected_gaps.end());
+    BOOST_CHECK_EQUAL(it.getTotalSampleCount(), 15);
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_sort_ranges_with_gaps_test)
+{
+    StreamIterator it;
+    it.setSkipGaps(false);
+
+    std::vector<double> data = { 0, 1, 2, 3, 4 };
+    it.appendGapRange(0, 10);
+    addSyncDataRange(it, data, 10);
+    it.sortRanges();
+
+    BOOST_CHECK(it.valid());
+    BOOST_CHECK_EQUAL(it.timestamp(), 0);
+    BOOST_CHECK_EQUAL(it.data(), nullptr);
+    BOOST_CHECK(it.seek(10));
+    BOOST_CHECK_EQUAL(it.value<double>(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(stream_iterator_dynamic_size_bidir_test)
+{
+    // every sample: timestamp, size, padding, payload of dynamic size
+    const std::size_t header_size = 16;
+    const auto make_block = [](std::vector<std::uint8_t>& buffer, const std::vector<std::pair<std::uint64_t, std::uint32_t>>& samples)
+    {
+        for (const auto& sample : samples)
+        {
+            const auto pos = buffer.size();
+            buffer.resize(pos + header_size + sample.second, static_cast<std::uint8_t>(sample.first));
+            std::memcpy(buffer.data() + pos, &sample.first, sizeof(sample.first));
+            std::memcpy(buffer.data() + pos + 8, &sample.second, sizeof(sample.second));
+        }
+    };
+    const auto block_iterator = [](const std::vector<std::uint8_t>& buffer, std::size_t pos)
+    {
+        return BlockIterator(buffer.data() + pos + header_size, header_size,
+            reinterpret_cast<const std::uint64_t*>(buffer.data() + pos), header_size,
+            reinterpret_cast<const std::uint32_t*>(buffer.data() + pos + 8), header_size);
+    };
+
+    std::vector<std::uint8_t> block1;
+    std::vector<std::uint8_t> block2;
+    make_block(block1, { {10, 3}, {20, 0}, {30, 7} });
+    make_block(block2, { {40, 5}, {50, 1} });
+
+    StreamIterator it;
+    it.addRange(block_iterator(block1, 0), block_iterator(block1, block1.size()), 3);
+    it.addRange(block_iterator(block2, 0), block_iterator(block2, block2.size()), 2);
+    BOOST_CHECK_EQUAL(it.getTotalSampleCount(), 5);
+
+    const std::vector<std::uint64_t> expected_timestamps = { 10, 20, 30, 40, 50 };
+    const std::vector<std::size_t> expected_sizes = { 3, 0, 7, 5, 1 };
+    for (std::size_t i = 0; i < expected_timestamps.size(); ++i)
+    {
+        BOOST_REQUIRE(it.valid());
+        BOOST_CHECK_EQUAL(it.timestamp(), expected_timestamps[i]);
+        ++it;
+    }
+    BOOST_CHECK(!it.valid());
+
+    BOOST_REQUIRE(it.seek(50));
+    for (std::size_t i = expected_timestamps.size(); i-- > 0;)
+    {
+        BOOST_REQUIRE(it.valid());
+        BOOST_CHECK_EQUAL(it.timestamp(), expected_timestamps[i]);
+        BOOST_CHECK_EQUAL(it.size(), expected_sizes[i]);
+        if (expected_sizes[i] > 0)
+        {
+            BOOST_CHECK_EQUAL(*static_cast<const std::uint8_t*>(it.data()), expected_timestamps[i]);
+        }
+        --it;
+    }
+    BOOST_CHECK(!it.valid());
+
+    it.clearRanges();
+    BOOST_CHECK_EQUAL(it.getTotalSampleCount(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -87,6 +87,7 @@ BOOST_AUTO_TEST_CASE(stream_reader_test)
 
     auto iterator1 = stream_reader.createChannelIterator(1);
     BOOST_CHECK(iterator1.valid());
+    BOOST_CHECK(iterator1.sampleLayout() == odk::framework::SampleLayout::IMPLICIT_TIMESTAMP);
     BOOST_CHECK_EQUAL(iterator1.data(), data1);
     BOOST_CHECK_EQUAL(iterator1.timestamp(), 100);
 
@@ -0,0 +1,185 @@
+// Copyright DEWETRON GmbH 2026
+#pragma once
+
+#include "odkuni_defines.h"
+
+#include <boost/utility/string_view.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace odk
+{
+    /**
+     * Forward-only XML reader for small, flat telegrams that does not allocate memory.
+     *
+     * It understands the subset of XML written by pugixml for the hot telegrams
+     * (declaration, elements, attributes and whitespace between elements) and reports
+     * Event::FAILED for everything else (comments, text, entity references, ...).
+     * Callers are expected to fall back to the pugixml DOM in that case, so that
+     * both paths produce identical results for every input.
+     *
+     * Usage:
+     *   XmlPullParser parser(xml);
+     *   while (parser.next() == XmlPullParser::Event::START_ELEMENT) { while (parser.nextAttribute(name, value)) {...} ... }
+     */
+    class XmlPullParser
+    {
+    public:
+        enum class Event
+        {
+            START_ELEMENT,
+            END_ELEMENT,
+            END_DOCUMENT,
+            FAILED
+        };
+
+        /// elements nested deeper are reported as Event::FAILED
+        static const std::size_t MAX_DEPTH = 8;
+
+        XmlPullParser(const char* begin, const char* end) noexcept;
+
+        explicit XmlPullParser(const boost::string_view& xml) noexcept;
+
+        /**
+         * Advances to the next start or end tag. Attributes of the current start tag that have not been read are skipped.
+         * An empty element tag (<a/>) is reported as START_ELEMENT followed by END_ELEMENT.
+         * Once FAILED has been returned, every further call returns FAILED.
+         */
+        Event next() noexcept;
+
+        /**
+         * Name of the element of the last START_ELEMENT or END_ELEMENT event
+         */
+        ODK_NODISCARD inline const boost::string_view& name() const noexcept
+        {
+            return m_name;
+        }
+
+        template <std::size_t N>
+        ODK_NODISCARD inline bool nameIs(const char (&token)[N]) const noexcept
+        {
+            return equals(m_name, token);
+        }
+
+        /**
+         * Reads the next attribute of the current start tag.
+         * Values are returned as written, values with entity references or line breaks are reported as errors.
+         * @return false after the last attribute or on a syntax error (@see failed)
+         */
+        bool nextAttribute(boost::string_view& name, boost::string_view& value) noexcept;
+
+        /**
+         * Reads the next attribute if it is written exactly as ` name="digits"`, which is how pugixml writes integers.
+         * This avoids scanning the value twice for the common case, the position is unchanged if it returns false.
+         */
+        template <std::size_t N, class T>
+        bool readIntegerAttribute(const char (&name)[N], T& target) noexcept
+        {
+            if (m_pos == nullptr || !m_in_start_tag || static_cast<std::size_t>(m_end - m_pos) < N + 2
+                || m_pos[0] != ' ' || std::memcmp(m_pos + 1, name, N - 1) != 0 || m_pos[N] != '=' || m_pos[N + 1] != '"')
+            {
+                return false;
+            }
+            const char* const value_begin = m_pos + N + 2;
+            const char* value_end = value_begin;
+            std::uint64_t result = 0;
+            while (value_end != m_end && *value_end >= '0' && *value_end <= '9')
+            {
+                const std::uint64_t digit = static_cast<std::uint64_t>(*value_end - '0');
+                if (result > (std::numeric_limits<T>::max() - digit) / 10)
+                {
+                    return false;
+                }
+                result = result * 10 + digit;
+                ++value_end;
+            }
+            if (value_end == value_begin || value_end == m_end || *value_end != '"')
+            {
+                return false;
+            }
+            target = static_cast<T>(result);
+            m_pos = value_end + 1;
+            return true;
+        }
+
+        /**
+         * true after a syntax error or unsupported content
+         */
+        ODK_NODISCARD inline bool failed() const noexcept
+        {
+            return m_pos == nullptr;
+        }
+
+        template <std::size_t N>
+        ODK_NODISCARD static inline bool equals(const boost::string_view& name, const char (&token)[N]) noexcept
+        {
+            return name.size() == N - 1 && std::memcmp(name.data(), token, N - 1) == 0;
+        }
+
+        /**
+         * Converts plain decimal numbers only. Signs, whitespace, other bases and values
+         * that do not fit into T are rejected to leave them to a full conversion.
+         */
+        template <class T>
+        static bool toInteger(const boost::string_view& value, T& target) noexcept
+        {
+            if (value.empty())
+            {
+                return false;
+            }
+            std::uint64_t result = 0;
+            for (const char c : value)
+            {
+                if (c < '0' || c > '9')
+                {
+                    return false;
+                }
+                const std::uint64_t digit = static_cast<std::uint64_t>(c - '0');
+                if (result > (std::numeric_limits<T>::max() - digit) / 10)
+                {
+                    return false;
+                }
+                result = result * 10 + digit;
+            }
+            target = static_cast<T>(result);
+            return true;
+        }
+
+        /**
+         * Converts plain decimal numbers (-1.25e-3) with strtod, which does not allocate memory unlike a stream based conversion.
+         * Other spellings (inf, nan, hexadecimal, leading '+' or '.', whitespace) and numbers that strtod reads differently
+         * in the current locale are rejected to leave them to a full conversion.
+         */
+        static bool toDouble(const boost::string_view& value, double& target) noexcept;
+
+    private:
+        Event fail() noexcept;
+        bool readName(boost::string_view& name) noexcept;
+        bool readAttributeValue(boost::string_view& value) noexcept;
+        void skipWhitespace() noexcept;
+
+        template <std::size_t N>
+        bool consume(const char (&token)[N]) noexcept
+        {
+            if (static_cast<std::size_t>(m_end - m_pos) < N - 1 || std::memcmp(m_pos, token, N - 1) != 0)
+            {
+                return false;
+            }
+            m_pos += N - 1;
+            return true;
+        }
+
+        const char* m_pos;
+        const char* m_end;
+        boost::string_view m_name;
+        /// names of the open elements, used to match the end tags
+        boost::string_view m_open_elements[MAX_DEPTH];
+        std::size_t m_depth;
+        bool m_in_start_tag;
+        bool m_pending_end_element;
+        bool m_root_closed;
+    };
+}
@@ -5,6 +5,7 @@
 #include "odkuni_defines.h"
 #include <pugixml.hpp>
 #include <boost/function.hpp>
+#include <cstdint>
 #include <string>
 
 /**
@@ -199,6 +200,13 @@ namespace xpugi
      */
     std::string toXML(pugi::xml_document& doc, bool pretty = false);
 
+    /**
+     * Serialize a XML Document into an existing string, reusing its storage.
+     * @param doc is a reference to a document
+     * @param xml receives the xml representation, previous content is replaced
+     */
+    void toXML(const pugi::xml_document& doc, std::string& xml, bool pretty = false);
+
     /**
      * Serialize a XML Node to its XML representation.
      * @param node is a reference to a XML Node
@@ -213,6 +221,43 @@ namespace xpugi
       */
     std::string toXML(pugi::xpath_node xnode, bool pretty = false);
 
+    /**
+     * pugi::xml_writer appending to a std::string
+     */
+    class StringWriter : public pugi::xml_writer
+    {
+    public:
+        explicit StringWriter(std::string& target);
+
+        void write(const void* data, size_t size) override;
+
+    private:
+        std::string& m_target;
+    };
+
+    /**
+     * Routes the memory of all pugixml documents and XPath queries through a per-thread cache
+     * of recently released blocks, so that parsing or generating a telegram does not allocate
+     * from the system once the cache of the thread is warm.
+     * Blocks released by another thread are added to the cache of that thread.
+     *
+     * pugixml requires that this is called while no document or XPath object exists: memory allocated before
+     * would be released through the cache. It is therefore never installed implicitly, plugins opt in with
+     * OXY_REGISTER_PLUGIN1_WITH_XML_MEMORY_CACHE. Repeated calls have no effect.
+     */
+    void installMemoryCache();
+
+    struct MemoryCacheStatistics
+    {
+        std::uint64_t m_allocations = 0;          ///< allocations requested by pugixml
+        std::uint64_t m_system_allocations = 0;   ///< allocations not served from the cache
+    };
+
+    /**
+     * Counters of the calling thread since its first pugixml allocation
+     */
+    MemoryCacheStatistics getMemoryCacheStatistics() noexcept;
+
     /**
      * Parses a xml text and returns the pretty printed document.
      */
@@ -0,0 +1,323 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkuni_xml_pull_parser.h"
+
+#include <cmath>
+#include <cstdlib>
+
+namespace odk
+{
+    namespace
+    {
+        enum CharClass : std::uint8_t
+        {
+            NAME_START = 1,
+            NAME = 2,
+            WHITESPACE = 4,
+            /// characters not supported in attribute values
+            VALUE_SPECIAL = 8
+        };
+
+        struct CharClassTable
+        {
+            std::uint8_t m_classes[256];
+
+            CharClassTable() noexcept
+                : m_classes()
+            {
+                for (int c = 0; c < 256; ++c)
+                {
+                    const bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+                    if (letter || c == '_' || c == ':')
+                    {
+                        m_classes[c] |= NAME_START | NAME;
+                    }
+                    if ((c >= '0' && c <= '9') || c == '-' || c == '.')
+                    {
+                        m_classes[c] |= NAME;
+                    }
+                }
+                for (const char c : { ' ', '\t', '\r', '\n' })
+                {
+                    m_classes[static_cast<unsigned char>(c)] |= WHITESPACE;
+                }
+                // entity references and whitespace normalization are left to the DOM
+                for (const char c : { '&', '<', '\t', '\r', '\n', '\0' })
+                {
+                    m_classes[static_cast<unsigned char>(c)] |= VALUE_SPECIAL;
+                }
+            }
+        };
+
+        const CharClassTable CHAR_CLASSES;
+
+        inline bool is(char c, std::uint8_t char_class) noexcept
+        {
+            return (CHAR_CLASSES.m_classes[static_cast<unsigned char>(c)] & char_class) != 0;
+        }
+    }
+
+    const std::size_t XmlPullParser::MAX_DEPTH;
+
+    XmlPullParser::XmlPullParser(const char* begin, const char* end) noexcept
+        : m_pos(begin)
+        , m_end(end)
+        , m_name()
+        , m_open_elements()
+        , m_depth(0)
+        , m_in_start_tag(false)
+        , m_pending_end_element(false)
+        , m_root_closed(false)
+    {
+        skipWhitespace();
+        if (consume("<?"))
+        {
+            // only the declaration is supported, it carries no information needed here
+            if (!consume("xml") || m_pos == m_end || (*m_pos != ' ' && *m_pos != '?'))
+            {
+                m_pos = nullptr;
+                return;
+            }
+            for (;;)
+            {
+                const char* const before_whitespace = m_pos;
+                skipWhitespace();
+                if (consume("?>"))
+                {
+                    break;
+                }
+                boost::string_view name;
+                boost::string_view value;
+                if (m_pos == before_whitespace || !readName(name) || !readAttributeValue(value))
+                {
+                    m_pos = nullptr;
+                    return;
+                }
+            }
+        }
+    }
+
+    XmlPullParser::XmlPullParser(const boost::string_view& xml) noexcept
+        : XmlPullParser(xml.data(), xml.data() + xml.size())
+    {
+    }
+
+    XmlPullParser::Event XmlPullParser::next() noexcept
+    {
+        if (m_pos == nullptr)
+        {
+            return Event::FAILED;
+        }
+
+        if (m_in_start_tag)
+        {
+            boost::string_view name;
+            boost::string_view value;
+            while (nextAttribute(name, value))
+            {
+            }
+            if (m_pos == nullptr)
+            {
+                return Event::FAILED;
+            }
+        }
+
+        if (m_pending_end_element)
+        {
+            m_pending_end_element = false;
+            m_name = m_open_elements[--m_depth];
+            m_root_closed = m_depth == 0;
+            return Event::END_ELEMENT;
+        }
+
+        skipWhitespace();
+        if (m_pos == m_end)
+        {
+            return m_root_closed ? Event::END_DOCUMENT : fail();
+        }
+
+        if (consume("</"))
+        {
+            boost::string_view name;
+            if (m_depth == 0 || !readName(name) || name != m_open_elements[m_depth - 1])
+            {
+                return fail();
+            }
+            skipWhitespace();
+            if (!consume(">"))
+            {
+                return fail();
+            }
+            m_name = name;
+            --m_depth;
+            m_root_closed = m_depth == 0;
+            return Event::END_ELEMENT;
+        }
+
+        // only a single root element, no comments, text or processing instructions
+        if (m_root_closed || m_depth == MAX_DEPTH || !consume("<") || !readName(m_name))
+        {
+            return fail();
+        }
+        m_open_elements[m_depth++] = m_name;
+        m_in_start_tag = true;
+        return Event::START_ELEMENT;
+    }
+
+    bool XmlPullParser::nextAttribute(boost::string_view& name, boost::string_view& value) noexcept
+    {
+        if (m_pos == nullptr || !m_in_start_tag)
+        {
+            return false;
+        }
+
+        const char* const before_whitespace = m_pos;
+        skipWhitespace();
+        if (consume(">"))
+        {
+            m_in_start_tag = false;
+            return false;
+        }
+        if (consume("/>"))
+        {
+            m_in_start_tag = false;
+            m_pending_end_element = true;
+            return false;
+        }
+        // attributes have to be separated by whitespace
+        if (m_pos == before_whitespace || !readName(name) || !readAttributeValue(value))
+        {
+            fail();
+            return false;
+        }
+        return true;
+    }
+
+    XmlPullParser::Event XmlPullParser::fail() noexcept
+    {
+        m_pos = nullptr;
+        m_in_start_tag = false;
+        return Event::FAILED;
+    }
+
+    bool XmlPullParser::readName(boost::string_view& name) noexcept
+    {
+        const char* const name_begin = m_pos;
+        if (m_pos == m_end || !is(*m_pos, NAME_START))
+        {
+            return false;
+        }
+        while (m_pos != m_end && is(*m_pos, NAME))
+        {
+            ++m_pos;
+        }
+        name = boost::string_view(name_begin, static_cast<std::size_t>(m_pos - name_begin));
+        return !name.empty();
+    }
+
+    bool XmlPullParser::readAttributeValue(boost::string_view& value) noexcept
+    {
+        skipWhitespace();
+        if (!consume("="))
+        {
+            return false;
+        }
+        skipWhitespace();
+        if (m_pos == m_end || (*m_pos != '"' && *m_pos != '\''))
+        {
+            return false;
+        }
+        const char quote = *m_pos++;
+        const char* const value_begin = m_pos;
+        while (m_pos != m_end && *m_pos != quote)
+        {
+            if (is(*m_pos, VALUE_SPECIAL))
+            {
+                return false;
+            }
+            ++m_pos;
+        }
+        if (m_pos == m_end)
+        {
+            return false;
+        }
+        value = boost::string_view(value_begin, static_cast<std::size_t>(m_pos - value_begin));
+        ++m_pos;
+        return true;
+    }
+
+    bool XmlPullParser::toDouble(const boost::string_view& value, double& target) noexcept
+    {
+        // strtod needs a terminated string, longer numbers are not written by pugixml
+        char buffer[40];
+        if (value.empty() || value.size() >= sizeof(buffer))
+        {
+            return false;
+        }
+
+        const auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+        const char* pos = value.begin();
+        const auto skip_digits = [&pos, &value, &is_digit]()
+        {
+            const char* const begin = pos;
+            while (pos != value.end() && is_digit(*pos))
+            {
+                ++pos;
+            }
+            return pos != begin;
+        };
+
+        if (*pos == '-')
+        {
+            ++pos;
+        }
+        if (!skip_digits())
+        {
+            return false;
+        }
+        if (pos != value.end() && *pos == '.')
+        {
+            ++pos;
+            if (!skip_digits())
+            {
+                return false;
+            }
+        }
+        if (pos != value.end() && (*pos == 'e' || *pos == 'E'))
+        {
+            ++pos;
+            if (pos != value.end() && (*pos == '-' || *pos == '+'))
+            {
+                ++pos;
+            }
+            if (!skip_digits())
+            {
+                return false;
+            }
+        }
+        if (pos != value.end())
+        {
+            return false;
+        }
+
+        std::memcpy(buffer, value.data(), value.size());
+        buffer[value.size()] = '\0';
+        char* end = nullptr;
+        const double result = std::strtod(buffer, &end);
+        // overflows are errors in a stream based conversion
+        if (end != buffer + value.size() || std::isinf(result))
+        {
+            return false;
+        }
+        target = result;
+        return true;
+    }
+
+    void XmlPullParser::skipWhitespace() noexcept
+    {
+        while (m_pos != m_end && is(*m_pos, WHITESPACE))
+        {
+            ++m_pos;
+        }
+    }
+}
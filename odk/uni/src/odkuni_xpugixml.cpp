@@ -359,33 +359,39 @@ namespace xpugi
 
     std::string toXML(pugi::xml_document& doc, bool pretty)
     {
-        std::stringstream ss;
+        std::string xml;
+        toXML(doc, xml, pretty);
+        return xml;
+    }
+
+    void toXML(const pugi::xml_document& doc, std::string& xml, bool pretty)
+    {
+        xml.clear();
+        StringWriter writer(xml);
         if (pretty)
         {
-            doc.save(ss);
+            doc.save(writer);
         }
         else
         {
-            doc.save(ss, "", pugi::format_raw);
+            doc.save(writer, "", pugi::format_raw);
         }
-
-        return ss.str();
     }
 
-
     std::string toXML(pugi::xml_node node, bool pretty)
     {
-        std::stringstream ss;
+        std::string xml;
+        StringWriter writer(xml);
         if (pretty)
         {
-            node.print(ss);
+            node.print(writer);
         }
         else
         {
-            node.print(ss, "", pugi::format_raw);
+            node.print(writer, "", pugi::format_raw);
         }
 
-        return ss.str();
+        return xml;
     }
 
     std::string toXML(pugi::xpath_node xnode, bool pretty)
@@ -398,6 +404,16 @@ namespace xpugi
         return "";
     }
 
+    StringWriter::StringWriter(std::string& target)
+        : m_target(target)
+    {
+    }
+
+    void StringWriter::write(const void* data, size_t size)
+    {
+        m_target.append(static_cast<const char*>(data), size);
+    }
+
     std::string xmlPrettyPrint(const std::string& xml_txt)
     {
         pugi::xml_document doc;
@@ -0,0 +1,134 @@
+// Copyright DEWETRON GmbH 2026
+
+#include "odkuni_xpugixml.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+
+namespace xpugi
+{
+    namespace
+    {
+        /// blocks from 64 bytes up to 128 KiB (which includes the memory pages of pugixml) are cached
+        const std::size_t MIN_CLASS_SHIFT = 6;
+        const std::size_t CLASS_COUNT = 12;
+        const std::size_t MAX_CACHED_SIZE = std::size_t(1) << (MIN_CLASS_SHIFT + CLASS_COUNT - 1);
+        /// blocks kept per size class and thread, bounds the cache to about 1 MiB per thread
+        const std::size_t BLOCKS_PER_CLASS = 4;
+        /// marks blocks that are larger than MAX_CACHED_SIZE
+        const std::size_t UNCACHED = CLASS_COUNT;
+
+        /**
+         * Every block starts with a header that keeps the default alignment of malloc
+         */
+        union BlockHeader
+        {
+            std::size_t m_size_class;
+            std::max_align_t m_alignment;
+        };
+
+        struct MemoryCache
+        {
+            void* m_blocks[CLASS_COUNT][BLOCKS_PER_CLASS] = {};
+            std::size_t m_block_counts[CLASS_COUNT] = {};
+            MemoryCacheStatistics m_statistics;
+
+            ~MemoryCache();
+        };
+
+        /// trivially destructible to remain usable while and after the cache of the thread is destroyed
+        thread_local bool t_cache_destroyed = false;
+        thread_local MemoryCache t_cache;
+
+        MemoryCache::~MemoryCache()
+        {
+            t_cache_destroyed = true;
+            for (std::size_t size_class = 0; size_class < CLASS_COUNT; ++size_class)
+            {
+                for (std::size_t block = 0; block < m_block_counts[size_class]; ++block)
+                {
+                    std::free(m_blocks[size_class][block]);
+                }
+            }
+        }
+
+        std::size_t getSizeClass(std::size_t size) noexcept
+        {
+            if (size > MAX_CACHED_SIZE)
+            {
+                return UNCACHED;
+            }
+            std::size_t size_class = 0;
+            while ((std::size_t(1) << (MIN_CLASS_SHIFT + size_class)) < size)
+            {
+                ++size_class;
+            }
+            return size_class;
+        }
+
+        void* allocate(size_t size)
+        {
+            const std::size_t size_class = getSizeClass(size);
+            void* block = nullptr;
+            if (!t_cache_destroyed)
+            {
+                auto& cache = t_cache;
+                ++cache.m_statistics.m_allocations;
+                if (size_class != UNCACHED && cache.m_block_counts[size_class] > 0)
+                {
+                    block = cache.m_blocks[size_class][--cache.m_block_counts[size_class]];
+                }
+                else
+                {
+                    ++cache.m_statistics.m_system_allocations;
+                }
+            }
+            if (!block)
+            {
+                const std::size_t block_size = size_class != UNCACHED ? std::size_t(1) << (MIN_CLASS_SHIFT + size_class) : size;
+                block = std::malloc(sizeof(BlockHeader) + block_size);
+                if (!block)
+                {
+                    return nullptr;
+                }
+                static_cast<BlockHeader*>(block)->m_size_class = size_class;
+            }
+            return static_cast<BlockHeader*>(block) + 1;
+        }
+
+        void deallocate(void* ptr)
+        {
+            if (!ptr)
+            {
+                return;
+            }
+            BlockHeader* const block = static_cast<BlockHeader*>(ptr) - 1;
+            const std::size_t size_class = block->m_size_class;
+            if (size_class != UNCACHED && !t_cache_destroyed)
+            {
+                auto& cache = t_cache;
+                if (cache.m_block_counts[size_class] < BLOCKS_PER_CLASS)
+                {
+                    cache.m_blocks[size_class][cache.m_block_counts[size_class]++] = block;
+                    return;
+                }
+            }
+            std::free(block);
+        }
+    }
+
+    void installMemoryCache()
+    {
+        static std::once_flag installed;
+        std::call_once(installed, []()
+        {
+            pugi::set_memory_management_functions(&allocate, &deallocate);
+        });
+    }
+
+    MemoryCacheStatistics getMemoryCacheStatistics() noexcept
+    {
+        return t_cache_destroyed ? MemoryCacheStatistics() : t_cache.m_statistics;
+    }
+}